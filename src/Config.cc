@@ -20,6 +20,7 @@ extern "C"
 #include "utils/messages.h"
 #include "utils/Augeas.h"
 #include "utils/flags/flagtypes.h"
+#include "utils/Timings.h"
 #include "output/OutNormal.h"
 #include "output/OutXML.h"
 #include "Config.h"
@@ -153,6 +154,9 @@ namespace
   enum class ConfigOption {
     MAIN_SHOW_ALIAS,
     MAIN_REPO_LIST_COLUMNS,
+    MAIN_REFRESH_JOBS,
+    MAIN_SERVICE_REFRESH_JOBS,
+    MAIN_RANK_MIRRORS,
 
     SOLVER_INSTALL_RECOMMENDS,
     SOLVER_FORCE_RESOLUTION_COMMANDS,
@@ -178,6 +182,8 @@ namespace
     COLOR_PKGLISTHIGHLIGHT_ATTRIBUTE,
 
     SEARCH_RUNSEARCHPACKAGES,
+    SEARCH_JOBS,
+    SEARCH_CACHE,
 
     OBS_BASE_URL,
     OBS_PLATFORM
@@ -188,6 +194,9 @@ namespace
     static const std::vector<std::pair<std::string,ConfigOption>> _data = {
       { "main/showAlias",			ConfigOption::MAIN_SHOW_ALIAS			},
       { "main/repoListColumns",			ConfigOption::MAIN_REPO_LIST_COLUMNS		},
+      { "main/refreshJobs",			ConfigOption::MAIN_REFRESH_JOBS			},
+      { "main/serviceRefreshJobs",		ConfigOption::MAIN_SERVICE_REFRESH_JOBS		},
+      { "main/rankMirrors",			ConfigOption::MAIN_RANK_MIRRORS			},
       { "solver/installRecommends",		ConfigOption::SOLVER_INSTALL_RECOMMENDS		},
       { "solver/forceResolutionCommands",	ConfigOption::SOLVER_FORCE_RESOLUTION_COMMANDS	},
 
@@ -213,6 +222,8 @@ namespace
       { "color/pkglistHighlightAttribute",	ConfigOption::COLOR_PKGLISTHIGHLIGHT_ATTRIBUTE	},
 
       { "search/runSearchPackages",		ConfigOption::SEARCH_RUNSEARCHPACKAGES		},
+      { "search/jobs",				ConfigOption::SEARCH_JOBS			},
+      { "search/cache",				ConfigOption::SEARCH_CACHE			},
 
       { "obs/baseUrl",				ConfigOption::OBS_BASE_URL			},
       { "obs/platform",				ConfigOption::OBS_PLATFORM			}
@@ -264,6 +275,9 @@ namespace
 
 Config::Config()
   : repo_list_columns("anr")
+  , refresh_jobs(1)
+  , service_refresh_jobs(1)
+  , rank_mirrors(true)
   , solver_installRecommends(!ZConfig::instance().solver_onlyRequires())
   , psCheckAccessDeleted(true)
   , do_ttyout		(mayUseANSIEscapes())
@@ -284,6 +298,8 @@ Config::Config()
   , color_pkglistHighlight(true)
   , color_pkglistHighlightAttribute(ansi::Color::nocolor())
   , search_runSearchPackages(indeterminate)		// ask
+  , search_jobs(1)
+  , search_cache(false)
   , obs_baseUrl("https://download.opensuse.org/repositories/")
   , obs_platform("")	// guess
   , verbosity( Out::NORMAL )
@@ -372,6 +388,21 @@ std::vector<ZyppFlags::CommandGroup> Config::cliOptions()
               // translators: --userdata <STRING>
               _("User defined transaction id used in history and plugins.")
         },
+        { "timings", 0, ZyppFlags::NoArgument,
+              ZyppFlags::CallbackVal( []( const ZyppFlags::CommandOption &, const boost::optional<std::string> & ) {
+                Timings::instance().enable();
+              } ),
+              // translators: --timings
+              _("Print the time spent in each phase of the command.")
+        },
+        { "timings-trace", 0, ZyppFlags::RequiredArgument,
+              ZyppFlags::CallbackVal( []( const ZyppFlags::CommandOption &, const boost::optional<std::string> &val ) {
+                Timings::instance().setTraceFile( *val );
+                Timings::instance().enable();
+              }, ARG_FILE ),
+              // translators: --timings-trace <FILE>
+              _("Like --timings, and write the phases as Chrome trace JSON to FILE.")
+        },
         std::move( ZyppFlags::CommandOption(
             "quiet", 'q', ZyppFlags::NoArgument,
             std::move( ZyppFlags::WriteFixedValueType( verbosity, Out::QUIET ).after( [this](){
@@ -672,6 +703,32 @@ void Config::read( const std::string & file )
     if (!s.empty()) // TODO add some validation
       repo_list_columns = s;
 
+    s = augeas.getOption(asString( ConfigOption::MAIN_REFRESH_JOBS ));
+    if (!s.empty())
+    {
+      unsigned jobs = 0;
+      str::strtonum( s, jobs );
+      if ( jobs )
+        refresh_jobs = jobs;
+      else
+        WAR << "zypper.conf: main/refreshJobs: invalid value '" << s << "'" << endl;
+    }
+
+    s = augeas.getOption(asString( ConfigOption::MAIN_SERVICE_REFRESH_JOBS ));
+    if (!s.empty())
+    {
+      unsigned jobs = 0;
+      str::strtonum( s, jobs );
+      if ( jobs )
+        service_refresh_jobs = jobs;
+      else
+        WAR << "zypper.conf: main/serviceRefreshJobs: invalid value '" << s << "'" << endl;
+    }
+
+    s = augeas.getOption(asString( ConfigOption::MAIN_RANK_MIRRORS ));
+    if (!s.empty())
+      rank_mirrors = str::strToBool(s, true);
+
     // ---------------[ solver ]------------------------------------------------
 
     s = augeas.getOption(asString( ConfigOption::SOLVER_INSTALL_RECOMMENDS ));
@@ -763,6 +820,21 @@ void Config::read( const std::string & file )
     if ( !s.empty() )
       search_runSearchPackages = str::strToTriBool( s );
 
+    s = augeas.getOption( asString( ConfigOption::SEARCH_JOBS ) );
+    if ( !s.empty() )
+    {
+      unsigned jobs = 0;
+      str::strtonum( s, jobs );
+      if ( jobs )
+        search_jobs = jobs;
+      else
+        WAR << "zypper.conf: search/jobs: invalid value '" << s << "'" << endl;
+    }
+
+    s = augeas.getOption( asString( ConfigOption::SEARCH_CACHE ) );
+    if ( !s.empty() )
+      search_cache = str::strToBool( s, search_cache );
+
     // ---------------[ obs ]---------------------------------------------------
 
     s = augeas.getOption(asString( ConfigOption::OBS_BASE_URL ));
@@ -36,6 +36,15 @@ struct Config
   /** Which columns to show in repo list by default (string of short options).*/
   std::string repo_list_columns;
 
+  /** Number of repositories to refresh concurrently (1: serial refresh). */
+  unsigned refresh_jobs;
+
+  /** Number of services to refresh concurrently (1: serial refresh). */
+  unsigned service_refresh_jobs;
+
+  /** Whether to try the baseurls of a repo in order of their measured latency. */
+  bool rank_mirrors;
+
   bool solver_installRecommends;
   std::set<ZypperCommand> solver_forceResolutionCommands;
 
@@ -75,6 +84,12 @@ struct Config
 
   TriBool search_runSearchPackages;	// runSearchPackages after search: always/never/ask
 
+  /** Number of worker processes a search may split the repos among (1: serial search). */
+  unsigned search_jobs;
+
+  /** Whether to keep search results on disk, valid until the repos or the rpm database change. */
+  bool search_cache;
+
   /** Hackisch way so save back a search_runSearchPackages value from search-packages-hinthack. */
   void saveback_search_runSearchPackages( const TriBool & value_r );
 
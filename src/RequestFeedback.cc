@@ -256,7 +256,7 @@ void SolverRequester::Feedback::print( Out & out, const SolverRequester::Options
     case NOT_FOUND_CAP:
     {
       std::string detail;
-      if ( !_userdata.empty() )	// matches with different case; typo?
+      if ( !_userdata.empty() )	// matches with different case or similar names; typo?
       {
 	detail = "- ";
 	// translators: %1% expands to a single package name or a ','-separated enumeration of names.
@@ -22,6 +22,7 @@
 
 #include "Zypper.h"
 #include "SolverRequester.h"
+#include "search-index.h"
 #include "global-settings.h"
 
 // libzypp logger settings
@@ -31,7 +32,8 @@
 /////////////////////////////////////////////////////////////////////////
 namespace
 {
-  void getCiMatchHint( PoolQuery & q_r, std::string & ciMatchHint_r )
+  /** Hint on a possible typo: the names matching \a q_r case-insensitive, or else similar names. */
+  void getCiMatchHint( PoolQuery & q_r, const Capability & cap_r, std::string & ciMatchHint_r )
   {
     q_r.setCaseSensitive( false );
     if ( ! q_r.empty() )
@@ -53,6 +55,18 @@ namespace
 	++cnt;
       }
     }
+    else
+    {
+      std::string name( sat::Solvable::SplitIdent( cap_r.detail().name() ).name().asString() );
+      if ( name.find_first_of( "*?[" ) != std::string::npos )
+	return;	// a glob
+      for ( const std::string & similar : similar_names( Zypper::instance(), name, q_r ) )
+      {
+	if ( ! ciMatchHint_r.empty() )
+	  ciMatchHint_r += ", ";
+	ciMatchHint_r += similar;
+      }
+    }
   }
 
   PoolQuery pkg_spec_to_poolquery( const Capability & cap, const std::list<std::string> & repos )
@@ -217,7 +231,7 @@ void SolverRequester::installRemove( const PackageArgs & args )
  */
 void SolverRequester::install( const PackageSpec & pkg )
 {
-  std::string ciMatchHint;	// hint on possible typo (case-insensitive matches)
+  std::string ciMatchHint;	// hint on possible typo (case-insensitive matches or similar names)
 
   // first try by name
   if ( !_opts.force_by_cap )
@@ -313,7 +327,7 @@ void SolverRequester::install( const PackageSpec & pkg )
 
     addFeedback( Feedback::NOT_FOUND_NAME_TRYING_CAPS, pkg );
     // Quick check whether there would have been matches with different case..
-    getCiMatchHint( q, ciMatchHint );
+    getCiMatchHint( q, pkg.parsed_cap, ciMatchHint );
   }
 
   // try by capability
@@ -350,7 +364,7 @@ void SolverRequester::install( const PackageSpec & pkg )
  */
 void SolverRequester::remove( const PackageSpec & pkg )
 {
-  std::string ciMatchHint;	// hint on possible typo (case-insensitive matches)
+  std::string ciMatchHint;	// hint on possible typo (case-insensitive matches or similar names)
 
   // first try by name
   if ( !_opts.force_by_cap )
@@ -389,7 +403,7 @@ void SolverRequester::remove( const PackageSpec & pkg )
 
     addFeedback( Feedback::NOT_FOUND_NAME_TRYING_CAPS, pkg );
     // Quick check whether there would have been matches with different case..
-    getCiMatchHint( q, ciMatchHint );
+    getCiMatchHint( q, pkg.parsed_cap, ciMatchHint );
   }
 
   // try by capability
@@ -478,7 +478,7 @@ bool Summary::writeResolvableList( std::ostream & out,
       ret = false;
     }
     mbs_write_wrapped( out, s.str(), 2, _wrap_width );
-    out << endl;
+    out << '\n';
     return ret;
   }
 
@@ -550,7 +550,7 @@ bool Summary::writeResolvableList( std::ostream & out,
     // "ConsoleKit-devel ConsoleKit-doc ... and 20828 more items."
     out << ( color << str::Format(PL_( "... and %1% more item.",
 				       "... and %1% more items.",
-				       relevant_entries) ) % relevant_entries ) << endl;
+				       relevant_entries) ) % relevant_entries ) << '\n';
     ret = false;
   }
 
@@ -600,7 +600,7 @@ void Summary::writeNewlyInstalled( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::POSITIVE << label ) << endl;
+    out << '\n' << ( ColorContext::POSITIVE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::POSITIVE );
   }
 }
@@ -646,7 +646,7 @@ void Summary::writeRemoved( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::NEGATIVE << label ) << endl;
+    out << '\n' << ( ColorContext::NEGATIVE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::NEGATIVE );
   }
 }
@@ -693,7 +693,7 @@ void Summary::writeUpgraded( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::POSITIVE << label ) << endl;
+    out << '\n' << ( ColorContext::POSITIVE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::POSITIVE );
   }
 }
@@ -736,7 +736,7 @@ void Summary::writeDowngraded( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::NEGATIVE << label ) << endl;
+    out << '\n' << ( ColorContext::NEGATIVE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::NEGATIVE );
   }
 }
@@ -787,7 +787,7 @@ void Summary::writeReinstalled( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::CHANGE << label ) << endl;
+    out << '\n' << ( ColorContext::CHANGE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::CHANGE );
   }
 }
@@ -949,7 +949,7 @@ void Summary::writeRecommended( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::POSITIVE << label ) << endl;
+    out << '\n' << ( ColorContext::POSITIVE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::POSITIVE );
   }
 
@@ -993,7 +993,7 @@ void Summary::writeRecommended( std::ostream & out )
 		     it->second.size() );
 	label = str::form( label.c_str(), it->second.size() );
 
-	out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+	out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
 	writeResolvableList( out, notRequired, ColorContext::HIGHLIGHT );
       }
       else
@@ -1005,7 +1005,7 @@ void Summary::writeRecommended( std::ostream & out )
 		       it->second.size() );
 	  label = str::form( label.c_str(), it->second.size() );
 
-	  out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+	  out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
 	  writeResolvableList( out, softLocked, ColorContext::HIGHLIGHT );
         }
         if ( !conflicts.empty() )
@@ -1015,7 +1015,7 @@ void Summary::writeRecommended( std::ostream & out )
 		       it->second.size() );
 	  label = str::form( label.c_str(), it->second.size() );
 
-	  out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+	  out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
           writeResolvableList( out, conflicts, ColorContext::HIGHLIGHT );
         }
       }
@@ -1044,7 +1044,7 @@ void Summary::writeRecommended( std::ostream & out )
 #endif
       label = str::form( label.c_str(), it->second.size() );
 
-      out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+      out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
       writeResolvableList( out, it->second, ColorContext::HIGHLIGHT );
     }
   }
@@ -1098,7 +1098,7 @@ void Summary::writeSuggested( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+    out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::HIGHLIGHT );
   }
 }
@@ -1144,7 +1144,7 @@ void Summary::writeChangedArch( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::CHANGE << label ) << endl;
+    out << '\n' << ( ColorContext::CHANGE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::CHANGE );
   }
 }
@@ -1190,7 +1190,7 @@ void Summary::writeChangedVendor( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::CHANGE << label ) << endl;
+    out << '\n' << ( ColorContext::CHANGE << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::CHANGE );
   }
 }
@@ -1210,7 +1210,7 @@ void Summary::writeSupportUnknown( std::ostream & out )
         it->second.size() );
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+    out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::HIGHLIGHT );
   }
 }
@@ -1228,7 +1228,7 @@ void Summary::writeSupportUnsupported( std::ostream & out )
         it->second.size() );
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+    out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::HIGHLIGHT );
   }
 }
@@ -1246,7 +1246,7 @@ void Summary::writeSupportNeedACC( std::ostream & out )
         it->second.size() );
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+    out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::HIGHLIGHT );
   }
 }
@@ -1280,7 +1280,7 @@ void Summary::writeNotUpdated( std::ostream & out )
 #endif
     label = str::form( label.c_str(), it->second.size() );
 
-    out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+    out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
     writeResolvableList( out, it->second, ColorContext::HIGHLIGHT );
   }
 }
@@ -1310,7 +1310,7 @@ void Summary::writeLocked( std::ostream & out )
       ( instlocks.size() + avidents.size() )
     );
     label = str::form( label.c_str(), instlocks.size() + avidents.size() );
-    out << endl << ( ColorContext::HIGHLIGHT << label ) << endl;
+    out << '\n' << ( ColorContext::HIGHLIGHT << label ) << '\n';
 
     bool wroteAll = true;
     if ( ! avidents.empty() )
@@ -1318,18 +1318,18 @@ void Summary::writeLocked( std::ostream & out )
       DtorReset guard( _viewop );
       _viewop = DEFAULT;	// always as plain name list
       // translators: used as 'tag:' (i.e. followed by ':')
-      out << " " << _("Available") << ':' << endl;
+      out << " " << _("Available") << ':' << '\n';
       wroteAll &= writeResolvableList( out, avidents, ColorContext::HIGHLIGHT, 100, /*withKind*/true );
     }
     if ( ! instlocks.empty() )
     {
       // translators: used as 'tag:' (i.e. followed by ':')
-      out << " " << _("Installed") << ':' << endl;
+      out << " " << _("Installed") << ':' << '\n';
       wroteAll &= writeResolvableList( out, instlocks, ColorContext::HIGHLIGHT, 100, /*withKind*/true );
     }
     if ( !wroteAll )
     {
-      out << " " << str::Format(_("Run '%1%' to see the complete list of locked items.")) % "zypper locks -s" << endl;
+      out << " " << str::Format(_("Run '%1%' to see the complete list of locked items.")) % "zypper locks -s" << '\n';
     }
   }
 }
@@ -1352,7 +1352,7 @@ void Summary::writeRebootNeeded( std::ostream & out )
     const ResPairSet & resolvables = _rebootNeeded[kind];
     if ( ! resolvables.empty() ) {
       size_t count = resolvables.size();
-      out << endl << ( ColorContext::MSG_WARNING << generateLabel( kind, count ) ) << endl;
+      out << '\n' << ( ColorContext::MSG_WARNING << generateLabel( kind, count ) ) << '\n';
       writeResolvableList( out, resolvables, ColorContext::MSG_WARNING );
     }
   };
@@ -1394,7 +1394,7 @@ void Summary::writeDownloadAndInstalledSizeSummary( std::ostream & out )
   }
 
   mbs_write_wrapped( out, s.str(), 0, _wrap_width );
-  out << endl;
+  out << '\n';
 }
 
 void Summary::writePackageCounts( std::ostream & out )
@@ -1513,7 +1513,7 @@ void Summary::writePackageCounts( std::ostream & out )
       s << PL_("source package to install", "source packages to install", count);
     gotcha = true;
   }
-  s << "." << endl;
+  s << ".\n";
   mbs_write_wrapped( out, s.str(), 0, _wrap_width );
 }
 
@@ -1577,7 +1577,7 @@ void Summary::dumpTo( std::ostream & out )
     writeSupportNeedACC( out );
   }
   writeRebootNeeded( out );
-  out << endl;
+  out << '\n';
   writePackageCounts( out );
   writeDownloadAndInstalledSizeSummary( out );
   if ( _need_restart && zypper.runtimeData().plain_patch_command && !(_viewop & UPDATESTACK_ONLY) )
@@ -1593,7 +1593,7 @@ void Summary::dumpTo( std::ostream & out )
     str::Str s;
     for ( const auto & str : _ctc )
     {
-      s << endl << str;
+      s << '\n' << str;
     }
     // translator: Printed after the summary but before the prompt to start the installation.
     // Followed by some explanatory text telling it might be a good idea NOT to continue:
@@ -1636,9 +1636,9 @@ void Summary::writeXmlResolvableList( std::ostream & out, const KindToResPairSet
       {
 	const std::string & text( res->description() );
 	if ( !text.empty() )
-	  out << ">\n" << "<description>" << xml::escape( text ) << "</description>" << "</solvable>" << endl;
+	  out << ">\n" << "<description>" << xml::escape( text ) << "</description>" << "</solvable>\n";
 	else
-	  out << "/>" << endl;
+	  out << "/>\n";
       }
     }
   }
@@ -1657,64 +1657,64 @@ void Summary::dumpAsXmlTo( std::ostream & out )
   out << " download-size=\"" << ((ByteCount::SizeType)_todownload) << "\"";
   out << " space-usage-diff=\"" << ((ByteCount::SizeType)_inst_size_change) << "\"";
   out << " packages-to-change=\"" << pkgchanged << "\"";	// bsc#1102429: CaaSP requires it to detect 'nothing to do'
-  out << ">" << endl;
+  out << ">\n";
 
   if ( !_toupgrade.empty() )
   {
-    out << "<to-upgrade>" << endl;
+    out << "<to-upgrade>\n";
     writeXmlResolvableList( out, _toupgrade );
-    out << "</to-upgrade>" << endl;
+    out << "</to-upgrade>\n";
   }
 
   if ( !_todowngrade.empty() )
   {
-    out << "<to-downgrade>" << endl;
+    out << "<to-downgrade>\n";
     writeXmlResolvableList( out, _todowngrade );
-    out << "</to-downgrade>" << endl;
+    out << "</to-downgrade>\n";
   }
 
   if ( !_toinstall.empty() )
   {
-    out << "<to-install>" << endl;
+    out << "<to-install>\n";
     writeXmlResolvableList( out, _toinstall );
-    out << "</to-install>" << endl;
+    out << "</to-install>\n";
   }
 
   if ( !_toreinstall.empty() )
   {
-    out << "<to-reinstall>" << endl;
+    out << "<to-reinstall>\n";
     writeXmlResolvableList( out, _toreinstall );
-    out << "</to-reinstall>" << endl;
+    out << "</to-reinstall>\n";
   }
 
   if ( !_toremove.empty() )
   {
-    out << "<to-remove>" << endl;
+    out << "<to-remove>\n";
     writeXmlResolvableList( out, _toremove );
-    out << "</to-remove>" << endl;
+    out << "</to-remove>\n";
   }
 
   if ( !_tochangearch.empty() )
   {
-    out << "<to-change-arch>" << endl;
+    out << "<to-change-arch>\n";
     writeXmlResolvableList( out, _tochangearch );
-    out << "</to-change-arch>" << endl;
+    out << "</to-change-arch>\n";
   }
 
   if ( !_tochangevendor.empty() )
   {
-    out << "<to-change-vendor>" << endl;
+    out << "<to-change-vendor>\n";
     writeXmlResolvableList( out, _tochangevendor );
-    out << "</to-change-vendor>" << endl;
+    out << "</to-change-vendor>\n";
   }
 
   if ( _viewop & SHOW_UNSUPPORTED && !( _supportUnknown.empty() && _supportUnsupported.empty() ) )
   {
-    out << "<_unsupported>" << endl;
+    out << "<_unsupported>\n";
     writeXmlResolvableList( out, _supportUnknown );
     writeXmlResolvableList( out, _supportUnsupported );
-    out << "</_unsupported>" << endl;
+    out << "</_unsupported>\n";
   }
 
-  out << "</install-summary>" << endl;
+  out << "</install-summary>\n";
 }
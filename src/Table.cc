@@ -43,6 +43,14 @@ TableRow & TableRow::add( std::string s )
   return *this;
 }
 
+unsigned TableRow::columnWidth( unsigned c ) const
+{
+  const container & cols( columns() );
+  while ( _columnWidths.size() <= c && _columnWidths.size() < cols.size() )
+    _columnWidths.push_back( mbs_width( cols[_columnWidths.size()] ) );
+  return c < _columnWidths.size() ? _columnWidths[c] : 0;
+}
+
 TableRow & TableRow::addDetail( std::string s )
 {
   _details.push_back( std::move(s) );
@@ -61,7 +69,7 @@ std::ostream & TableRow::dumbDumpTo( std::ostream & stream ) const
 
     stream << *i;
   }
-  return stream << endl;
+  return stream << '\n';
 }
 
 std::ostream & TableRow::dumpDetails( std::ostream & stream, const Table & parent ) const
@@ -107,7 +115,7 @@ std::ostream & TableRow::dumpTo( std::ostream & stream, const Table & parent ) c
       {
         // start printing the next table columns to new line,
         // indent by 2 console columns
-        stream << endl << std::string( parent._margin + 2, ' ' );
+        stream << '\n' << std::string( parent._margin + 2, ' ' );
         curpos = parent._margin + 2; // indent == 2
       }
       else
@@ -119,8 +127,20 @@ std::ostream & TableRow::dumpTo( std::ostream & stream, const Table & parent ) c
       seen_first = true;
 
     // stream.width (widths[c]); // that does not work with multibyte chars
-    ssize = mbs_width( s );
-    if ( ssize > parent._max_width[c] )
+    ssize = _translateColumns ? mbs_width( s ) : columnWidth( c );
+    if ( ssize > parent._max_width[c] && c == lastCol && parent._stream
+	 && ! ( c < parent._width_cap.size() && parent._width_cap[c] ) )
+    {
+      // a late wide cell in the last column of a streamed table needs no alignment
+      stream << ( _ctxt << s );
+    }
+    else if ( ssize > parent._max_width[c] && parent._max_width[c] < 3 )
+    {
+      // no room for "->" (e.g. a streamed table's column narrower than a late cell)
+      std::string cutstr = mbs_substr_by_width( s, 0, parent._max_width[c] );
+      stream << ( _ctxt << cutstr ) << std::string( parent._max_width[c] - mbs_width( cutstr ), ' ' );
+    }
+    else if ( ssize > parent._max_width[c] )
     {
       unsigned cutby = parent._max_width[c] - 2;
       std::string cutstr = mbs_substr_by_width( s, 0, cutby );
@@ -176,7 +196,7 @@ std::ostream & TableRow::dumpTo( std::ostream & stream, const Table & parent ) c
     stream << "";
     curpos += parent._max_width[c] + (parent._style == none ? 2 : 3);
   }
-  stream << endl;
+  stream << '\n';
 
   if ( !_details.empty() )
   {
@@ -189,8 +209,12 @@ std::ostream & TableRow::dumpTo( std::ostream & stream, const Table & parent ) c
 
 Table::Table()
   : _has_header( false )
+  , _stream( nullptr )
+  , _streamSample( 0 )
+  , _streamStarted( false )
+  , _streamedRows( 0 )
   , _max_col( 0 )
-  , _max_width( 1, 0 )
+  , _max_width()
   , _width( 0 )
   , _style( defaultStyle )
   , _screen_width( get_screen_width() )
@@ -202,10 +226,177 @@ Table::Table()
 
 Table & Table::add( TableRow tr )
 {
+  if ( _stream )
+  {
+    ++_streamedRows;
+    if ( _streamStarted )
+    {
+      // a column not seen in the sample; the others keep their width
+      if ( tr.cols() > _max_width.size() )
+      {
+	for ( unsigned c = _max_width.size(); c < tr.cols(); ++c )
+	  _max_width.push_back( tr.columnWidth( c ) );
+	_max_col = _max_width.size() - 1;
+      }
+      tr.dumpTo( *_stream, *this );
+      return *this;
+    }
+    _rows.push_back( std::move(tr) );
+    if ( _rows.size() >= _streamSample )
+      flushStreamSample();
+    return *this;
+  }
   _rows.push_back( std::move(tr) );
   return *this;
 }
 
+void Table::streamTo( std::ostream & stream_r, unsigned sample_r )
+{
+  _stream = &stream_r;
+  _streamSample = sample_r;
+  _streamStarted = false;
+  _streamedRows = _rows.size();
+  if ( _rows.size() >= _streamSample )
+    flushStreamSample();
+}
+
+void Table::flushStreamSample()
+{
+  updateTableWidths();
+  dumpHeader( *_stream );
+  for ( const auto & row : _rows )
+    row.dumpTo( *_stream, *this );
+  _rows.clear();
+  _streamStarted = true;
+}
+
+void Table::endStream()
+{
+  if ( ! _stream )
+    return;
+  if ( ! _streamStarted && ! _rows.empty() )
+    flushStreamSample();
+  _stream = nullptr;
+}
+
+void Table::columnCap( unsigned column_r, unsigned width_r )
+{
+  if ( column_r >= _width_cap.size() )
+    _width_cap.resize( column_r + 1, 0 );
+  _width_cap[column_r] = width_r;
+}
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** A row's custom sort index (\ref TableRow::userData), extracted once per sort. */
+  struct SortKey
+  {
+    enum Type { None, CSI, String, Unsigned, Int };
+
+    SortKey()
+    {}
+
+    explicit SortKey( const boost::any & userData_r )
+    {
+      if ( userData_r.empty() )
+	return;
+      if ( userData_r.type() == typeid(SolvableCSI) )
+      {
+	type = CSI;
+	const SolvableCSI & csi( boost::any_cast<const SolvableCSI &>( userData_r ) );
+	solvable = csi.first;
+	str = csi.first.name();
+	kind = csi.first.kind().c_str();
+	num = csi.second;
+      }
+      else if ( userData_r.type() == typeid(std::string) )
+      {
+	type = String;
+	str = boost::any_cast<const std::string &>( userData_r );
+      }
+      else if ( userData_r.type() == typeid(unsigned) )
+      {
+	type = Unsigned;
+	num = boost::any_cast<unsigned>( userData_r );
+      }
+      else if ( userData_r.type() == typeid(int) )
+      {
+	type = Int;
+	num = boost::any_cast<int>( userData_r );
+      }
+      else
+	ZYPP_THROW( zypp::Exception( str::form("Unsupported user types") ) );
+    }
+
+    /** std::compare semantic like \ref csidetail::simpleAnyTypeComp. */
+    int compare( const SortKey & rhs ) const
+    {
+      if ( type == None || rhs.type == None )
+	return ( type == rhs.type ? 0 : type == None ? -1 : 1 );
+      if ( type != rhs.type )
+	ZYPP_THROW( zypp::Exception( str::form("Incompatible user types") ) );
+
+      switch ( type )
+      {
+	case CSI:
+	{
+	  if ( solvable == rhs.solvable )
+	    return 0;	// quick check Solvable Id
+	  int cmp = str.compare( rhs.str );
+	  if ( ! cmp )
+	    cmp = ::strcmp( kind, rhs.kind );
+	  if ( cmp )
+	    return cmp;
+	  break;
+	}
+	case String:
+	  return str.compare( rhs.str );
+	default:
+	  break;
+      }
+      return ( num < rhs.num ? -1 : num > rhs.num ? 1 : 0 );
+    }
+
+    Type type = None;
+    sat::Solvable solvable;
+    std::string str;		//!< String or the CSI name
+    const char * kind = "";	//!< CSI kind
+    long long num = 0;		//!< Unsigned, Int or the CSI picklist position
+  };
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+void Table::sort( const std::list<unsigned> & byColumns_r )
+{
+  if ( byColumns_r.empty() )
+    return;
+
+  const std::vector<unsigned> columns( byColumns_r.begin(), byColumns_r.end() );
+  std::vector<SortKey> keys;
+  keys.reserve( _rows.size() );
+  for ( const TableRow & row : _rows )
+    keys.push_back( SortKey( row.userData() ) );
+
+  sortIndices( [&]( unsigned lhs, unsigned rhs ) -> bool {
+    const TableRow::container & l( _rows[lhs].columnsNoTr() );
+    const TableRow::container & r( _rows[rhs].columnsNoTr() );
+    for ( unsigned column : columns )
+    {
+      bool noL = column >= l.size();
+      bool noR = column >= r.size();
+      int cmp = 0;
+      if ( noL || noR )
+	cmp = ( noL && noR ? keys[lhs].compare( keys[rhs] ) : noL ? -1 : 1 );
+      else
+	cmp = l[column].compare( r[column] );
+      if ( cmp )
+	return cmp < 0;
+    }
+    return false;
+  } );
+}
+
 Table & Table::setHeader( TableHeader tr )
 {
   _header = std::move(tr);
@@ -239,11 +430,12 @@ void Table::updateColWidths( const TableRow & tr ) const
     _max_col = _max_width.size()-1;
   }
 
-  unsigned c = 0;
-  for ( const auto & col : columns )
+  for ( unsigned c = 0; c < columns.size(); ++c )
   {
-    unsigned &max = _max_width[c++];
-    unsigned cur = mbs_width( col );
+    unsigned &max = _max_width[c];
+    unsigned cur = tr.columnWidth( c );
+    if ( c < _width_cap.size() && _width_cap[c] && cur > _width_cap[c] )
+      cur = std::max( _width_cap[c], 3U );	// room to abbreviate
 
     if ( max < cur )
       max = cur;
@@ -262,7 +454,7 @@ void Table::dumpRule( std::ostream &stream ) const
 
   stream.width( 0 );
   stream << std::string(_margin, ' ' );
-  for ( unsigned c = 0; c <= _max_col; ++c )
+  for ( unsigned c = 0; c < _max_width.size(); ++c )
   {
     if ( seen_first )
       stream << hline << cross << hline;
@@ -271,10 +463,10 @@ void Table::dumpRule( std::ostream &stream ) const
     for ( unsigned i = 0; i < _max_width[c]; ++i )
       stream << hline;
   }
-  stream << endl;
+  stream << '\n';
 }
 
-std::ostream & Table::dumpTo( std::ostream & stream ) const
+void Table::updateTableWidths() const
 {
   // compute column sizes
   if ( _has_header )
@@ -285,7 +477,7 @@ std::ostream & Table::dumpTo( std::ostream & stream ) const
   // reset column widths for columns that can be abbreviated
   //! \todo allow abbrev of multiple columns?
   unsigned c = 0;
-  for ( std::vector<bool>::const_iterator it = _abbrev_col.begin(); it != _abbrev_col.end() && c <= _max_col; ++it, ++c )
+  for ( std::vector<bool>::const_iterator it = _abbrev_col.begin(); it != _abbrev_col.end() && c < _max_width.size(); ++it, ++c )
   {
     if ( *it && _width > _screen_width &&
          // don't resize the column to less than 3, or if the resulting table
@@ -297,7 +489,10 @@ std::ostream & Table::dumpTo( std::ostream & stream ) const
       break;
     }
   }
+}
 
+void Table::dumpHeader( std::ostream & stream ) const
+{
   if ( _has_header )
   {
     DtorReset inHeader( _inHeader, false );
@@ -305,6 +500,12 @@ std::ostream & Table::dumpTo( std::ostream & stream ) const
     _header.dumpTo( stream, *this );
     dumpRule (stream);
   }
+}
+
+std::ostream & Table::dumpTo( std::ostream & stream ) const
+{
+  updateTableWidths();
+  dumpHeader( stream );
 
   for ( const auto & row : _rows )
     row.dumpTo( stream, *this );
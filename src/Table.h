@@ -17,6 +17,8 @@
 #include <set>
 #include <list>
 #include <vector>
+#include <algorithm>
+#include <numeric>
 
 #include <boost/any.hpp>
 
@@ -266,13 +268,19 @@ public:
   { return _translateColumns ? _translatedColumns : _columns; }
 
   container & columns()
-  { return _translateColumns ? _translatedColumns : _columns; }
+  { _columnWidths.clear(); return _translateColumns ? _translatedColumns : _columns; }
 
   const container & columnsNoTr() const
   { return _columns; }
 
   container & columnsNoTr()
-  { return _columns; }
+  { _columnWidths.clear(); return _columns; }
+
+  /** The screen width of \ref columns \a c, computed once. */
+  unsigned columnWidth( unsigned c ) const;
+
+  const container & details() const
+  { return _details; }
 
 protected:
   bool      _translateColumns = false;
@@ -280,6 +288,7 @@ private:
   container _columns;
   container _translatedColumns;
   container _details;
+  mutable std::vector<unsigned> _columnWidths;	///< mbs_width of the columns computed so far
   ColorContext _ctxt;
   boost::any _userData;	///< user defined sort index, e.g. if string values don't work due to coloring
 };
@@ -334,7 +343,8 @@ TableHeader && operator<<( TableHeader && th, Tp_ && val )
 class Table
 {
 public:
-  typedef std::list<TableRow> container;
+  /** The rows are stored contiguously; sorting moves each row once. */
+  typedef std::vector<TableRow> container;
 
   static TableLineStyle defaultStyle;
 
@@ -346,6 +356,25 @@ public:
   std::ostream & dumpTo( std::ostream & stream ) const;
   bool empty() const { return _rows.empty(); }
 
+  /** \name Streaming
+   * A long table can be printed while its rows are added, without holding
+   * them in memory: after \ref streamTo the first \a sample_r rows are held
+   * back. Then the column widths are computed from the header, these rows
+   * and the \ref columnCap, and the rows added so far are printed. Any
+   * further row is printed as it is added; a cell wider than its column is
+   * abbreviated. \ref endStream prints the rows still held back.
+   */
+  //@{
+  void streamTo( std::ostream & stream_r, unsigned sample_r );
+  void endStream();
+  bool streaming() const			{ return _stream; }
+  /** The number of rows added since \ref streamTo. */
+  unsigned streamedRows() const			{ return _streamedRows; }
+  //@}
+
+  /** Column \a column_r is at most \a width_r wide, longer cells are abbreviated. */
+  void columnCap( unsigned column_r, unsigned width_r );
+
 
   /** Unsorted - pseudo sort column indicating not to sort. */
   static constexpr unsigned Unsorted		= unsigned(-1);
@@ -362,13 +391,17 @@ public:
   void sort()					{ sort( unsigned(_defaultSortColumn ) ); }
 
   /** Sort by \a byColumn_r */
-  void sort( unsigned byColumn_r )		{ if ( byColumn_r != Unsorted ) _rows.sort( TableRow::Less( { byColumn_r } ) ); }
-  void sort( const std::list<unsigned> & byColumns_r )	{ if ( byColumns_r.size() ) _rows.sort( TableRow::Less( byColumns_r ) ); }
-  void sort( std::list<unsigned> && byColumns_r )	{ if ( byColumns_r.size() ) _rows.sort( TableRow::Less( std::move(byColumns_r) ) ); }
-
-  /** Custom sort */
+  void sort( unsigned byColumn_r )		{ if ( byColumn_r != Unsorted ) sort( std::list<unsigned>{ byColumn_r } ); }
+  /** Stable sort by \a byColumns_r like \ref TableRow::Less, but the
+   * custom sort indices are extracted once per row rather than per comparison.
+   */
+  void sort( const std::list<unsigned> & byColumns_r );
+  void sort( std::list<unsigned> && byColumns_r )	{ sort( static_cast<const std::list<unsigned> &>(byColumns_r) ); }
+
+  /** Custom sort (stable) */
   template<class TCompare, std::enable_if_t<!std::is_integral<TCompare>::value, int> = 0>
-  void sort( TCompare && less_r )		{ _rows.sort( std::forward<TCompare>(less_r) ); }
+  void sort( TCompare && less_r )
+  { sortIndices( [this,&less_r]( unsigned lhs, unsigned rhs ) -> bool { return less_r( _rows[lhs], _rows[rhs] ); } ); }
 
   void lineStyle( TableLineStyle st );
   void wrap( int force_break_after = -1 );
@@ -389,13 +422,42 @@ public:
   { _editionStyle.insert( column ); }
 
 private:
+  /** Stable sort of the row indices, then move the rows into that order. */
+  template<class TIndexLess>
+  void sortIndices( TIndexLess && less_r )
+  {
+    std::vector<unsigned> order( _rows.size() );
+    std::iota( order.begin(), order.end(), 0 );
+    std::stable_sort( order.begin(), order.end(), std::forward<TIndexLess>(less_r) );
+
+    container sorted;
+    sorted.reserve( _rows.size() );
+    for ( unsigned idx : order )
+      sorted.push_back( std::move(_rows[idx]) );
+    _rows.swap( sorted );
+  }
+
   void dumpRule( std::ostream & stream ) const;
+  void dumpHeader( std::ostream & stream ) const;
   void updateColWidths( const TableRow & tr ) const;
+  void updateTableWidths() const;
+
+  void flushStreamSample();
 
   bool _has_header;
   TableHeader _header;
   container _rows;
 
+  //! where the rows are streamed to or nullptr
+  std::ostream * _stream;
+  //! rows held back before the widths are computed
+  unsigned _streamSample;
+  //! whether the widths are computed and the header is printed
+  bool _streamStarted;
+  unsigned _streamedRows;
+  //! maximum width of the respective columns (0: none)
+  std::vector<unsigned> _width_cap;
+
   //! maximum column index seen in this table
   mutable unsigned _max_col;
   //! maximum width of respective columns
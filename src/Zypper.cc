@@ -15,6 +15,7 @@
 #include <list>
 #include <map>
 #include <iterator>
+#include <cstdlib>
 
 #include <unistd.h>
 #include <readline/history.h>
@@ -58,6 +59,8 @@
 #include "output/OutXML.h"
 
 #include "utils/flags/zyppflags.h"
+#include "utils/Timings.h"
+#include "utils/RepoIndex.h"
 #include "utils/flags/exceptions.h"
 #include "global-settings.h"
 
@@ -171,6 +174,38 @@ namespace {
     return mayuse;
   }
 
+  /** Print the phases recorded for \c --timings and write the trace file. */
+  void reportTimings( Zypper & zypper )
+  {
+    Timings & timings( Timings::instance() );
+    if ( ! timings.enabled() || timings.records().empty() )
+      return;
+
+    if ( zypper.out().type() != Out::TYPE_XML )
+    {
+      Table tbl;
+      // translators: table headers of the --timings output
+      tbl << ( TableHeader() << _("Phase") << _("Detail") << _("Time") << _("Downloaded") << _("RSS Change") << _("Process Peak RSS") );
+      for ( const Timings::Record & record : timings.records() )
+      {
+	tbl << ( TableRow()
+	    << std::string( 2 * record.depth, ' ' ) + record.name
+	    << record.detail
+	    << str::form( "%lld ms", ( record.duration < 0 ? 0 : record.duration ) / 1000 )
+	    << ( record.bytes ? record.bytes.asString() : std::string() )
+	    << ( record.rssDelta < 0 ? "-" : "+" ) + ByteCount( std::abs( record.rssDelta ), ByteCount::K ).asString()
+	    << ByteCount( record.processPeakRss, ByteCount::K ).asString() );
+      }
+      cout << endl;
+      zypper.out().info( _("Timings:") );
+      cout << tbl;
+    }
+
+    if ( ! timings.writeTrace( zypper.command().asString() ) )
+      zypper.out().error( str::Format(_("Failed to write the timings trace to '%s'.")) % timings.traceFile() );
+    timings.clear();
+  }
+
 } //namespace
 
 ///////////////////////////////////////////////////////////////////
@@ -215,6 +250,7 @@ int Zypper::main( int argc, char ** argv )
     // parse global options and the command
     _commandArgOffset = processGlobalOptions();
     doCommand( argc , argv, _commandArgOffset );
+    reportTimings( *this );
     cleanup();
   }
   // Actually safeDoCommand also catches these exceptions.
@@ -255,6 +291,18 @@ int Zypper::main( int argc, char ** argv )
   return exitCode();
 }
 
+const RepoIndex & Zypper::repoIndex()
+{
+  RepoManager & manager( repoManager() );
+  // Added or removed repos are noticed here; modifications must be announced via repoIndexChanged.
+  if ( ! _repoIndex || _repoIndexOwner.lock() != _rm || _repoIndex->size() != manager.repoSize() )
+  {
+    _repoIndex.reset( new RepoIndex( manager.repoBegin(), manager.repoEnd() ) );
+    _repoIndexOwner = _rm;
+  }
+  return *_repoIndex;
+}
+
 Out & Zypper::out()
 {
   // PENDING SigINT? Some frequently called place to avoid exiting from within the signal handler?
@@ -421,6 +469,7 @@ void Zypper::commandShell()
       MIL << "Reloading..." << endl;
       God->target()->reload();   // reload system in case rpm database has changed
       doCommand( args.argc(), args.argv(), 0 );
+      reportTimings( *this );
     }
     catch ( const Exception & e )
     {
@@ -130,6 +130,7 @@ struct RuntimeData
 };
 
 typedef shared_ptr<RepoManager> RepoManager_Ptr;
+class RepoIndex;
 
 class Zypper : private base::NonCopyable
 {
@@ -158,6 +159,13 @@ public:
   RepoManager & repoManager()
   { if ( !_rm ) _rm.reset( new RepoManager( _config.rm_options ) ); return *_rm; }
 
+  /** Index of the repos known to \ref repoManager (built on demand, once per RepoManager). */
+  const RepoIndex & repoIndex();
+
+  /** Repos were modified via \ref repoManager; the \ref repoIndex must be rebuilt. */
+  void repoIndexChanged()
+  { _repoIndex.reset(); }
+
 
   int exitCode() const				{ return _exitCode; }
   void setExitCode( int exit )			{
@@ -263,6 +271,8 @@ private:
   RuntimeData _rdata;
 
   RepoManager_Ptr   _rm;
+  shared_ptr<RepoIndex> _repoIndex;
+  weak_ptr<RepoManager> _repoIndexOwner;	///< the RepoManager _repoIndex was built from
 };
 
 void print_unknown_command_hint( Zypper & zypper );
@@ -1,9 +1,9 @@
 #include "basecommand.h"
 
 #include <boost/optional.hpp>
-#include <zypp/base/LogControl.h>
 #include "utils/flags/flagtypes.h"
 #include "utils/messages.h"
+#include "utils/Timings.h"
 #include "commandhelpformatter.h"
 #include "solve-commit.h"
 #include "global-settings.h"
@@ -166,12 +166,14 @@ int ZypperBaseCommand::defaultSystemSetup( Zypper &zypper, SetupSystemFlags flag
     zypper.initRepoManager();
 
   if ( flags_r.testFlag( InitTarget ) ) {
+    Timings::Phase phase( "init_target" );
     init_target( zypper );
     if ( zypper.exitCode() != ZYPPER_EXIT_OK )
       return zypper.exitCode();
   }
 
   if ( flags_r.testFlag( InitRepos ) ) {
+    Timings::Phase phase( "init_repos" );
     init_repos( zypper );
     if ( zypper.exitCode() != ZYPPER_EXIT_OK )
       return zypper.exitCode();
@@ -183,10 +185,13 @@ int ZypperBaseCommand::defaultSystemSetup( Zypper &zypper, SetupSystemFlags flag
   }
 
   if ( flags_r.testFlag( LoadResolvables ) ) {
+    Timings::Phase phase( "load_resolvables" );
     load_resolvables( zypper );
   } else if ( flags_r.testFlag( LoadRepoResolvables ) ) {
+    Timings::Phase phase( "load_resolvables" );
     load_repo_resolvables( zypper );
   } else if ( flags_r.testFlag( LoadTargetResolvables ) ) {
+    Timings::Phase phase( "load_resolvables" );
     load_target_resolvables( zypper );
   }
 
@@ -194,11 +199,8 @@ int ZypperBaseCommand::defaultSystemSetup( Zypper &zypper, SetupSystemFlags flag
     return zypper.exitCode();
 
   if ( flags_r.testFlag ( Resolve ) ) {
-    // have REPOS and TARGET
     // compute status of PPP
-    MIL << "-------------- Calling SAT Solver to establish the PPP status -------------------" << endl;
-    base::LogControl::TmpLineWriter shutUp;	// reduce logging; some day libzypp/libsolv may offer a shotcut to establish
-    resolve( zypper );
+    establishPPPStatus( zypper );
   }
 
   return zypper.exitCode();
@@ -3,6 +3,7 @@
 #include "repos.h"
 #include "utils/messages.h"
 #include "utils/flags/flagtypes.h"
+#include "commands/conditions.h"
 
 #include <zypp/RepoManager.h>
 
@@ -84,13 +85,23 @@ zypp::ZyppFlags::CommandGroup ListReposCmd::cmdOptions() const
   return {{
       { "export", 'e', ZyppFlags::RequiredArgument, ZyppFlags::StringType(&that->_exportFile, boost::optional<const char *>(), "FILE.repo"),
             // translators: -e, --export <FILE.repo>
-            _("Export all defined repositories as a single local .repo file.") }
+            _("Export all defined repositories as a single local .repo file.") },
+      { "export-cache", '\0', ZyppFlags::RequiredArgument, ZyppFlags::StringType(&that->_exportCacheFile, boost::optional<const char *>(), "FILE"),
+            // translators: --export-cache <FILE>
+            _("Export the metadata caches of all enabled (or the specified) repositories into an archive.") },
+      { "import-cache", '\0', ZyppFlags::RequiredArgument, ZyppFlags::StringType(&that->_importCacheFile, boost::optional<const char *>(), "FILE"),
+            // translators: --import-cache <FILE>
+            _("Import repository metadata caches from an archive created by --export-cache.") }
+    }, {
+      { "export-cache", "import-cache" }
   }};
 }
 
 void ListReposCmd::doReset()
 {
   _exportFile.clear();
+  _exportCacheFile.clear();
+  _importCacheFile.clear();
 }
 
 int ListReposCmd::execute( Zypper &zypper, const std::vector<std::string> &positionalArgs_r )
@@ -119,6 +130,29 @@ int ListReposCmd::execute( Zypper &zypper, const std::vector<std::string> &posit
     return ( ZYPPER_EXIT_ERR_ZYPP );
   }
 
+  // exchange repository caches
+  if ( !_exportCacheFile.empty() || !_importCacheFile.empty() )
+  {
+    if ( !not_found.empty() )
+      return ( ZYPPER_EXIT_ERR_INVALID_ARGS );
+
+    if ( !_importCacheFile.empty() )
+    {
+      std::string err;
+      int code = NeedsRootCondition().check( err );
+      if ( code != ZYPPER_EXIT_OK )
+      {
+        zypper.out().error( err );
+        return code;
+      }
+      return import_repo_cache( zypper, _importCacheFile, positionalArgs_r.empty() ? std::list<RepoInfo>() : repos );
+    }
+
+    if ( positionalArgs_r.empty() )
+      repos.remove_if( []( const RepoInfo & repo_r ) { return !repo_r.enabled(); } );
+    return export_repo_cache( zypper, repos, _exportCacheFile );
+  }
+
   // add the temporary repos specified with the --plus-repo to the list
   if ( !gData.temporary_repos.empty() )
     repos.insert( repos.end(), gData.temporary_repos.begin(), gData.temporary_repos.end() );
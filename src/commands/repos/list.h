@@ -28,6 +28,8 @@ protected:
 
 private:
   std::string _exportFile;
+  std::string _exportCacheFile;
+  std::string _importCacheFile;
   RSCommonListOptions _listOptions{ OptCommandCtx::RepoContext, *this };
 };
 
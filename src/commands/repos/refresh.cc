@@ -6,18 +6,47 @@
 \*---------------------------------------------------------------------------*/
 #include "refresh.h"
 #include "repos.h"
+#include "search-index.h"
 #include "commands/conditions.h"
 #include "commands/services/refresh.h"
 
 
 #include "utils/messages.h"
 #include "utils/flags/flagtypes.h"
+#include "utils/WorkerPool.h"
 #include "Zypper.h"
 
+#include <unistd.h>
+
+#include <zypp/sat/Pool.h>
+
 using namespace zypp;
 
 extern ZYpp::Ptr God;
 
+namespace
+{
+  /** The installed packages are not refreshed like a repo; as root, bring
+   * their search indexes up to date along with the repos' ones.
+   */
+  void buildSystemSearchIndexes( Zypper & zypper )
+  {
+    if ( geteuid() != 0 )
+      return;
+    try
+    {
+      God->initializeTarget( zypper.config().root_dir );
+      God->target()->load();
+      build_search_indexes( zypper, sat::Pool::instance().systemRepo() );
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      WAR << "Search indexes of the installed packages not built: " << e.asUserString() << endl;
+    }
+  }
+} // namespace
+
 RefreshRepoCmd::RefreshRepoCmd(std::vector<std::string> &&commandAliases_r )
   : ZypperBaseCommand (
       std::move( commandAliases_r ),
@@ -79,6 +108,11 @@ zypp::ZyppFlags::CommandGroup RefreshRepoCmd::cmdOptions() const
             // translators: -s, --services
             _("Refresh also services before refreshing repos.")
       },
+      {"jobs", 'j', ZyppFlags::RequiredArgument,
+            ZyppFlags::IntType( &that->_jobs ),
+            // translators: -j, --jobs <NUMBER>
+            _("Refresh up to <NUMBER> repositories in parallel (default: main.refreshJobs from zypper.conf).")
+      }
   }};
 }
 
@@ -87,6 +121,7 @@ void RefreshRepoCmd::doReset()
   _flags = Default;
   _repos.clear();
   _services = false;
+  _jobs = 0;
 }
 
 int RefreshRepoCmd::execute( Zypper &zypper , const std::vector<std::string> &positionalArgs_r )
@@ -94,6 +129,12 @@ int RefreshRepoCmd::execute( Zypper &zypper , const std::vector<std::string> &po
   if ( zypper.config().no_refresh )
     zypper.out().warning( str::Format(_("The '%s' global option has no effect here.")) % "--no-refresh" );
 
+  if ( _jobs < 0 )
+  {
+    zypper.out().error( str::Format(_("Invalid number of jobs '%1%'. Use a positive integer number.")) % _jobs );
+    return ZYPPER_EXIT_ERR_INVALID_ARGS;
+  }
+
   bool force = _flags.testFlag(Force);
 
   if ( _services )
@@ -139,7 +180,7 @@ int RefreshRepoCmd::execute( Zypper &zypper , const std::vector<std::string> &po
   for ( const std::string &repoFromCLI : positionalArgs_r )
     specifiedRepos.push_back(repoFromCLI);
 
-  return refreshRepositories ( zypper, _flags, specifiedRepos );
+  return refreshRepositories ( zypper, _flags, specifiedRepos, _jobs );
 }
 
 bool RefreshRepoCmd::refreshRepository(Zypper &zypper, const RepoInfo &repo, RefreshFlags flags_r)
@@ -166,7 +207,7 @@ bool RefreshRepoCmd::refreshRepository(Zypper &zypper, const RepoInfo &repo, Ref
   return error;
 }
 
-int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, const std::vector<std::string> repos_r )
+int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, const std::vector<std::string> repos_r, unsigned jobs_r )
 {
   RepoManager & manager( zypper.repoManager() );
   const std::list<RepoInfo> & repos( manager.knownRepositories() );
@@ -200,11 +241,29 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
   unsigned error_count = 0;
   unsigned enabled_repo_count = repos.size();
 
+  // --jobs: Repos are collected and refreshed by a WorkerPool after the loop.
+  // Otherwise they are refreshed one by one within the loop.
+  if ( ! jobs_r )
+    jobs_r = zypper.config().refresh_jobs;
+  std::vector<RepoInfo> deferred;
+  std::vector<std::string> deferredInfo;	// their --plus-content note, printed along with the result
+
+  auto doRefresh = [&]( const RepoInfo & repo )
+  {
+    if ( refreshRepository( zypper, repo, flags_r ) )
+    {
+      zypper.out().error( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString() );
+      ERR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
+      error_count++;
+    }
+  };
+
   if ( !specified.empty() || not_found.empty() )
   {
     for_( rit, repos.begin(), repos.end() )
     {
       const RepoInfo & repo( *rit );
+      std::string plusContentInfo;
 
       if ( repo.enabled() )
       {
@@ -215,8 +274,7 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
 	  if ( plusContent.count( repo ) )
 	  {
 	    MIL << "[--plus-content] check " << repo.alias() << endl;
-	    zypper.out().info( str::Format(_("Refreshing repository '%s'.")) % repo.asUserString(),
-			       " [--plus-content]" );
+	    plusContentInfo = str::Format(_("Refreshing repository '%s'.")) % repo.asUserString();
 	  }
 	  else
 	  {
@@ -233,8 +291,7 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
 	if ( doContentCheck || plusContent.count( repo ) )
 	{
 	  MIL << "[--plus-content] check " << repo.alias() << endl;
-	  zypper.out().info( str::Format(_("Scanning content of disabled repository '%s'.")) % repo.asUserString(),
-			     " [--plus-content]" );
+	  plusContentInfo = str::Format(_("Scanning content of disabled repository '%s'.")) % repo.asUserString();
 	}
 	else
 	{
@@ -257,11 +314,43 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
       }
 
       // do the refresh
-      if ( refreshRepository( zypper, repo, flags_r ) )
+      if ( jobs_r > 1 && worker_may_refresh( repo ) )
+      {
+        deferred.push_back( repo );
+        deferredInfo.push_back( plusContentInfo );
+      }
+      else
+      {
+        if ( ! plusContentInfo.empty() )
+          zypper.out().info( plusContentInfo, " [--plus-content]" );
+        doRefresh( repo );
+      }
+    }
+
+    if ( deferred.size() == 1 )
+    {
+      if ( ! deferredInfo.front().empty() )
+        zypper.out().info( deferredInfo.front(), " [--plus-content]" );
+      doRefresh( deferred.front() );
+    }
+    else if ( ! deferred.empty() )
+    {
+      zypper.out().info( str::Format(_("Refreshing %1% repositories using up to %2% parallel jobs.")) % deferred.size() % jobs_r,
+                         Out::HIGH );
+
+      std::vector<WorkerPool::Result> results( refresh_repos_in_workers( zypper, deferred, flags_r, jobs_r ) );
+
+      // Report in order. Failed jobs are redone here, which provides the usual
+      // error reporting and user interaction (e.g. to trust a new key).
+      for ( unsigned i = 0; i < deferred.size(); ++i )
       {
-        zypper.out().error( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString() );
-        ERR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
-        error_count++;
+        const RepoInfo & repo( deferred[i] );
+        if ( ! deferredInfo[i].empty() )
+          zypper.out().info( deferredInfo[i], " [--plus-content]" );
+        if ( results[i].ok() )
+          report_worker_refresh( zypper, repo, results[i].data );
+        else
+          doRefresh( repo );
       }
     }
   }
@@ -303,5 +392,6 @@ int RefreshRepoCmd::refreshRepositories( Zypper &zypper, RefreshFlags flags_r, c
   else
     zypper.out().info(_("All repositories have been refreshed.") );
 
+  buildSystemSearchIndexes( zypper );
   return ZYPPER_EXIT_OK;
 }
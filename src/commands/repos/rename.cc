@@ -38,6 +38,7 @@ int rename_repo( Zypper & zypper, const std::string & alias, const std::string &
 
     repo.setAlias( newalias );
     manager.modifyRepository( alias, repo );
+    zypper.repoIndexChanged();
 
     MIL << "Repository '" << alias << "' renamed to '" << repo.alias() << "'" << endl;
     zypper.out().info( str::Format(_("Repository '%s' renamed to '%s'.")) % alias % repo.alias() );
@@ -5,12 +5,21 @@
 #include "commands/commonflags.h"
 #include "commands/commandhelpformatter.h"
 #include "commands/search/search-packages-hinthack.h"
+#include "search-cache.h"
+#include "search-index.h"
+#include "solve-commit.h"
+#include "utils/ListingCache.h"
+#include "utils/ReverseDependencies.h"
+#include "utils/WorkerPool.h"
 
 #include <zypp/base/Algorithm.h>
 #include <zypp/sat/Solvable.h>
 #include <zypp/Capability.h>
 #include <zypp/PoolQueryResult.h>
+#include <zypp/ResPool.h>
+#include <zypp/sat/Pool.h>
 
+#include <algorithm>
 #include <unordered_map>
 
 namespace zypp
@@ -50,6 +59,390 @@ namespace
     }
     return false;
   }
+
+  ///////////////////////////////////////////////////////////////////
+  // parallel search
+
+  /** Pools with fewer solvables are searched in a single process. */
+  const unsigned parallelSearchMinSolvables = 20000;
+
+  /** A contiguous slice of the pools repos, searched by one worker. */
+  typedef std::vector<sat::Repository> Shard;
+
+  /** Split the pools repos into at most \a jobs_r shards of about the same number of solvables.
+   * Empty if the search is not worth to be split.
+   */
+  std::vector<Shard> searchShards( unsigned jobs_r )
+  {
+    std::vector<Shard> ret;
+    unsigned total = 0;
+    for ( const auto & repo : sat::Pool::instance().repos() )
+      total += repo.solvablesSize();
+    if ( jobs_r < 2 || total < parallelSearchMinSolvables )
+      return ret;
+
+    unsigned share = ( total + jobs_r - 1 ) / jobs_r;
+    unsigned filled = 0;
+    for ( const auto & repo : sat::Pool::instance().repos() )
+    {
+      if ( ret.empty() || ( filled >= share && ret.size() < jobs_r ) )
+      {
+        ret.push_back( Shard() );
+        filled = 0;
+      }
+      ret.back().push_back( repo );
+      filled += repo.solvablesSize();
+    }
+    if ( ret.size() < 2 )
+      ret.clear();
+    return ret;
+  }
+
+  /** Whether \a query_r may match patches, patterns or products, whose status needs the solver. */
+  bool queryMayMatchPPP( const PoolQuery & query_r )
+  {
+    if ( query_r.kinds().empty() )
+      return true;
+    for ( const ResKind & kind : query_r.kinds() )
+    {
+      if ( traits::isPseudoInstalled( kind ) )
+        return true;
+    }
+    return false;
+  }
+
+  /** \a query_r restricted to the repos of \a shard_r. */
+  PoolQuery shardQuery( const PoolQuery & query_r, const Shard & shard_r )
+  {
+    PoolQuery ret( query_r );
+    for ( const auto & repo : shard_r )
+      ret.addRepo( repo.alias() );
+    return ret;
+  }
+
+  /** The matches of \a query_r and \a indexMatches_r within \a shard_r. */
+  PoolQueryResult shardMatches( const PoolQuery & query_r, bool queryUsed_r, const PoolQueryResult & indexMatches_r, const Shard & shard_r )
+  {
+    PoolQueryResult ret;
+    if ( queryUsed_r )
+      ret += shardQuery( query_r, shard_r );
+    for ( const auto & slv : indexMatches_r )
+    {
+      if ( std::find( shard_r.begin(), shard_r.end(), slv.repository() ) != shard_r.end() )
+        ret += slv;
+    }
+    return ret;
+  }
+
+  /** Fill \a table_r with the detailed rows of the matches within \a shard_r. */
+  void fillShardDetails( Table & table_r, const PoolQuery & query_r, bool queryUsed_r, const PoolQueryResult & indexMatches_r,
+                         const Shard & shard_r, bool verbose_r, TriBool instNotinst_r )
+  {
+    FillSearchTableSolvable callback( table_r, instNotinst_r );
+    if ( verbose_r )
+    {
+      PoolQuery query( shardQuery( query_r, shard_r ) );
+      for_( it, query.begin(), query.end() )
+        callback( it );
+    }
+    else
+    {
+      for ( const auto slv : shardMatches( query_r, queryUsed_r, indexMatches_r, shard_r ) )
+        callback( slv );
+    }
+  }
+
+  // A worker passes back rows (or solvable ids) as length prefixed strings.
+  inline void putField( std::string & data_r, const std::string & field_r )
+  {
+    data_r += str::numstring( field_r.size() );
+    data_r += ':';
+    data_r += field_r;
+  }
+
+  inline bool getField( const std::string & data_r, std::string::size_type & pos_r, std::string & field_r )
+  {
+    std::string::size_type sep = data_r.find( ':', pos_r );
+    if ( sep == std::string::npos )
+      return false;
+    std::string::size_type len = str::strtonum<std::string::size_type>( data_r.substr( pos_r, sep - pos_r ) );
+    if ( sep + 1 + len > data_r.size() )
+      return false;
+    field_r = data_r.substr( sep + 1, len );
+    pos_r = sep + 1 + len;
+    return true;
+  }
+
+  inline bool getNumber( const std::string & data_r, std::string::size_type & pos_r, unsigned & num_r )
+  {
+    std::string field;
+    if ( ! getField( data_r, pos_r, field ) )
+      return false;
+    num_r = str::strtonum<unsigned>( field );
+    return true;
+  }
+
+  /** Per row: #columns, columns, #details, details, solvable id, picklist position. */
+  std::string rowsAsData( const Table & table_r )
+  {
+    std::string ret;
+    for ( const TableRow & row : table_r.rows() )
+    {
+      putField( ret, str::numstring( row.columnsNoTr().size() ) );
+      for ( const std::string & col : row.columnsNoTr() )
+        putField( ret, col );
+      putField( ret, str::numstring( row.details().size() ) );
+      for ( const std::string & detail : row.details() )
+        putField( ret, detail );
+      const SolvableCSI & csi( boost::any_cast<const SolvableCSI &>( row.userData() ) );
+      putField( ret, str::numstring( csi.first.id() ) );
+      putField( ret, str::numstring( csi.second ) );
+    }
+    return ret;
+  }
+
+  bool rowsFromData( const std::string & data_r, Table & table_r )
+  {
+    for ( std::string::size_type pos = 0; pos < data_r.size(); )
+    {
+      TableRow row;
+      std::string field;
+      unsigned count = 0;
+      if ( ! getNumber( data_r, pos, count ) )
+        return false;
+      for ( ; count; --count )
+      {
+        if ( ! getField( data_r, pos, field ) )
+          return false;
+        row.add( std::move(field) );
+      }
+      if ( ! getNumber( data_r, pos, count ) )
+        return false;
+      for ( ; count; --count )
+      {
+        if ( ! getField( data_r, pos, field ) )
+          return false;
+        row.addDetail( std::move(field) );
+      }
+      unsigned id = 0;
+      unsigned picklistPos = 0;
+      if ( ! ( getNumber( data_r, pos, id ) && getNumber( data_r, pos, picklistPos ) ) )
+        return false;
+      row.userData( SolvableCSI( sat::Solvable( id ), picklistPos ) );
+      table_r << std::move(row);
+    }
+    return true;
+  }
+
+  std::string idsAsData( const PoolQueryResult & matches_r )
+  {
+    std::string ret;
+    for ( const auto & slv : matches_r )
+      putField( ret, str::numstring( slv.id() ) );
+    return ret;
+  }
+
+  bool idsFromData( const std::string & data_r, PoolQueryResult & matches_r )
+  {
+    for ( std::string::size_type pos = 0; pos < data_r.size(); )
+    {
+      unsigned id = 0;
+      if ( ! getNumber( data_r, pos, id ) )
+        return false;
+      matches_r += sat::Solvable( id );
+    }
+    return true;
+  }
+
+  /** Fill \a table_r like the serial search does, splitting the repos among worker processes.
+   * The workers evaluate the query on their shard and (for \a details_r) build the rows.
+   * The rows are merged in shard order, which is the order the serial search produces.
+   * Shards whose worker failed are redone here.
+   * \return \c false if the search is not worth to be split.
+   */
+  bool parallelSearch( Zypper & zypper, const PoolQuery & query_r, bool queryUsed_r, const PoolQueryResult & indexMatches_r,
+                       bool details_r, bool verbose_r, TriBool instNotinst_r, Table & table_r )
+  {
+    if ( ! query_r.repos().empty() )
+      return false;	// a shard can't narrow a query restricted to some repos
+
+    std::vector<Shard> shards( searchShards( zypper.config().search_jobs ) );
+    if ( shards.empty() )
+      return false;
+    MIL << "Search in " << shards.size() << " worker processes" << endl;
+
+    ResPool::instance().proxy();	// build the selectables once, not in each worker
+    // The rows built by the workers may show the status of patches, patterns or
+    // products. Establish it once here, otherwise each worker runs the solver.
+    if ( details_r && queryMayMatchPPP( query_r ) )
+      establishPPPStatus( zypper );
+
+    WorkerPool pool( shards.size() );
+    for ( const Shard & shard : shards )
+    {
+      pool.add( [&,shard]( std::string & data_r ) -> int {
+        if ( details_r )
+        {
+          Table table;
+          fillShardDetails( table, query_r, queryUsed_r, indexMatches_r, shard, verbose_r, instNotinst_r );
+          data_r = rowsAsData( table );
+        }
+        else
+          data_r = idsAsData( shardMatches( query_r, queryUsed_r, indexMatches_r, shard ) );
+        return 0;
+      } );
+    }
+    std::vector<WorkerPool::Result> results( pool.run() );
+
+    if ( details_r )
+    {
+      FillSearchTableSolvable header( table_r, instNotinst_r );
+      for ( unsigned i = 0; i < shards.size(); ++i )
+      {
+        Table table;
+        if ( ! ( results[i].ok() && rowsFromData( results[i].data, table ) ) )
+        {
+          WAR << "Search worker " << i << " failed (" << results[i].status << "); search its repos here" << endl;
+          table = Table();
+          fillShardDetails( table, query_r, queryUsed_r, indexMatches_r, shards[i], verbose_r, instNotinst_r );
+        }
+        for ( TableRow & row : table.rows() )
+          table_r << std::move(row);
+      }
+    }
+    else
+    {
+      PoolQueryResult matches;
+      for ( unsigned i = 0; i < shards.size(); ++i )
+      {
+        if ( ! ( results[i].ok() && idsFromData( results[i].data, matches ) ) )
+        {
+          WAR << "Search worker " << i << " failed (" << results[i].status << "); search its repos here" << endl;
+          matches += shardMatches( query_r, queryUsed_r, indexMatches_r, shards[i] );
+        }
+      }
+      FillSearchTableSelectable callback( table_r, instNotinst_r );
+      invokeOnEach( matches.selectableBegin(), matches.selectableEnd(), callback );
+    }
+    return true;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // streamed search result
+
+  /** Print the detailed rows of \a matches_r sorted by name as they are built.
+   * Instead of the rows just the solvables are sorted, the way
+   * <tt>Table::sort( { 1, Table::UserData } )</tt> would sort their rows.
+   * The rows are also passed to \a cache_r (if not \c nullptr).
+   * \return The number of rows printed.
+   */
+  unsigned streamDetails( Zypper & zypper, const PoolQueryResult & matches_r, TriBool instNotinst_r, SearchResultCache * cache_r )
+  {
+    struct Item
+    {
+      std::string name;
+      SolvableCSI csi;
+    };
+    std::vector<Item> items;
+    items.reserve( matches_r.size() );
+    for ( const auto & slv : matches_r )
+    {
+      ui::Selectable::Ptr sel { ui::Selectable::get( slv ) };
+      if ( ! sel )
+        continue;
+      ui::Selectable::picklist_size_type picklistPos { ListingCache::forPool().picklistPos( PoolItem( slv ), sel ) };
+      if ( picklistPos == ui::Selectable::picklistNoPos )
+        continue;	// FillSearchTableSolvable would discard it
+      items.push_back( Item { slv.name(), SolvableCSI( slv, picklistPos ) } );
+    }
+    std::stable_sort( items.begin(), items.end(), []( const Item & lhs, const Item & rhs ) {
+      int cmp = lhs.name.compare( rhs.name );
+      if ( ! cmp )
+        cmp = lhs.csi.first.kind().compare( rhs.csi.first.kind() );
+      return cmp ? cmp < 0 : lhs.csi.second < rhs.csi.second;
+    } );
+
+    Table table;
+    FillSearchTableSolvable callback( table, instNotinst_r );
+    unsigned ret = 0;
+    for ( const Item & item : items )
+    {
+      callback( item.csi.first );
+      for ( TableRow & row : table.rows() )
+      {
+        if ( ! ret++ )
+        {
+          cout << endl; //! \todo  out().separator()?
+          zypper.out().searchResultBegin( table );
+        }
+        if ( cache_r )
+          cache_r->storeRow( row );
+        zypper.out().searchResultRow( std::move(row) );
+      }
+      table.rows().clear();
+    }
+    if ( ret )
+      zypper.out().searchResultEnd();
+    return ret;
+  }
+
+  /** Tell there's no match, along with a \a hint_r on possible typos. */
+  void reportNoMatches( Zypper & zypper, const std::string & hint_r )
+  {
+    // translators: empty search result message
+    zypper.out().info(_("No matching items found."), Out::QUIET );
+    zypper.setExitCode( ZYPPER_EXIT_INF_CAP_NOT_FOUND );
+    if ( ! hint_r.empty() )
+      // translators: %1% expands to a single package name or a ','-separated enumeration of names.
+      zypper.out().info( str::Format(_("Did you mean %1%?")) % hint_r, Out::QUIET );
+  }
+
+  /** Print the result stored in \a cache_r the way the search would.
+   * Streamed rows are streamed again, a table is printed as a whole (the
+   * rows are stored in the order they were printed).
+   * \return \c false if there is no cached result.
+   */
+  bool replayCachedResult( Zypper & zypper, const SearchResultCache & cache_r, bool abbrev_r )
+  {
+    Table table;
+    unsigned rows = 0;
+    bool streamed = false;
+    std::string hint;
+    bool found = cache_r.replay( [&]( bool details_r, bool streamed_r, TableRow row_r ) {
+      if ( ! rows++ )
+      {
+        if ( details_r )
+          FillSearchTableSolvable header( table );
+        else
+          FillSearchTableSelectable header( table );
+        if ( abbrev_r )
+          table.allowAbbrev( 2 );
+        streamed = streamed_r;
+        if ( streamed )
+        {
+          cout << endl; //! \todo  out().separator()?
+          zypper.out().searchResultBegin( table );
+        }
+      }
+      if ( streamed )
+        zypper.out().searchResultRow( std::move(row_r) );
+      else
+        table << std::move(row_r);
+    }, hint );
+
+    if ( ! found )
+      return false;
+    if ( ! rows )
+      reportNoMatches( zypper, hint );
+    else if ( streamed )
+      zypper.out().searchResultEnd();
+    else
+    {
+      cout << endl; //! \todo  out().separator()?
+      zypper.out().searchResult( table );
+    }
+    return true;
+  }
 }
 
 
@@ -223,6 +616,33 @@ void SearchCmd::doReset()
   _requestedTypes.clear();
 }
 
+std::string SearchCmd::cacheQuery( Zypper & zypper, const std::vector<std::string> & positionalArgs_r ) const
+{
+  str::Str ret;
+  ret << "mode: " << _mode << " " << _forceNameAttr << _searchDesc << _caseSensitive << _details << _verbose << endl;
+  ret << "deps:";
+  for ( const sat::SolvAttr & dep : _requestedDeps )
+    ret << " " << dep.asString();
+  ret << endl;
+  ret << "reverse: " << ( _requestedReverseSearch ? _requestedReverseSearch->asString() : std::string() ) << endl;
+  ret << "types:";
+  for ( const ResKind & kind : _requestedTypes )
+    ret << " " << kind.asString();
+  ret << endl;
+  ret << "filter: " << int(_notInstalledOpts._mode) << " sort: " << int(_sortOpts._mode) << " abbrev: " << !zypper.config().no_abbrev << endl;
+
+  std::vector<std::string> repoFilter( InitRepoSettings::instance()._repoFilter );
+  std::sort( repoFilter.begin(), repoFilter.end() );
+  ret << "repos:";
+  for ( const std::string & repo : repoFilter )
+    ret << " " << repo;
+  ret << endl;
+
+  for ( const std::string & arg : positionalArgs_r )
+    ret << "arg: " << arg << endl;
+  return ret;
+}
+
 int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &positionalArgs_r )
 {
   // check args...
@@ -272,7 +692,27 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
   }
 
   // load system data...
-  int code = defaultSystemSetup(  zypper, InitTarget | InitRepos | LoadResolvables | Resolve  );
+  int code = defaultSystemSetup(  zypper, InitTarget | InitRepos  );
+  if ( code != ZYPPER_EXIT_OK )
+    return code;
+
+  // a cached result does not need the pool
+  std::unique_ptr<SearchResultCache> cache;
+  if ( zypper.config().search_cache )
+  {
+    cache.reset( new SearchResultCache( zypper, cacheQuery( zypper, positionalArgs_r ) ) );
+    if ( ! cache->usable() )
+      cache.reset();
+    else if ( replayCachedResult( zypper, *cache, !_details && !zypper.config().no_abbrev ) )
+    {
+      if ( !_requestedReverseSearch.is_initialized() )
+        searchPackagesHintHack::callOrNotify( zypper );
+      return zypper.exitCode();
+    }
+  }
+
+  // The PPP status is established when the first patch, pattern or product is shown.
+  code = defaultSystemSetup(  zypper, LoadResolvables  );
   if ( code != ZYPPER_EXIT_OK )
     return code;
 
@@ -297,6 +737,13 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
     _requestedDeps.insert( sat::SolvAttr::name );
 
   bool details = _details || _verbose;
+
+  // Names and descriptions are looked up in the search indexes unless the
+  // query is needed for the match details or a reverse search.
+  bool useIndex = ! _verbose && ! _requestedReverseSearch.is_initialized();
+  PoolQueryResult indexMatches;	// found in the search indexes
+  bool indexUsed = false;
+  bool queryUsed = false;	// an empty query would match everything
   // add argument strings and attributes to query
   for_( it, positionalArgs_r.begin(), positionalArgs_r.end() )
   {
@@ -328,20 +775,40 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
     }
     // else: match mode explicitly requested by cli arg
 
+    // editions and architectures are matched by the query only
+    bool argIndexable = useIndex && ! cap.detail().isVersioned() && cap.detail().arch().empty();
+
     // NOTE: We use the  addDependency  overload taking a  matchmode  argument for ALL
     // kinds of attributes, not only for dependencies. A constraint on 'op version'
     // will automatically be applied to match a matching dependency or to match
     // the matching solvables version, depending on the kind of attribute.
     for ( const zypp::sat::SolvAttr &attr : _requestedDeps ) {
 
-      //add the basic dependency
-      query.addDependency( attr , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
+      //add the basic dependency (names and file lists may be found in the search indexes)
+      bool indexed = false;
+      if ( argIndexable )
+      {
+        if ( attr == sat::SolvAttr::name )
+          indexed = search_names( zypper, name, matchmode, query, indexMatches );
+        else if ( attr == sat::SolvAttr::filelist )
+          indexed = search_files( zypper, name, matchmode, query, indexMatches );
+      }
+      if ( indexed )
+        indexUsed = true;
+      else
+      {
+        query.addDependency( attr , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
+        queryUsed = true;
+      }
 
       //handle special cases
       if ( attr == sat::SolvAttr::provides && str::regex_match( name.c_str(), std::string("^/") ) ) {
         // in case of path names also search in file list
         query.setFilesMatchFullPath( true );
-        query.addDependency( sat::SolvAttr::filelist , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
+        if ( argIndexable && search_files( zypper, name, matchmode, query, indexMatches ) )
+          indexUsed = true;
+        else
+          query.addDependency( sat::SolvAttr::filelist , name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
 
       } else if ( attr == sat::SolvAttr::filelist ) {
 
@@ -362,6 +829,7 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
             std::string r( name.substr(pos+1) );
             Edition e( r );
             query.addDependency( sat::SolvAttr::name, n, Rel::EQ, e, Arch(cap.detail().arch()), Match::STRING );
+            queryUsed = true;
             if ( poolExpectMatchFor( n, e ) )
               details = true;	// show details if any search string includes an edition
 
@@ -381,18 +849,28 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
 
     if ( _searchDesc )
     {
-      query.addDependency( sat::SolvAttr::summary, name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
-      query.addDependency( sat::SolvAttr::description, name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
+      // Plain words and substrings are looked up in the description index,
+      // regex and glob are left to the query.
+      if ( argIndexable && matchmode == Match::OTHER && search_descriptions( zypper, name, query, indexMatches ) )
+        indexUsed = true;
+      else
+      {
+        query.addDependency( sat::SolvAttr::summary, name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
+        query.addDependency( sat::SolvAttr::description, name, cap.detail().op(), cap.detail().ed(), Arch(cap.detail().arch()), matchmode );
+        queryUsed = true;
+      }
     }
   }
 
   Table t;
+  bool streamed = false;	// rows were printed as they were built
+  unsigned streamedRows = 0;
   try
   {
     if ( _requestedReverseSearch.is_initialized() ) {
 
-      std::unordered_map< sat::Solvable, CapabilitySet > matchedSolvables;
       const auto reqSearchAttrib = _requestedReverseSearch.get();
+      std::vector<sat::Solvable> providers;
 
       for ( const auto slv : query ) {
 
@@ -402,20 +880,13 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
         if ( !isInstalled && _notInstalledOpts._mode == SolvableFilterMode::ShowOnlyInstalled )
           continue;
 
-        sat::Queue q = sat::Pool::instance().whatMatchesSolvable( reqSearchAttrib, slv  );
-
-        for ( auto matchedSolvId : q ) {
-
-          sat::Solvable matchedSolv ( static_cast<sat::Solvable::IdType>(matchedSolvId) );
-          auto p = matchedSolvables.insert( make_pair( std::move(matchedSolv), CapabilitySet()) );
-
-          if ( _verbose ) {
-            CapabilitySet matchedCaps = matchedSolv.matchesSolvable( reqSearchAttrib, slv).second;
-            p.first->second.insert( matchedCaps.begin(), matchedCaps.end() );
-          }
-        }
+        providers.push_back( slv );
       }
 
+      // All matches are looked up in one index instead of scanning the pool for each.
+      ReverseDependencies::DependentsMap matchedSolvables;
+      ReverseDependencies::forPool( reqSearchAttrib ).dependents( providers, matchedSolvables, _verbose );
+
       if ( details ) {
         FillSearchTableSolvable callback( t, inst_notinst );
         std::for_each( matchedSolvables.begin(), matchedSolvables.end(), [&callback, verb = _verbose, &reqSearchAttrib ]( auto elem ){
@@ -433,11 +904,36 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
         std::for_each( res.selectableBegin(), res.selectableEnd(), callback);
       }
 
+    } else if ( parallelSearch( zypper, query, queryUsed || ! indexUsed, indexMatches, details, _verbose, inst_notinst, t ) ) {
+      ; // t is filled
+    } else if ( _details && ! _verbose && _sortOpts._mode != SortResultOptionSet::ByRepo ) {
+      // The rows are printed as they are built, sorted by name.
+      PoolQueryResult result;
+      if ( queryUsed || ! indexUsed )
+        result += query;
+      result += indexMatches;
+      streamed = true;
+      if ( cache )
+        cache->storeBegin( true, true );
+      streamedRows = streamDetails( zypper, result, inst_notinst, cache.get() );
     } else {
+      PoolQueryResult result;
+      if ( indexUsed )
+      {
+        if ( queryUsed )
+          result += query;
+        result += indexMatches;
+      }
+
       if ( details )
       {
         FillSearchTableSolvable callback( t, inst_notinst );
-        if ( _verbose )
+        if ( indexUsed )
+        {
+          for ( const auto slv : result )
+            callback( slv );
+        }
+        else if ( _verbose )
         {
           // Option 'verbose' shows where (e.g. in 'requires', 'name') the search has matched.
           // Info is available from PoolQuery::const_iterator.
@@ -453,17 +949,41 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
       else
       {
         FillSearchTableSelectable callback( t, inst_notinst );
-        invokeOnEach( query.selectableBegin(), query.selectableEnd(), callback );
+        if ( indexUsed )
+          invokeOnEach( result.selectableBegin(), result.selectableEnd(), callback );
+        else
+          invokeOnEach( query.selectableBegin(), query.selectableEnd(), callback );
       }
     }
 
-    if ( t.empty() )
+    if ( streamed ? ! streamedRows : t.empty() )
     {
-      // translators: empty search result message
-      zypper.out().info(_("No matching items found."), Out::QUIET );
-      zypper.setExitCode( ZYPPER_EXIT_INF_CAP_NOT_FOUND );
+      std::string hint;	// on possible typos
+      if ( !_requestedReverseSearch.is_initialized() )
+      {
+        for ( const std::string & arg : positionalArgs_r )
+        {
+          std::string name( Capability( arg ).detail().name().asString() );
+          if ( name.find_first_of( "*?[/:" ) != std::string::npos )
+            continue;	// glob, regex or kind
+          for ( const std::string & similar : similar_names( zypper, name, query ) )
+          {
+            if ( ! hint.empty() )
+              hint += ", ";
+            hint += similar;
+          }
+        }
+      }
+      reportNoMatches( zypper, hint );
+
+      if ( cache )
+      {
+        if ( ! streamed )
+          cache->storeBegin( details, false );
+        cache->storeEnd( hint );
+      }
     }
-    else
+    else if ( ! streamed )
     {
       cout << endl; //! \todo  out().separator()?
 
@@ -484,7 +1004,17 @@ int SearchCmd::execute( Zypper &zypper, const std::vector<std::string> &position
 
       //cout << t; //! \todo out().table()?
       zypper.out().searchResult( t );
+
+      if ( cache )
+      {
+        cache->storeBegin( details, false );
+        for ( const TableRow & row : t.rows() )
+          cache->storeRow( row );
+        cache->storeEnd( std::string() );
+      }
     }
+    else if ( cache )
+      cache->storeEnd( std::string() );
 
     if ( !_requestedReverseSearch.is_initialized() )
       searchPackagesHintHack::callOrNotify( zypper );
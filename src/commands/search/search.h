@@ -48,6 +48,9 @@ private:
   SortResultOptionSet _sortOpts { *this };
   InitReposOptionSet _initReposOpts { *this };
 
+  /** The search options and arguments identifying a \ref SearchResultCache entry. */
+  std::string cacheQuery( Zypper & zypper, const std::vector<std::string> & positionalArgs_r ) const;
+
   // ZypperBaseCommand interface
 protected:
   zypp::ZyppFlags::CommandGroup cmdOptions() const override;
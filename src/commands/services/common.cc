@@ -5,9 +5,20 @@
                              |__/|_|  |_|
 \*---------------------------------------------------------------------------*/
 
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <set>
+
 #include "common.h"
 #include "repos.h"
+#include "utils/WorkerPool.h"
 
+#include <zypp/PathInfo.h>
+#include <zypp/MediaSetAccess.h>
+#include <zypp/KeyRing.h>
+#include <zypp/Digest.h>
+#include <zypp/ZYppCallbacks.h>
 #include <zypp/media/MediaException.h>
 
 ServiceList get_all_services( Zypper & zypper )
@@ -148,10 +159,282 @@ bool refresh_service(Zypper & zypper, const ServiceInfo & service, RepoManager::
 			_("Check if the URI is valid and accessible.") );
     zypper.setExitCode( ZYPPER_EXIT_ERR_ZYPP );
   }
+  // even a failed refresh may have changed some of the service's repos
+  zypper.repoIndexChanged();
 
   return error;
 }
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class ServiceIndexCookies
+  /// \brief Persistent service alias -> last applied RIS index cookie.
+  ///
+  /// Stored one service per line: <tt>alias TAB cookie</tt>
+  /// (see \ref serviceIndexCookie).
+  ///////////////////////////////////////////////////////////////////
+  class ServiceIndexCookies
+  {
+  public:
+    explicit ServiceIndexCookies( Pathname file_r )
+    : _file( std::move(file_r) )
+    {
+      std::ifstream in( _file.c_str() );
+      std::string line;
+      while ( std::getline( in, line ) )
+      {
+	std::string::size_type tab = line.find( '\t' );
+	if ( tab != std::string::npos && tab )
+	  _cookies[line.substr( 0, tab )] = line.substr( tab + 1 );
+      }
+      DBG << "Read " << _cookies.size() << " service index cookies from " << _file << endl;
+    }
+
+    const std::string & get( const std::string & alias_r ) const
+    {
+      static const std::string _none;
+      auto it = _cookies.find( alias_r );
+      return it == _cookies.end() ? _none : it->second;
+    }
+
+    void set( const std::string & alias_r, const std::string & cookie_r )
+    {
+      if ( get( alias_r ) == cookie_r )
+	return;
+      _cookies[alias_r] = cookie_r;
+      save();
+    }
+
+  private:
+    void save()
+    {
+      Pathname tmp( _file.extend( ".new" ) );
+      {
+	std::ofstream out( tmp.c_str() );
+	for ( const auto & el : _cookies )
+	  out << el.first << "\t" << el.second << endl;
+	if ( ! out )
+	{
+	  WAR << "Can't write service index cookies " << tmp << endl;
+	  filesystem::unlink( tmp );
+	  return;
+	}
+      }
+      if ( filesystem::rename( tmp, _file ) != 0 )
+	filesystem::unlink( tmp );
+    }
+
+    Pathname _file;
+    std::map<std::string,std::string> _cookies;
+  };
+
+  ServiceIndexCookies & serviceIndexCookies( Zypper & zypper )
+  {
+    static ServiceIndexCookies _cookies( zypper.config().rm_options.repoCachePath / "service-index" );
+    return _cookies;
+  }
+
+  /** The URL refreshService retrieves the \c repoindex.xml of \a service from. */
+  Url serviceIndexUrl( Zypper & zypper, const ServiceInfo & service )
+  {
+    Url url( service.url() );	// $releasever and friends already replaced
+    url.setQueryParam( "cookies", "0" );
+    const std::string & targetDistro( zypper.config().rm_options.servicesTargetDistro );
+    if ( ! targetDistro.empty() )
+      url.setQueryParam( "distribution", targetDistro );
+    return url;
+  }
+
+  /** Whether skipping \a service can be considered at all.
+   * Only a RIS service whose TTL expired (so refreshService would actually
+   * download its index) and which has no pending repos to enable or disable.
+   */
+  bool serviceIndexMayBeSkipped( const ServiceInfo & service )
+  {
+    if ( service.type() != repo::ServiceType::RIS )
+      return false;
+    if ( ! service.reposToEnableEmpty() || ! service.reposToDisableEmpty() )
+      return false;
+    return ! service.ttl() || service.lrf() + service.ttl() <= Date::now();
+  }
+
+  /** Checksum of the services current \c repoindex.xml.
+   * The media layer does not offer conditional requests, but the index is
+   * small compared to applying it (which parses and compares every repo).
+   * \throws media::MediaException if the index can't be retrieved.
+   */
+  std::string serviceIndexChecksum( Zypper & zypper, const ServiceInfo & service )
+  {
+    MediaSetAccess access( serviceIndexUrl( zypper, service ) );
+    return filesystem::checksum( access.provideFile( "repo/repoindex.xml" ), Digest::sha256() );
+  }
+
+  /** The cookie of \a service: \a checksum_r of its index, the URL it was
+   * retrieved from (including $releasever and the target distribution),
+   * and the state of the repos the service created.
+   */
+  std::string serviceIndexCookie( Zypper & zypper, const ServiceInfo & service, const std::string & checksum_r )
+  {
+    std::list<RepoInfo> repos;
+    zypper.repoManager().getRepositoriesInService( service.alias(), std::back_inserter( repos ) );
+    std::set<std::string> states;
+    for ( const RepoInfo & repo : repos )
+      states.insert( repo.alias() + ( repo.enabled() ? "+" : "-" ) + ( repo.autorefresh() ? "+" : "-" ) );
+    return checksum_r + " " + serviceIndexUrl( zypper, service ).asCompleteString() + " " + str::join( states, "," );
+  }
+
+  /** Whether \a service must be applied again; \a checksum_r is set if the index was checked. */
+  bool serviceIndexChanged( Zypper & zypper, const ServiceInfo & service, std::string & checksum_r )
+  {
+    checksum_r.clear();
+    if ( ! serviceIndexMayBeSkipped( service ) )
+      return true;
+
+    try
+    {
+      checksum_r = serviceIndexChecksum( zypper, service );
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      return true;	// let refreshService report the error
+    }
+
+    const std::string & last( serviceIndexCookies( zypper ).get( service.alias() ) );
+    return last.empty() || last != serviceIndexCookie( zypper, service, checksum_r );
+  }
+
+  /** Remember the index \a checksum_r was applied to \a service. */
+  void rememberServiceIndex( Zypper & zypper, const ServiceInfo & service, const std::string & checksum_r )
+  {
+    if ( ! checksum_r.empty() )
+      serviceIndexCookies( zypper ).set( service.alias(), serviceIndexCookie( zypper, service, checksum_r ) );
+  }
+
+  /** \a service was found up to date: store the time of this refresh like
+   * refreshService would, so its TTL applies again.
+   */
+  void skipServiceIndex( Zypper & zypper, const ServiceInfo & service )
+  {
+    MIL << "Index of service '" << service.alias() << "' is unchanged" << endl;
+    zypper.out().info( str::Format(_("Service '%s' is up to date.")) % service.asUserString(), Out::HIGH );
+    try
+    {
+      ServiceInfo updated( zypper.repoManager().getService( service.alias() ) );
+      updated.setLrf( Date::now() );
+      zypper.repoManager().modifyService( service.alias(), updated );
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      WAR << "Can't store the last refresh time of service '" << service.alias() << "'" << endl;
+    }
+  }
+
+  /** Payload tags passed back by a service refresh worker. */
+  enum ServiceWorkerTag : char
+  {
+    TAG_UNCHANGED	= 'u',	///< index did not change and was not applied
+    TAG_REFRESHED	= 'r',	///< service was refreshed; followed by the index checksum (if checked)
+  };
+
+  /** The job executed by a service refresh worker.
+   * It's the silent counterpart of \ref refresh_service. Any exception
+   * (even the informal ones of plugin services) makes the job fail and the
+   * service must be refreshed again in the parent.
+   */
+  int refreshServiceInWorker( Zypper & zypper, const ServiceInfo & service, RepoManager::RefreshServiceFlags flags_r, bool checkIndex_r, std::string & data_r )
+  {
+    zypper.configNoConst().non_interactive = true;
+    callback::TempConnect<KeyRingReport> noKeyRingReport;
+    callback::TempConnect<DigestReport> noDigestReport;
+    callback::TempConnect<media::MediaChangeReport> noMediaChangeReport;
+
+    std::string checksum;
+    if ( checkIndex_r && ! serviceIndexChanged( zypper, service, checksum ) )
+    {
+      data_r += TAG_UNCHANGED;	// the parent stores the refresh time
+      return 0;
+    }
+    zypper.repoManager().refreshService( service, flags_r );
+    data_r += TAG_REFRESHED;
+    data_r += checksum;
+    return 0;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+std::vector<bool> refresh_services( Zypper & zypper, const std::vector<ServiceInfo> & services, RepoManager::RefreshServiceFlags flags_r, bool checkIndex_r )
+{
+  init_target( zypper );	// need targetDistribution for service refresh, also in the workers
+  if ( flags_r.testFlag( RepoManager::RefreshService_forceRefresh ) || flags_r.testFlag( RepoManager::RefreshService_restoreStatus ) )
+    checkIndex_r = false;
+
+  std::vector<WorkerPool::Result> results( services.size() );
+  unsigned jobs = zypper.config().service_refresh_jobs;
+  if ( jobs > 1 && services.size() > 1 )
+  {
+    MIL << "Refreshing " << services.size() << " services in up to " << jobs << " workers" << endl;
+    WorkerPool pool( jobs );
+    for ( const ServiceInfo & service : services )
+    {
+      pool.add( [&zypper,&service,flags_r,checkIndex_r]( std::string & data_r ) {
+	return refreshServiceInWorker( zypper, service, flags_r, checkIndex_r, data_r );
+      } );
+    }
+    results = pool.run();
+
+    // the workers changed the repo and service files
+    for ( const WorkerPool::Result & result : results )
+    {
+      if ( result.ok() && ! result.data.empty() && result.data[0] == TAG_REFRESHED )
+      {
+	zypper.initRepoManager();
+	break;
+      }
+    }
+  }
+
+  std::vector<bool> errors;
+  for ( unsigned i = 0; i < services.size(); ++i )
+  {
+    const ServiceInfo & service( services[i] );
+    const WorkerPool::Result & result( results[i] );
+    std::string checksum;
+
+    if ( result.ok() && ! result.data.empty() )
+    {
+      if ( result.data[0] == TAG_UNCHANGED )
+	skipServiceIndex( zypper, service );
+      else
+      {
+	MIL << "Service '" << service.alias() << "' was refreshed in a worker" << endl;
+	zypper.out().info( str::form(_("Refreshing service '%s'."), service.asUserString().c_str() ) );
+	rememberServiceIndex( zypper, service, result.data.substr( 1 ) );
+      }
+      errors.push_back( false );
+      continue;
+    }
+    if ( jobs > 1 && services.size() > 1 )
+      WAR << "Worker failed to refresh service '" << service.alias() << "' (" << result.status << "): " << result.data << endl;
+
+    if ( checkIndex_r && ! serviceIndexChanged( zypper, service, checksum ) )
+    {
+      skipServiceIndex( zypper, service );
+      errors.push_back( false );
+      continue;
+    }
+
+    bool error = refresh_service( zypper, service, flags_r );
+    if ( ! error )
+      rememberServiceIndex( zypper, service, checksum );
+    errors.push_back( error );
+  }
+  return errors;
+}
+
 void remove_service( Zypper & zypper, const ServiceInfo & service )
 {
   RepoManager & manager( zypper.repoManager() );
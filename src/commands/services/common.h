@@ -14,6 +14,7 @@
 #include <zypp/RepoManager.h>
 
 #include <list>
+#include <vector>
 
 struct RepoCollector
 {
@@ -31,6 +32,15 @@ ServiceList get_all_services( Zypper & zypper );
 
 bool match_service( Zypper & zypper, std::string str, repo::RepoInfoBase_Ptr & service_ptr, bool looseAuth, bool looseQuery );
 bool refresh_service(Zypper & zypper, const ServiceInfo & service, RepoManager::RefreshServiceFlags flags_r = RepoManager::RefreshServiceFlags() );
+/** Refresh \a services, up to \ref Config::service_refresh_jobs of them concurrently.
+ * Services failing in a worker are refreshed serially via \ref refresh_service.
+ * If \a checkIndex_r is set, a RIS service due for refresh is not applied
+ * again if neither its \c repoindex.xml (nor the URL it is retrieved from)
+ * nor its repos changed since it was last applied; only its last refresh
+ * time is updated then.
+ * \return whether refreshing failed, per service.
+ */
+std::vector<bool> refresh_services( Zypper & zypper, const std::vector<ServiceInfo> & services, RepoManager::RefreshServiceFlags flags_r = RepoManager::RefreshServiceFlags(), bool checkIndex_r = false );
 void remove_service( Zypper & zypper, const ServiceInfo & service );
 
 
@@ -228,6 +228,7 @@ int ModifyServiceCmd::modifyService( Zypper & zypper, const std::string & alias
       || !rrtodisable.empty() )
     {
       manager.modifyService( alias, srv );
+      zypper.repoIndexChanged();	// service repos may have been enabled/disabled
 
       if ( changed_enabled )
       {
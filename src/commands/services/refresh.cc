@@ -18,6 +18,8 @@
 #include <zypp/base/Iterator.h>
 #include <zypp/media/MediaException.h>
 
+#include <map>
+
 using namespace zypp;
 
 /**
@@ -30,6 +32,11 @@ template<typename T>
 void get_services( Zypper & zypper, const T & begin, const T & end,
 		   ServiceList & services, std::list<std::string> & not_found )
 {
+  // (is service, alias) of the services and repos found so far
+  std::multimap<std::pair<bool,std::string>,repo::RepoInfoBase_Ptr> found;
+  for ( const repo::RepoInfoBase_Ptr & el : services )
+    found.insert( std::make_pair( std::make_pair( bool(dynamic_pointer_cast<ServiceInfo>(el)), el->alias() ), el ) );
+
   for_( it, begin, end )
   {
     repo::RepoInfoBase_Ptr service;
@@ -43,21 +50,16 @@ void get_services( Zypper & zypper, const T & begin, const T & end,
     // service found
     // is it a duplicate? compare by alias and URIs
     //! \todo operator== in RepoInfo?
+    // Only services (or repos) with equal alias can be duplicates.
+    ServiceInfo_Ptr current_service_ptr = dynamic_pointer_cast<ServiceInfo>(service);
     bool duplicate = false;
-    for_( serv_it, services.begin(), services.end() )
+    auto range = found.equal_range( std::make_pair( bool(current_service_ptr), service->alias() ) );
+    for_( serv_it, range.first, range.second )
     {
-      ServiceInfo_Ptr s_ptr = dynamic_pointer_cast<ServiceInfo>(*serv_it);
-      ServiceInfo_Ptr current_service_ptr = dynamic_pointer_cast<ServiceInfo>(service);
-
-      // one is a service, the other is a repo
-      if ( s_ptr && !current_service_ptr )
-        continue;
-
       // service
-      if ( s_ptr )
+      if ( current_service_ptr )
       {
-        if ( s_ptr->alias() == current_service_ptr->alias()
-	  && s_ptr->url() == current_service_ptr->url() )
+        if ( dynamic_pointer_cast<ServiceInfo>(serv_it->second)->url() == current_service_ptr->url() )
         {
           duplicate = true;
           break;
@@ -65,15 +67,18 @@ void get_services( Zypper & zypper, const T & begin, const T & end,
       }
       // repo
       else if ( repo_cmp_alias_urls( *dynamic_pointer_cast<RepoInfo>(service),
-				     *dynamic_pointer_cast<RepoInfo>(*serv_it) ) )
+				     *dynamic_pointer_cast<RepoInfo>(serv_it->second) ) )
       {
         duplicate = true;
         break;
       }
-    } // END for all found so far
+    } // END for all found so far with this alias
 
     if ( !duplicate )
+    {
       services.push_back( service );
+      found.insert( std::make_pair( std::make_pair( bool(current_service_ptr), service->alias() ), service ) );
+    }
   }
 }
 
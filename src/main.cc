@@ -18,6 +18,7 @@
 #include "callbacks/job.h"
 #include "output/OutNormal.h"
 #include "utils/messages.h"
+#include "utils/console.h"
 
 void signal_handler( int sig )
 {
@@ -92,6 +93,9 @@ int main( int argc, char **argv )
   bindtextdomain( PACKAGE, LOCALEDIR );
   textdomain( PACKAGE );
 
+  // before anything is written to stdout
+  OutputBuffer::setup();
+
   // logging
   const char *logfile = getenv("ZYPP_LOGFILE");
   if ( logfile == NULL )
@@ -116,6 +116,22 @@ void Out::searchResult( const Table & table_r )
   std::cout << table_r;
 }
 
+void Out::searchResultBegin( const Table & table_r )
+{
+  _searchResult.reset( new Table( table_r ) );
+  _searchResult->rows().clear();
+  _searchResult->streamTo( std::cout, searchResultSample );
+}
+
+void Out::searchResultRow( TableRow row_r )
+{ *_searchResult << std::move(row_r); }
+
+void Out::searchResultEnd()
+{
+  _searchResult->endStream();
+  _searchResult.reset();
+}
+
 ////////////////////////////////////////////////////////////////////////////////
 //	class Out::Error
 ////////////////////////////////////////////////////////////////////////////////
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <sstream>
+#include <memory>
 
 #include <zypp/base/Xml.h>
 #include <zypp/base/NonCopyable.h>
@@ -821,6 +822,25 @@ public:
    */
   virtual void searchResult( const Table & table_r );
 
+  /** \name Streamed search result.
+   * Like \ref searchResult, but the rows are passed one by one as they are
+   * built, so the whole result need not be kept in memory. \a table_r passed
+   * to \ref searchResultBegin defines the header and layout; its rows are
+   * ignored. Every \ref searchResultBegin must be closed by \ref searchResultEnd.
+   *
+   * Default implementation streams the rows to \c stdout, the column
+   * widths taken from the first \ref searchResultSample rows (see
+   * \ref Table::streamTo).
+   */
+  //@{
+  virtual void searchResultBegin( const Table & table_r );
+  virtual void searchResultRow( TableRow row_r );
+  virtual void searchResultEnd();
+
+  /** Number of rows the column widths are computed from. */
+  static const unsigned searchResultSample = 1000;
+  //@}
+
   /**
    * Prompt the user for a decision.
    *
@@ -925,6 +945,7 @@ protected:
 private:
   Verbosity _verbosity;
   const TypeBit _type;
+  std::unique_ptr<Table> _searchResult;	//!< streamed search result
 };
 
 ZYPP_DECLARE_OPERATORS_FOR_FLAGS(Out::Type);
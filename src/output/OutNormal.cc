@@ -18,6 +18,7 @@
 
 #include "main.h"
 #include "utils/colors.h"
+#include "utils/console.h"
 #include "AliveCursor.h"
 
 #include "OutNormal.h"
@@ -55,7 +56,7 @@ void OutNormal::info( const std::string & msg_r, Verbosity verbosity_r, Type mas
     return;
 
   if ( !_newline )
-    cout << endl;
+    cout << '\n';
 
   ColorString msg( msg_r, ColorContext::MSG_STATUS );
   if ( verbosity_r == Out::QUIET )
@@ -63,7 +64,7 @@ void OutNormal::info( const std::string & msg_r, Verbosity verbosity_r, Type mas
   else if ( verbosity_r == Out::DEBUG )
     msg = ColorContext::OSDEBUG;
 
-  cout << msg << endl;
+  cout << msg << '\n';
   _newline = true;
 }
 
@@ -76,16 +77,16 @@ void OutNormal::warning( const std::string & msg, Verbosity verbosity_r, Type ma
     return;
 
   if ( !_newline )
-    cout << endl;
+    cout << '\n';
 
-  cout << ( ColorContext::MSG_WARNING << _("Warning: ") ) << msg << endl;
+  cout << ( ColorContext::MSG_WARNING << _("Warning: ") ) << msg << '\n';
   _newline = true;
 }
 
 void OutNormal::error( const std::string & problem_desc, const std::string & hint )
 {
   if ( !_newline )
-    cout << endl;
+    cout << '\n';
 
   cerr << ( ColorContext::MSG_ERROR << problem_desc );
   if ( !hint.empty() && verbosity() > Out::QUIET )
@@ -99,7 +100,7 @@ void OutNormal::error( const std::string & problem_desc, const std::string & hin
 void OutNormal::error( const Exception & e, const std::string & problem_desc, const std::string & hint )
 {
   if ( !_newline )
-    cout << endl;
+    cout << '\n';
 
   // problem and cause
   cerr << ( ColorContext::MSG_ERROR << problem_desc << endl << zyppExceptionReport(e) ) << endl;
@@ -229,7 +230,7 @@ void OutNormal::progressEnd( const std::string & id, const std::string & label,
   outstr.rhs << ']';
 
   std::string outline( outstr.get( termwidth() ) );
-  cout << outline << endl << std::flush;
+  cout << outline << '\n' << std::flush;
   _newline = true;
 
   if ( !error && _use_colors )
@@ -343,7 +344,7 @@ void OutNormal::dwnldProgressEnd( const Url & uri, long rate, TriBool error )
   outstr.rhs << ']';
 
   std::string outline( outstr.get( termwidth() ) );
-  cout << outline << endl << std::flush;
+  cout << outline << '\n' << std::flush;
   _newline = true;
 
   if ( bool(!error) && _use_colors )
@@ -353,7 +354,7 @@ void OutNormal::dwnldProgressEnd( const Url & uri, long rate, TriBool error )
 void OutNormal::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
 {
   if ( !_newline )
-    cout << endl;
+    cout << '\n';
 
   if ( startdesc.empty() )
   {
@@ -361,7 +362,7 @@ void OutNormal::prompt( PromptId id, const std::string & prompt, const PromptOpt
       cout << ansi::tty::clearLN;
   }
   else
-    cout << startdesc << endl;
+    cout << startdesc << '\n';
 
   std::ostringstream pstr;
   ColorStream cout( pstr, ColorContext::PROMPT ); // scoped color on std::cout
@@ -411,10 +412,10 @@ void OutNormal::prompt( PromptId id, const std::string & prompt, const PromptOpt
 
 void OutNormal::promptHelp( const PromptOptions & poptions )
 {
-  cout << endl;
+  cout << '\n';
 
   if ( poptions.helpEmpty() )
-    cout << _("No help available for this prompt.") << endl;
+    cout << _("No help available for this prompt.") << '\n';
 
   // Nevertheless list all option names and their '#NUM' shortcut
   unsigned pos = 0;	// Userland counter #NUM  (starts with #1)
@@ -435,11 +436,11 @@ void OutNormal::promptHelp( const PromptOptions & poptions )
       else
 	cout << help;
     }
-    cout << endl;
+    cout << '\n';
   }
 
   ColorStream cout( std::cout, ColorContext::PROMPT ); // scoped color on std::cout
-  cout << endl << ColorString( poptions.optionString() ) << ": " << std::flush;
+  cout << '\n' << ColorString( poptions.optionString() ) << ": " << std::flush;
   // prompt ends with newline (user hits <enter>) unless exited abnormaly
   _newline = true;
 }
@@ -448,9 +449,8 @@ unsigned OutNormal::termwidth() const
 {
   if ( _isatty )
   {
-    struct winsize wns;
-    if ( !ioctl( 1, TIOCGWINSZ, &wns ) )
-      return wns.ws_col;
+    if ( unsigned cols = TermGeometry::columns() )
+      return cols;
   }
   return Out::termwidth();	// unlimited
 }
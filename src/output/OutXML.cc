@@ -10,18 +10,17 @@
 #include "Table.h"
 
 using std::cout;
-using std::endl;
 
 OutXML::OutXML( Verbosity verbosity_r )
 : Out( TYPE_XML, verbosity_r)
 {
-  cout << "<?xml version='1.0'?>" << endl;
-  cout << "<stream>" << endl;
+  cout << "<?xml version='1.0'?>\n";
+  cout << "<stream>\n";
 }
 
 OutXML::~OutXML()
 {
-  cout << "</stream>" << endl;
+  cout << "</stream>\n";
 }
 
 bool OutXML::mine( Type type )
@@ -47,7 +46,7 @@ void OutXML::info( const std::string & msg, Verbosity verbosity_r, Type mask )
     return;
 
   cout << "<message type=\"info\">" << xml::escape( msg )
-       << "</message>" << endl;
+       << "</message>\n";
 }
 
 void OutXML::warning( const std::string & msg, Verbosity verbosity_r, Type mask )
@@ -56,13 +55,13 @@ void OutXML::warning( const std::string & msg, Verbosity verbosity_r, Type mask
     return;
 
   cout << "<message type=\"warning\">" << xml::escape( msg )
-       << "</message>" << endl;
+       << "</message>\n";
 }
 
 void OutXML::error( const std::string & problem_desc, const std::string & hint )
 {
   cout << "<message type=\"error\">" << xml::escape( problem_desc )
-       << "</message>" << endl;
+       << "</message>\n";
   //! \todo hint
 }
 
@@ -71,15 +70,15 @@ void OutXML::error( const Exception & e, const std::string & problem_desc, const
   std::ostringstream s;
 
   // problem
-  s << problem_desc << endl;
+  s << problem_desc << '\n';
   // cause
-  s << zyppExceptionReport( e ) << endl;
+  s << zyppExceptionReport( e ) << '\n';
   // hint
   if ( !hint.empty() )
-    s << hint << endl;
+    s << hint << '\n';
 
   cout << "<message type=\"error\">" << xml::escape(s.str())
-       << "</message>" << endl;
+       << "</message>\n";
 }
 
 void OutXML::writeProgressTag( const std::string & id, const std::string & label, int value, bool done, bool error )
@@ -93,7 +92,7 @@ void OutXML::writeProgressTag( const std::string & id, const std::string & label
   // missing value means 'is-alive' notification
   else if ( value >= 0 )
     cout << " value=\"" << value << "\"";
-  cout << "/>" << endl;
+  cout << "/>\n" << std::flush;	// progress is reported as it happens
 }
 
 void OutXML::progressStart( const std::string & id, const std::string & label, bool has_range )
@@ -127,7 +126,7 @@ void OutXML::dwnldProgressStart( const Url & uri )
     << " url=\"" << xml::escape(uri.asString()) << "\""
     << " percent=\"-1\""
     << " rate=\"-1\""
-    << "/>" << endl;
+    << "/>\n" << std::flush;
 }
 
 void OutXML::dwnldProgress( const Url & uri, int value, long rate )
@@ -136,7 +135,7 @@ void OutXML::dwnldProgress( const Url & uri, int value, long rate )
     << " url=\"" << xml::escape(uri.asString()) << "\""
     << " percent=\"" << value << "\""
     << " rate=\"" << rate << "\""
-    << "/>" << endl;
+    << "/>\n" << std::flush;
 }
 
 void OutXML::dwnldProgressEnd( const Url & uri, long rate, TriBool error )
@@ -145,76 +144,80 @@ void OutXML::dwnldProgressEnd( const Url & uri, long rate, TriBool error )
     << " url=\"" << xml::escape(uri.asString()) << "\""
     << " rate=\"" << rate << "\""
     << " done=\"" << bool(!error) << "\""
-    << "/>" << endl;
+    << "/>\n" << std::flush;
 }
 
 void OutXML::searchResult( const Table & table_r )
 {
-  cout << "<search-result version=\"0.0\">" << endl;
-  cout << "<solvable-list>" << endl;
+  searchResultBegin( table_r );
+  for ( const TableRow & row : table_r.rows() )
+    searchResultRow( row );
+  searchResultEnd();
+}
+
+void OutXML::searchResultBegin( const Table & table_r )
+{
+  cout << "<search-result version=\"0.0\">\n";
+  cout << "<solvable-list>\n";
 
-  const Table::container & rows( table_r.rows() );
-  if ( ! rows.empty() )
+  //
+  // *** CAUTION: It's a mess, but must match the header list defined
+  //              in FillSearchTableSolvable ctor (search.cc)
+  // We derive the XML tag from the header, applying some translation
+  // hence and there.
+  _searchResultTags.clear();
+  const TableHeader & theader( table_r.header() );
+  for_( it, theader.columnsNoTr().begin(), theader.columnsNoTr().end() )
   {
-    //
-    // *** CAUTION: It's a mess, but must match the header list defined
-    //              in FillSearchTableSolvable ctor (search.cc)
-    // We derive the XML tag from the header, applying some translation
-    // hence and there.
-    std::vector<std::string> header;
+    if ( *it == "S" )
+      _searchResultTags.push_back( "status" );
+    else if ( *it == "Type" )
+      _searchResultTags.push_back( "kind" );
+    else if ( *it == "Version" )
+      _searchResultTags.push_back( "edition" );
+    else
+      _searchResultTags.push_back( str::toLower( *it ) );
+  }
+}
+
+void OutXML::searchResultRow( TableRow row_r )
+{
+  cout << "<solvable";
+  const TableRow::container & cols( row_r.columns() );
+  unsigned cidx = 0;
+  for_( cit, cols.begin(), cols.end() )
+  {
+    cout << ' ' << (cidx < _searchResultTags.size() ? _searchResultTags[cidx] : "?" ) << "=\"";
+    if ( cidx == 0 )
     {
-      const TableHeader & theader( table_r.header() );
-      for_( it, theader.columnsNoTr().begin(), theader.columnsNoTr().end() )
-      {
-	if ( *it == "S" )
-	  header.push_back( "status" );
-	else if ( *it == "Type" )
-	  header.push_back( "kind" );
-	else if ( *it == "Version" )
-	  header.push_back( "edition" );
-	else
-	  header.push_back( str::toLower( *it ) );
-      }
+      if ( (*cit)[0] == 'i' || (*cit)[0] == 'I' )	// test 1st char as locked is "iL"/"IL"
+	cout << "installed\"";
+      else if ( (*cit)[0] == 'v' )	// test 1st char as locked is "vL"
+	cout << "other-version\"";
+      else
+	cout << "not-installed\"";
     }
-
-    for_( it, rows.begin(), rows.end() )
+    else
     {
-      cout << "<solvable";
-      const TableRow::container & cols( it->columns() );
-      unsigned cidx = 0;
-      for_( cit, cols.begin(), cols.end() )
-      {
-	cout << ' ' << (cidx < header.size() ? header[cidx] : "?" ) << "=\"";
-	if ( cidx == 0 )
-	{
-	  if ( (*cit)[0] == 'i' || (*cit)[0] == 'I' )	// test 1st char as locked is "iL"/"IL"
-	    cout << "installed\"";
-	  else if ( (*cit)[0] == 'v' )	// test 1st char as locked is "vL"
-	    cout << "other-version\"";
-	  else
-	    cout << "not-installed\"";
-	}
-	else
-	{
-	  cout << xml::escape(*cit) << '"';
-	}
-	++cidx;
-      }
-      cout << "/>" << endl;
+      cout << xml::escape(*cit) << '"';
     }
+    ++cidx;
   }
-    //Out::searchResult( table_r );
+  cout << "/>\n";
+}
 
-  cout << "</solvable-list>" << endl;
-  cout << "</search-result>" << endl;
+void OutXML::searchResultEnd()
+{
+  cout << "</solvable-list>\n";
+  cout << "</search-result>\n";
 }
 
 void OutXML::prompt( PromptId id, const std::string & prompt, const PromptOptions & poptions, const std::string & startdesc )
 {
-  cout << "<prompt id=\"" << id << "\">" << endl;
+  cout << "<prompt id=\"" << id << "\">\n";
   if ( !startdesc.empty() )
-    cout << "<description>" << xml::escape(startdesc) << "</description>" << endl;
-  cout << "<text>" << xml::escape(prompt) << "</text>" << endl;
+    cout << "<description>" << xml::escape(startdesc) << "</description>\n";
+  cout << "<text>" << xml::escape(prompt) << "</text>\n";
 
   unsigned i = 0;
   for ( PromptOptions::StrVector::const_iterator it = poptions.options().begin(); it != poptions.options().end(); ++it, ++i )
@@ -227,9 +230,9 @@ void OutXML::prompt( PromptId id, const std::string & prompt, const PromptOption
       cout << " default=\"1\"";
     cout << " value=\"" << xml::escape(option) << "\"";
     cout << " desc=\"" << xml::escape(poptions.optionHelp(i)) << "\"";
-    cout << "/>" << endl;
+    cout << "/>\n";
   }
-  cout << "</prompt>" << endl;
+  cout << "</prompt>\n" << std::flush;
 }
 
 void OutXML::promptHelp( const PromptOptions & poptions )
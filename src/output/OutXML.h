@@ -38,6 +38,9 @@ public:
                                 TriBool error = false);
 
   virtual void searchResult( const Table & table_r );
+  virtual void searchResultBegin( const Table & table_r );
+  virtual void searchResultRow( TableRow row_r );
+  virtual void searchResultEnd();
 
   virtual void prompt(PromptId id,
                       const std::string & prompt,
@@ -54,6 +57,8 @@ private:
   void writeProgressTag(const std::string & id,
                         const std::string & label,
                         int value, bool done, bool error = false);
+
+  std::vector<std::string> _searchResultTags;	//!< solvable attributes derived from the search result header
 };
 
 #endif /*OUTXML_H_*/
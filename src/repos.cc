@@ -5,22 +5,42 @@
                              |__/|_|  |_|
 \*---------------------------------------------------------------------------*/
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <limits.h>
+#include <string.h>
+
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <iterator>
 #include <list>
+#include <set>
+#include <unordered_map>
+#include <algorithm>
+
+#include <solv/solvversion.h>
 
+#include <zypp/APIConfig.h>
 #include <zypp/ZYpp.h>
 #include <zypp/base/Logger.h>
 #include <zypp/base/IOStream.h>
 #include <zypp/base/String.h>
 #include <zypp/base/Flags.h>
 
+#include <zypp/ZConfig.h>
 #include <zypp/RepoManager.h>
+#include <zypp/PathInfo.h>
+#include <zypp/TmpPath.h>
+#include <zypp/MediaSetAccess.h>
+#include <zypp/ExternalProgram.h>
 #include <zypp/repo/RepoException.h>
 #include <zypp/parser/ParseException.h>
 #include <zypp/media/MediaException.h>
 #include <zypp/target/rpm/RpmHeader.h>
+#include <zypp/ZYppCallbacks.h>
+#include <zypp/KeyRing.h>
+#include <zypp/Digest.h>
 
 #include "output/Out.h"
 #include "main.h"
@@ -28,7 +48,10 @@
 #include "Table.h"
 #include "utils/messages.h"
 #include "utils/misc.h"
+#include "utils/MirrorStats.h"
+#include "utils/Timings.h"
 #include "repos.h"
+#include "search-index.h"
 #include "global-settings.h"
 
 #include "commands/services/common.h"
@@ -195,6 +218,268 @@ void repoPrioSummary( Zypper & zypper )
   }
 }
 
+// ---------------------------------------------------------------------------
+namespace
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class DownloadedBytes
+  /// \brief Listen on media::DownloadProgressReport to sum up the size of the downloaded files.
+  ///
+  /// Like \ref Out::DownloadProgress all callbacks are forwarded to the
+  /// original receiver, so the download progress is still shown.
+  ///////////////////////////////////////////////////////////////////
+  struct DownloadedBytes : public callback::ReceiveReport<media::DownloadProgressReport>
+  {
+    DownloadedBytes()
+    : _oldReceiver( Distributor::instance().getReceiver() )
+    { connect(); }
+
+    ~DownloadedBytes()
+    {
+      if ( _oldReceiver )
+	Distributor::instance().setReceiver( *_oldReceiver );
+      else
+	Distributor::instance().noReceiver();
+    }
+
+    virtual void start( const Url & file, Pathname localfile )
+    {
+      _localfile = localfile;
+      if ( _oldReceiver )
+	_oldReceiver->start( file, localfile );
+    }
+
+    virtual bool progress( int value, const Url & file, double dbps_avg = -1, double dbps_current = -1 )
+    {
+      if ( _oldReceiver )
+	return _oldReceiver->progress( value, file, dbps_avg, dbps_current );
+      return true;
+    }
+
+    virtual Action problem( const Url & file, Error error, const std::string & description )
+    {
+      if ( _oldReceiver )
+	return _oldReceiver->problem( file, error, description );
+      return Receiver::problem( file, error, description );
+    }
+
+    virtual void finish( const Url & file, Error error, const std::string & reason )
+    {
+      if ( error == NO_ERROR && ! _localfile.empty() )
+	_bytes += PathInfo( _localfile ).size();
+      _localfile = Pathname();
+      if ( _oldReceiver )
+	_oldReceiver->finish( file, error, reason );
+    }
+
+    ByteCount bytes() const
+    { return _bytes; }
+
+  private:
+    Receiver * _oldReceiver;
+    Pathname _localfile;	///< the file being downloaded
+    ByteCount::SizeType _bytes = 0;
+  };
+
+  /** The mirror statistics kept in the zypp cache. */
+  MirrorStats & mirrorStats( Zypper & zypper )
+  {
+    static MirrorStats _stats( zypper.config().rm_options.repoCachePath / "mirror-stats" );
+    return _stats;
+  }
+
+  /** Milliseconds passed since \a start_r. */
+  inline unsigned msSince( std::chrono::steady_clock::time_point start_r )
+  { return std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now() - start_r ).count(); }
+
+  /** Whether the baseurls of \a repo are tried in order of their \ref MirrorStats. */
+  inline bool mayRankMirrors( Zypper & zypper, const RepoInfo & repo )
+  { return zypper.config().rank_mirrors && repo.baseUrlsSize() > 1 && repo.mirrorListUrl().asString().empty(); }
+
+  /** \a repo using \a urls_r as baseurls. */
+  RepoInfo withBaseUrls( const RepoInfo & repo, const std::vector<Url> & urls_r )
+  {
+    RepoInfo ret( repo );
+    ret.setBaseUrl( urls_r.front() );
+    for ( auto it = urls_r.begin() + 1; it != urls_r.end(); ++it )
+      ret.addBaseUrl( *it );
+    return ret;
+  }
+
+  /** \a repo with its baseurls ordered by their \ref MirrorStats (best first). */
+  RepoInfo rankedMirrors( Zypper & zypper, const RepoInfo & repo )
+  {
+    if ( ! mayRankMirrors( zypper, repo ) )
+      return repo;
+
+    std::vector<Url> urls( mirrorStats( zypper ).ranked( std::vector<Url>( repo.baseUrlsBegin(), repo.baseUrlsEnd() ) ) );
+    if ( urls == std::vector<Url>( repo.baseUrlsBegin(), repo.baseUrlsEnd() ) )
+      return repo;
+
+    DBG << "Ranked mirrors of " << repo.alias() << ": " << urls.front() << " first" << endl;
+    return withBaseUrls( repo, urls );
+  }
+
+  /** Whether checkIfToRefreshMetadata will report REPO_CHECK_DELAYED without contacting any url. */
+  bool refreshCheckIsDelayed( Zypper & zypper, const RepoInfo & repo, RepoManager::RefreshCheckPolicy policy_r )
+  {
+    if ( policy_r != RepoManager::RefreshIfNeeded )
+      return false;
+    RepoStatus status( zypper.repoManager().metadataStatus( repo ) );
+    return ! status.empty()
+      && Date::now() - status.timestamp() < Date::Duration( ZConfig::instance().repo_refresh_delay() * Date::minute );
+  }
+
+  /** In a mirror race worker: abort the download once the race is decided,
+   * so the media is released by the job rather than left behind.
+   */
+  struct AbortDownloadWhenTerminating : public callback::ReceiveReport<media::DownloadProgressReport>
+  {
+    virtual bool progress( int value, const Url & uri, double drate_avg, double drate_now )
+    { return ! WorkerPool::terminating(); }
+  };
+
+  /** The file a mirror of \a repo must provide, relative to the baseurl (empty if unknown).
+   * It is what the up-to-date check downloads, so fetching it measures the mirror.
+   */
+  Pathname mirrorProbeFile( const RepoInfo & repo )
+  {
+    switch ( repo.type().toEnum() )
+    {
+      case repo::RepoType::RPMMD_e:
+	return repo.path() / "repodata/repomd.xml";
+      case repo::RepoType::YAST2_e:
+	return repo.path() / "content";
+      default:
+	return Pathname();
+    }
+  }
+} // namespace
+
+bool race_mirrors( Zypper & zypper, RepoInfo & repo, RepoManager::RefreshCheckPolicy policy_r, RepoManager::RefreshCheckStatus & stat_r )
+{
+  // Without a cache (or with RefreshForced) checkIfToRefreshMetadata does not
+  // contact the url at all, so each mirror must prove itself by providing the file.
+  Pathname probeFile( mirrorProbeFile( repo ) );
+  if ( probeFile.empty() )
+    return false;
+
+  MirrorStats & stats( mirrorStats( zypper ) );
+  std::vector<Url> urls( repo.baseUrlsBegin(), repo.baseUrlsEnd() );
+
+  WorkerPool pool( urls.size() );
+  for ( const Url & url : urls )
+  {
+    pool.add( [&zypper,&repo,&url,&probeFile,policy_r]( std::string & data_r ) {
+      zypper.configNoConst().non_interactive = true;
+      callback::TempConnect<media::MediaChangeReport> noMediaChangeReport;
+      AbortDownloadWhenTerminating abortWhenTerminating;
+      abortWhenTerminating.connect();
+      {
+	MediaSetAccess access( url );
+	access.provideFile( probeFile );	// throws if the mirror can't provide it
+      }
+      data_r = str::numstring( zypper.repoManager().checkIfToRefreshMetadata( repo, url, policy_r ) );
+      return 0;
+    } );
+  }
+
+  std::vector<bool> answered( urls.size(), false );
+  int winner = -1;
+  unsigned winnerMs = 0;
+  auto start = std::chrono::steady_clock::now();
+  pool.run( [&]( unsigned idx_r, const WorkerPool::Result & result_r ) {
+    if ( winner >= 0 )
+      return;	// decided
+    answered[idx_r] = true;
+    if ( ! result_r.ok() )
+    {
+      WAR << urls[idx_r] << " doesn't look good (" << result_r.data << ")" << endl;
+      stats.recordFailure( urls[idx_r] );
+      return;
+    }
+    winner = idx_r;
+    winnerMs = msSince( start );
+    stat_r = RepoManager::RefreshCheckStatus( str::strtonum<int>( result_r.data ) );
+    stats.recordSuccess( urls[idx_r], winnerMs );
+    pool.cancel();
+  } );
+
+  if ( winner < 0 )
+    return false;
+
+  for ( unsigned i = 0; i < urls.size(); ++i )
+  {
+    if ( ! answered[i] )
+      stats.recordLowerBound( urls[i], winnerMs );
+  }
+  MIL << "Mirror race for " << repo.alias() << " won by " << urls[winner] << " (" << winnerMs << "ms)" << endl;
+
+  std::rotate( urls.begin(), urls.begin() + winner, urls.begin() + winner + 1 );
+  repo = withBaseUrls( repo, urls );
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** Check whether the raw metadata of \a repo need to be refreshed.
+   * The baseurls are tried in order until the first one can be checked.
+   * Pass \a repo as returned by \ref rankedMirrors. If \a probe_r, the
+   * \ref MirrorStats are updated and all baseurls are probed concurrently
+   * if the statistics are outdated. In this case the winner is moved to
+   * the front of \a repo's baseurls.
+   */
+  RepoManager::RefreshCheckStatus checkRankedMirrors( Zypper & zypper, RepoInfo & repo, RepoManager::RefreshCheckPolicy policy_r, bool probe_r )
+  {
+    RepoManager & manager( zypper.repoManager() );
+    MirrorStats & stats( mirrorStats( zypper ) );
+    bool record = probe_r && mayRankMirrors( zypper, repo );
+
+    if ( record
+      && stats.needsProbe( std::vector<Url>( repo.baseUrlsBegin(), repo.baseUrlsEnd() ) )
+      && ! refreshCheckIsDelayed( zypper, repo, policy_r ) )
+    {
+      RepoManager::RefreshCheckStatus stat = RepoManager::REFRESH_NEEDED;
+      bool won = race_mirrors( zypper, repo, policy_r, stat );
+      stats.save();
+      if ( won )
+	return stat;
+      // nobody answered: check serially to get the actual error
+    }
+
+    RepoManager::RefreshCheckStatus stat = RepoManager::REFRESH_NEEDED;
+    for ( RepoInfo::urls_const_iterator it = repo.baseUrlsBegin(); it != repo.baseUrlsEnd(); )
+    {
+      auto start = std::chrono::steady_clock::now();
+      try
+      {
+	stat = manager.checkIfToRefreshMetadata( repo, *it, policy_r );
+	if ( record && stat != RepoManager::REPO_CHECK_DELAYED )
+	  stats.recordSuccess( *it, msSince( start ) );
+	break; // don't check all the urls, just the first successful.
+      }
+      catch ( const Exception & e )
+      {
+	ZYPP_CAUGHT( e );
+	if ( record )
+	  stats.recordFailure( *it );
+	Url badurl( *it );
+	if ( ++it == repo.baseUrlsEnd() )
+	{
+	  if ( record )
+	    stats.save();
+	  ZYPP_RETHROW( e );
+	}
+	ERR << badurl << " doesn't look good. Trying another url (" << *it << ")." << endl;
+      }
+    }
+    if ( record )
+      stats.save();
+    return stat;
+  }
+} // namespace
+
 // ----------------------------------------------------------------------------
 
 bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_download )
@@ -218,6 +503,9 @@ bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_do
 
   try
   {
+    // baseurls in order of preference (see MirrorStats)
+    RepoInfo ranked( rankedMirrors( zypper, repo ) );
+
     if ( !force_download )
     {
       // check whether libzypp indicates a refresh is needed, and if so,
@@ -226,53 +514,40 @@ bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_do
 			 Out::HIGH );
       if ( !repo.baseUrlsEmpty() )
       {
+        Timings::Phase phase( "probe", repo.alias() );
 #ifndef DISABLE_ScopedDisableMediaChangeReport_GUARD
         Disabled because of fix for bsc#1123967
 	// Suppress (interactive) media::MediaChangeReport if we in have multiple basurls (>1)
 	media::ScopedDisableMediaChangeReport guard( repo.baseUrlsSize() > 1 );
 #endif
 
-        for ( RepoInfo::urls_const_iterator it = repo.baseUrlsBegin(); it != repo.baseUrlsEnd(); )
+        RepoManager::RefreshCheckStatus stat = checkRankedMirrors( zypper, ranked,
+              zypper.command() == ZypperCommand::REFRESH ||
+              zypper.command() == ZypperCommand::REFRESH_SERVICES ?
+                RepoManager::RefreshIfNeededIgnoreDelay :
+                RepoManager::RefreshIfNeeded,
+              true );
+
+        do_refresh = ( stat == RepoManager::REFRESH_NEEDED );
+        if ( !do_refresh
+          && ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES ) )
         {
-          try
-          {
-            RepoManager::RefreshCheckStatus stat = manager.checkIfToRefreshMetadata( repo, *it,
-                  zypper.command() == ZypperCommand::REFRESH ||
-                  zypper.command() == ZypperCommand::REFRESH_SERVICES ?
-                    RepoManager::RefreshIfNeededIgnoreDelay :
-                    RepoManager::RefreshIfNeeded );
-
-            do_refresh = ( stat == RepoManager::REFRESH_NEEDED );
-            if ( !do_refresh
-	      && ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES ) )
-            {
-              switch ( stat )
-              {
-              case RepoManager::REPO_UP_TO_DATE:
-	      {
-		TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
-		outstr.lhs << str::Format(_("Repository '%s' is up to date.")) % repo.asUserString();
-		//outstr.rhs << repoGpgCheckStatus( repo );
-		zypper.out().infoLine( outstr );
-	      }
-              break;
-              case RepoManager::REPO_CHECK_DELAYED:
-		zypper.out().info( str::Format(_("The up-to-date check of '%s' has been delayed.")) % repo.asUserString(),
-				   Out::HIGH );
-              break;
-              default:
-                WAR << "new item in enum, which is not covered" << endl;
-              }
-            }
-            break; // don't check all the urls, just the first successful.
-          }
-          catch ( const Exception & e )
+          switch ( stat )
           {
-            ZYPP_CAUGHT( e );
-            Url badurl( *it );
-            if ( ++it == repo.baseUrlsEnd() )
-              ZYPP_RETHROW( e );
-            ERR << badurl << " doesn't look good. Trying another url (" << *it << ")." << endl;
+          case RepoManager::REPO_UP_TO_DATE:
+	  {
+	    TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
+	    outstr.lhs << str::Format(_("Repository '%s' is up to date.")) % repo.asUserString();
+	    //outstr.rhs << repoGpgCheckStatus( repo );
+	    zypper.out().infoLine( outstr );
+	  }
+          break;
+          case RepoManager::REPO_CHECK_DELAYED:
+	    zypper.out().info( str::Format(_("The up-to-date check of '%s' has been delayed.")) % repo.asUserString(),
+			       Out::HIGH );
+          break;
+          default:
+            WAR << "new item in enum, which is not covered" << endl;
           }
         }
       }
@@ -285,13 +560,16 @@ bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_do
 
     if ( do_refresh )
     {
+      Timings::Phase phase( "download", repo.alias() );
       plabel = str::form(_("Retrieving repository '%s' metadata"), repo.asUserString().c_str() );
       zypper.out().progressStart( "raw-refresh", plabel, true );
 
       // RepoManager::RefreshForced because we already know from checkIfToRefreshMetadata above
       // that refresh is needed (or forced anyway). Forcing here prevents refreshMetadata from
       // doing it's own checkIfToRefreshMetadata. Otherwise we'd download the stats twice.
-      manager.refreshMetadata( repo, RepoManager::RefreshForced );
+      DownloadedBytes downloaded;
+      manager.refreshMetadata( ranked, RepoManager::RefreshForced );
+      phase.addBytes( downloaded.bytes() );
 
       //plabel += repoGpgCheckStatus( repo );
       zypper.out().progressEnd( "raw-refresh", plabel );
@@ -321,6 +599,7 @@ bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_do
 
         origRepo.setEnabled( false );
         manager.modifyRepository (repo.alias(), origRepo );
+        zypper.repoIndexChanged();
       }
       catch ( const Exception & ex )
       {
@@ -407,9 +686,30 @@ bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_do
 }
 
 // ---------------------------------------------------------------------------
+namespace
+{
+  /** Whether the refresh commands are running (vs. autorefresh). */
+  inline bool refreshCommandIsRunning( Zypper & zypper )
+  { return zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES; }
+
+  /** Build the search indexes of \a repo after its solv cache was built.
+   * Only the refresh commands do this; the autorefresh of other commands
+   * does not pay for it. \a loaded_r tells whether \a repo is already
+   * loaded into the pool.
+   */
+  void buildSearchIndexes( Zypper & zypper, const RepoInfo & repo, bool loaded_r )
+  {
+    if ( geteuid() != 0 || ! refreshCommandIsRunning( zypper ) )
+      return;
+    if ( ! loaded_r )
+      zypper.repoManager().loadFromCache( repo );
+    build_search_indexes( zypper, sat::Pool::instance().reposFind( repo.alias() ) );
+  }
+} // namespace
 
 bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build )
 {
+  Timings::Phase phase( "build cache", repo.alias() );
   if ( force_build )
     zypper.out().info(_("Forcing building of repository cache") );
 
@@ -418,6 +718,7 @@ bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build )
     RepoManager & manager = zypper.repoManager();
     manager.buildCache(repo, force_build ?
       RepoManager::BuildForced : RepoManager::BuildIfNeeded);
+    bool loaded = false;
 
     // Also load the solv file to check whether it was created with the right
     // version of satsolver-tools. If there's a version mismatch or some other
@@ -426,10 +727,12 @@ bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build )
     if ( !force_build
       // only do this if the refresh commands are running
       // this function is also used when loading repos for other commands
-      && ( zypper.command() == ZypperCommand::REFRESH || zypper.command() == ZypperCommand::REFRESH_SERVICES) )
+      && refreshCommandIsRunning( zypper ) )
     {
       manager.loadFromCache( repo );
+      loaded = true;
     }
+    buildSearchIndexes( zypper, repo, loaded );
   }
   catch ( const parser::ParseException & e )
   {
@@ -462,122 +765,334 @@ bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build )
 }
 
 // ---------------------------------------------------------------------------
-
-bool match_repo( Zypper & zypper, std::string str, RepoInfo *repo, bool looseQuery_r, bool looseAuth_r )
+namespace
 {
-  RepoManager & manager( zypper.repoManager() );
+  /** Payload tags passed back by a refresh worker. */
+  enum WorkerTag : char
+  {
+    TAG_NOCHECK		= '-',	///< raw metadata were not checked (--build-only)
+    TAG_FORCED		= 'f',	///< raw metadata download was forced
+    TAG_UPTODATE	= 'u',	///< raw metadata are up to date
+    TAG_DELAYED		= 'd',	///< up-to-date check was delayed
+    TAG_RETRIEVED	= 'r',	///< raw metadata were retrieved
+    TAG_FORCED_BUILD	= 'F',	///< solv cache build was forced
+    TAG_BUILT		= 'b',	///< solv cache was (re)built
+    TAG_BYTES		= '#',	///< followed by the number of bytes downloaded; always last
+  };
+
+  /** The bytes downloaded by a worker according to its \a data_r. */
+  ByteCount workerDownloadedBytes( const std::string & data_r )
+  {
+    std::string::size_type pos = data_r.find( TAG_BYTES );
+    if ( pos == std::string::npos )
+      return ByteCount();
+    return ByteCount( str::strtonum<ByteCount::SizeType>( data_r.substr( pos + 1 ) ) );
+  }
+
+  /** The job executed by a refresh worker.
+   * It's the silent counterpart of \ref refresh_raw_metadata and \ref build_cache.
+   * Any exception makes the job fail and the repo must be refreshed again in the parent.
+   */
+  int refreshInWorker( Zypper & zypper, const RepoInfo & repo, RefreshRepoCmd::RefreshFlags flags_r, std::string & data_r )
+  {
+    // No prompts and never import a key from within a worker. Unknown keys let the
+    // job fail, so the parent can ask the user.
+    zypper.configNoConst().non_interactive = true;
+    callback::TempConnect<KeyRingReport> noKeyRingReport;
+    callback::TempConnect<DigestReport> noDigestReport;
+    callback::TempConnect<media::MediaChangeReport> noMediaChangeReport;
+
+    RepoManager & manager( zypper.repoManager() );
+    // Statistics are not updated from within a worker, just use them.
+    RepoInfo ranked( rankedMirrors( zypper, repo ) );
+    DownloadedBytes downloaded;	// including the up-to-date checks
+
+    if ( flags_r.testFlag( RefreshRepoCmd::BuildOnly ) )
+      data_r += TAG_NOCHECK;
+    else if ( flags_r.testFlag( RefreshRepoCmd::Force ) || flags_r.testFlag( RefreshRepoCmd::ForceDownload ) )
+    {
+      manager.refreshMetadata( ranked, RepoManager::RefreshForced );
+      data_r += TAG_FORCED;
+    }
+    else
+    {
+      RepoManager::RefreshCheckStatus stat = checkRankedMirrors( zypper, ranked, refreshCommandIsRunning( zypper ) ?
+								 RepoManager::RefreshIfNeededIgnoreDelay :
+								 RepoManager::RefreshIfNeeded,
+								 false );
+      switch ( stat )
+      {
+	case RepoManager::REFRESH_NEEDED:
+	  manager.refreshMetadata( ranked, RepoManager::RefreshForced );
+	  data_r += TAG_RETRIEVED;
+	  break;
+	case RepoManager::REPO_CHECK_DELAYED:
+	  data_r += TAG_DELAYED;
+	  break;
+	default:
+	  data_r += TAG_UPTODATE;
+	  break;
+      }
+    }
 
-  if ( ! zypper.runtimeData().temporary_repos.empty() )
-  {
-    // Quick check for temporary_repos (alias only)
-    for ( auto && ri : zypper.runtimeData().temporary_repos )
+    if ( ! flags_r.testFlag( RefreshRepoCmd::DownloadOnly ) )
     {
-      if ( ri.alias() == str )
+      bool force_build = flags_r.testFlag( RefreshRepoCmd::Force ) || flags_r.testFlag( RefreshRepoCmd::ForceBuild );
+      if ( force_build )
+	data_r += TAG_FORCED_BUILD;
+      RepoStatus before( manager.cacheStatus( repo ) );
+      manager.buildCache( repo, force_build ? RepoManager::BuildForced : RepoManager::BuildIfNeeded );
+      // see build_cache: make sure the solv file is actually usable (bnc #456718)
+      bool loaded = false;
+      if ( ! force_build && refreshCommandIsRunning( zypper ) )
       {
-	if ( repo )
-	  *repo = ri;
-	return true;
+	manager.loadFromCache( repo );
+	loaded = true;
       }
+      buildSearchIndexes( zypper, repo, loaded );
+      if ( force_build || manager.cacheStatus( repo ) != before )
+	data_r += TAG_BUILT;
+    }
+    data_r += TAG_BYTES;
+    data_r += str::numstring( ByteCount::SizeType( downloaded.bytes() ) );
+    return 0;
+  }
+} // namespace
+
+bool worker_may_refresh( const RepoInfo & repo )
+{ return !( repo.url().schemeIsVolatile() || repo.type() == repo::RepoType::NONE ); }
+
+std::vector<WorkerPool::Result> refresh_repos_in_workers( Zypper & zypper, const std::vector<RepoRefreshRequest> & requests_r, unsigned jobs_r )
+{
+  MIL << "Refreshing " << requests_r.size() << " repos in up to " << jobs_r << " workers" << endl;
+  Timings::Phase phase( "refresh workers", str::numstring( requests_r.size() ) + " repos" );
+  WorkerPool pool( jobs_r );
+  for ( const RepoRefreshRequest & req : requests_r )
+  {
+    pool.add( [&zypper,&req]( std::string & data_r ) {
+      return refreshInWorker( zypper, req.first, req.second, data_r );
+    } );
+  }
+
+  std::vector<WorkerPool::Result> results( pool.run() );
+  for ( unsigned i = 0; i < requests_r.size(); ++i )
+  {
+    const RepoInfo & repo( requests_r[i].first );
+    if ( results[i].ok() )
+    {
+      MIL << "Worker refreshed repo '" << repo.alias() << "': " << results[i].data << endl;
+      phase.addBytes( workerDownloadedBytes( results[i].data ) );
     }
+    else
+      WAR << "Worker failed to refresh repo '" << repo.alias() << "' (" << results[i].status << "): " << results[i].data << endl;
   }
+  return results;
+}
+
+std::vector<WorkerPool::Result> refresh_repos_in_workers( Zypper & zypper, const std::vector<RepoInfo> & repos, RefreshRepoCmd::RefreshFlags flags_r, unsigned jobs_r )
+{
+  std::vector<RepoRefreshRequest> requests;
+  for ( const RepoInfo & repo : repos )
+    requests.push_back( RepoRefreshRequest( repo, flags_r ) );
+  return refresh_repos_in_workers( zypper, requests, jobs_r );
+}
+
+void report_worker_refresh( Zypper & zypper, const RepoInfo & repo, const std::string & data_r )
+{
+  std::string tags( data_r.substr( 0, data_r.find( TAG_BYTES ) ) );
+  if ( tags.find_first_of( std::string{ TAG_UPTODATE, TAG_DELAYED, TAG_RETRIEVED } ) != std::string::npos )
+    zypper.out().info( str::Format(_("Checking whether to refresh metadata for %s")) % repo.asUserString(),
+		       Out::HIGH );
 
-  // Quick check for alias/reponumber/name first.
-  // Name can be ambiguous, in which case the first match found will be returned
+  for ( char tag : tags )
   {
-    unsigned number = 1; // repo number
-    unsigned tmp    = 0;
-    safe_lexical_cast( str, tmp ); // try to make an int out of the string
-    for ( RepoManager::RepoConstIterator known_it = manager.repoBegin(); known_it != manager.repoEnd(); ++known_it, ++number )
+    switch ( tag )
     {
-      if ( known_it->alias() == str || tmp == number || known_it->name() == str )
+      case TAG_UPTODATE:
+	if ( refreshCommandIsRunning( zypper ) )
+	{
+	  TermLine outstr( TermLine::SF_SPLIT | TermLine::SF_EXPAND );
+	  outstr.lhs << str::Format(_("Repository '%s' is up to date.")) % repo.asUserString();
+	  zypper.out().infoLine( outstr );
+	}
+	break;
+
+      case TAG_DELAYED:
+	if ( refreshCommandIsRunning( zypper ) )
+	  zypper.out().info( str::Format(_("The up-to-date check of '%s' has been delayed.")) % repo.asUserString(),
+			     Out::HIGH );
+	break;
+
+      case TAG_FORCED:
+	zypper.out().info(_("Forcing raw metadata refresh"));
+	// fall through
+      case TAG_RETRIEVED:
       {
-        if ( repo )
-          *repo = *known_it;
-        return true;
+	std::string plabel( str::form(_("Retrieving repository '%s' metadata"), repo.asUserString().c_str() ) );
+	zypper.out().progressStart( "raw-refresh", plabel, true );
+	zypper.out().progressEnd( "raw-refresh", plabel );
       }
+      break;
+
+      case TAG_FORCED_BUILD:
+	zypper.out().info(_("Forcing building of repository cache") );
+	break;
+
+      case TAG_BUILT:
+      {
+	std::string plabel( str::form(_("Building repository '%s' cache"), repo.asUserString().c_str() ) );
+	zypper.out().progressStart( "build-cache", plabel, true );
+	zypper.out().progressEnd( "build-cache", plabel );
+      }
+      break;
+
+      case TAG_NOCHECK:
+      default:
+	break;
     }
   }
+}
 
-  // expensive URL analysis only if the above did not find anything.
-  // URL can be ambiguous, in which case the first found match will be returned.
-  bool found = false;
-  try
-  {
-    Url strurl( str );	// no need to continue if str is no Url.
+// ---------------------------------------------------------------------------
+namespace
+{
+  ///////////////////////////////////////////////////////////////////
+  /// \class ContentKeywordIndex
+  /// \brief Persistent repo alias -> content keywords index.
+  ///
+  /// Each entry remembers the checksum of the raw metadata status the
+  /// keywords were read from. If it changed (the repo was refreshed),
+  /// the keywords are read again. Stored one repo per line:
+  /// <tt>alias TAB checksum TAB keyword,...</tt>
+  ///////////////////////////////////////////////////////////////////
+  class ContentKeywordIndex
+  {
+  public:
+    explicit ContentKeywordIndex( Pathname file_r )
+    : _file( std::move(file_r) )
+    {
+      std::ifstream in( _file.c_str() );
+      std::string line;
+      while ( std::getline( in, line ) )
+      {
+	std::vector<std::string> fields;
+	str::splitFields( line, std::back_inserter(fields), "\t" );
+	if ( fields.size() != 3 || fields[0].empty() )
+	  continue;
+	Entry & entry( _entries[fields[0]] );
+	entry.cookie = fields[1];
+	str::split( fields[2], std::inserter( entry.keywords, entry.keywords.end() ), "," );
+      }
+      DBG << "Read " << _entries.size() << " content keyword entries from " << _file << endl;
+    }
 
-    for ( RepoManager::RepoConstIterator known_it = manager.repoBegin(); known_it != manager.repoEnd(); ++known_it )
+    /** The content keywords of \a repo or \c nullptr if it has no cached metadata. */
+    const std::set<std::string> * keywords( RepoManager & manager_r, const RepoInfo & repo_r )
     {
-      try
+      RepoStatus status( manager_r.metadataStatus( repo_r ) );
+      if ( status.empty() )
+	return nullptr;
+
+      Entry & entry( _entries[repo_r.alias()] );
+      if ( entry.cookie != status.checksum() )
       {
-	// first strip any trailing slash from the path in URLs before comparing
-	// (bnc #585082)
-	// we can afford this because we expect that the repo urls are directories
-	// and it is common practice in servers and operating systems to accept
-	// directory paths both with and without trailing slashes.
-	Url uurl( strurl );
-	uurl.setPathName( Pathname(uurl.getPathName()).asString() );
-
-	url::ViewOption urlview =
-	url::ViewOption::DEFAULTS + url::ViewOption::WITH_PASSWORD;
-	if ( looseAuth_r ) // ( zypper.cOpts().count("loose-auth") )
-	{
-	  urlview = urlview
-	  - url::ViewOptions::WITH_PASSWORD
-	  - url::ViewOptions::WITH_USERNAME;
-	}
-	if ( looseQuery_r ) // ( zypper.cOpts().count("loose-query") )
-	  urlview = urlview - url::ViewOptions::WITH_QUERY_STR;
+	// RepoInfo remembers the keywords once read. Use a fresh one, as
+	// repo_r may have been asked before the metadata were refreshed.
+	RepoInfo fresh;
+	fresh.setAlias( repo_r.alias() );
+	fresh.setMetadataPath( repo_r.metadataPath().empty() ? manager_r.metadataPath( repo_r ) : repo_r.metadataPath() );
+
+	entry.cookie = status.checksum();
+	entry.keywords.clear();
+	for ( const std::string & keyword : fresh.contentKeywords() )
+	  entry.keywords.insert( keyword );
+	DBG << "Content keywords of " << repo_r.alias() << ": " << entry.keywords.size() << endl;
+	save();
+      }
+      return &entry.keywords;
+    }
 
-	// need to do asString(withurlview) comparison here because the user-given
-	// string is expected to have no credentials or query
-	if ( !( urlview.has( url::ViewOptions::WITH_PASSWORD ) && urlview.has( url::ViewOptions::WITH_QUERY_STR ) ) )
-	{
-	  if ( !known_it->baseUrlsEmpty() )
-	  {
-	    for_( urlit, known_it->baseUrlsBegin(), known_it->baseUrlsEnd() )
-	    {
-	      Url newrl( *urlit );
-	      newrl.setPathName( Pathname(newrl.getPathName()).asString() );
-	      if ( newrl.asString(urlview) == uurl.asString(urlview) )
-	      {
-		found = true;
-		break;
-	      }
-	    }
-	  }
-	}
-	// ordinary == comparison suffices here (quicker)
-	else
-	{
-	  if ( !known_it->baseUrlsEmpty() )
-	  {
-	    for_( urlit, known_it->baseUrlsBegin(), known_it->baseUrlsEnd() )
-	    {
-	      Url newrl( *urlit );
-	      newrl.setPathName( Pathname(newrl.getPathName()).asString() );
-	      if ( newrl == uurl )
-	      {
-		found = true;
-		break;
-	      }
-	    }
-	  }
-	}
+  private:
+    void save()
+    {
+      if ( geteuid() != 0 )
+	return;	// the zypp cache belongs to root
 
-	if ( found )
+      Pathname tmp( _file.extend( ".new" ) );
+      {
+	std::ofstream out( tmp.c_str() );
+	for ( const auto & el : _entries )
+	  out << el.first << "\t" << el.second.cookie << "\t" << str::join( el.second.keywords, "," ) << endl;
+	if ( ! out )
 	{
-	  if ( repo )
-	    *repo = *known_it;
-	  break;
+	  WAR << "Can't write content keyword index " << tmp << endl;
+	  filesystem::unlink( tmp );
+	  return;
 	}
       }
-      catch ( const url::UrlException & ) {}
+      if ( filesystem::rename( tmp, _file ) != 0 )
+	filesystem::unlink( tmp );
+    }
+
+    struct Entry
+    {
+      std::string cookie;		///< raw metadata status checksum
+      std::set<std::string> keywords;
+    };
+    Pathname _file;
+    std::map<std::string,Entry> _entries;
+  };
+
+  ContentKeywordIndex & contentKeywordIndex( Zypper & zypper )
+  {
+    static ContentKeywordIndex _index( zypper.config().rm_options.repoCachePath / "content-keywords" );
+    return _index;
+  }
+
+  /** Whether \a repo provides any of \a keywords_r; \a unknown_r if nothing is cached. */
+  bool repoProvidesContent( Zypper & zypper, const RepoInfo & repo, const std::set<std::string> & keywords_r, bool unknown_r )
+  {
+    const std::set<std::string> * keywords = contentKeywordIndex( zypper ).keywords( zypper.repoManager(), repo );
+    if ( ! keywords )
+      return unknown_r;
+    for ( const std::string & keyword : keywords_r )
+    {
+      if ( keywords->count( keyword ) )
+	return true;
+    }
+    return false;
+  }
+} // namespace
+
+bool repo_may_provide_content( Zypper & zypper, const RepoInfo & repo, const std::set<std::string> & keywords_r )
+{ return repoProvidesContent( zypper, repo, keywords_r, true ); }
 
-    } // END for all known repos
+bool repo_provides_content( Zypper & zypper, const RepoInfo & repo, const std::set<std::string> & keywords_r )
+{ return repoProvidesContent( zypper, repo, keywords_r, false ); }
+
+// ---------------------------------------------------------------------------
+
+bool match_repo( Zypper & zypper, std::string str, RepoInfo *repo, bool looseQuery_r, bool looseAuth_r )
+{
+  if ( ! zypper.runtimeData().temporary_repos.empty() )
+  {
+    // Quick check for temporary_repos (alias only)
+    for ( auto && ri : zypper.runtimeData().temporary_repos )
+    {
+      if ( ri.alias() == str )
+      {
+	if ( repo )
+	  *repo = ri;
+	return true;
+      }
+    }
   }
-  catch ( const url::UrlException & ) {}
 
-  return found;
+  // alias/reponumber/name first, then URL (see RepoIndex)
+  const RepoInfo * found = zypper.repoIndex().find( str, looseQuery_r, looseAuth_r );
+  if ( found && repo )
+    *repo = *found;
+  return found != nullptr;
 }
 
 // ---------------------------------------------------------------------------
@@ -626,6 +1141,11 @@ bool repo_cmp_alias_urls(const RepoInfo &lhs, const RepoInfo &rhs)
 template<typename T>
 void get_repos( Zypper & zypper, const T & begin, const T & end, std::list<RepoInfo> & repos, std::list<std::string> & not_found )
 {
+  // repos by alias; only repos with equal alias can be duplicates
+  std::unordered_multimap<std::string,const RepoInfo *> found;
+  for ( const RepoInfo & repo : repos )
+    found.insert( std::make_pair( repo.alias(), &repo ) );
+
   for ( T it = begin; it != end; ++it )
   {
     RepoInfo repo;
@@ -639,18 +1159,13 @@ void get_repos( Zypper & zypper, const T & begin, const T & end, std::list<RepoI
     // repo found
     // is it a duplicate? compare by alias and URIs
     //! \todo operator== in RepoInfo?
-    bool duplicate = false;
-    for_( repo_it, repos.begin(), repos.end() )
+    auto range = found.equal_range( repo.alias() );
+    if ( std::none_of( range.first, range.second, [&repo]( const std::pair<const std::string,const RepoInfo *> & el ) {
+			 return repo_cmp_alias_urls( repo, *el.second ); } ) )
     {
-      if ( repo_cmp_alias_urls( repo, *repo_it ) )
-      {
-        duplicate = true;
-        break;
-      }
-    } // END for all found so far
-
-    if ( !duplicate )
       repos.push_back( repo );
+      found.insert( std::make_pair( repo.alias(), &repos.back() ) );
+    }
   }
 }
 
@@ -722,15 +1237,15 @@ void do_init_repos( Zypper & zypper, const Container & container )
   {
     MIL << "Refreshing autorefresh services." << endl;
 
-    const std::list<ServiceInfo> & services( zypper.repoManager().knownServices() );
-    for_( s, services.begin(), services.end() )
+    std::vector<ServiceInfo> services;
+    for ( const ServiceInfo & service : zypper.repoManager().knownServices() )
     {
-      if ( s->enabled() && s->autorefresh() )
-      {
-        //@TODO MICHAEL is this correct?
-        refresh_service( zypper, *s );
-      }
+      if ( service.enabled() && service.autorefresh() )
+        services.push_back( service );
     }
+    // unchanged RIS indexes need not be applied again
+    Timings::Phase phase( "refresh services" );
+    refresh_services( zypper, services, RepoManager::RefreshServiceFlags(), true );
   }
 
   MIL << "Going to initialize repositories." << endl;
@@ -814,21 +1329,30 @@ void do_init_repos( Zypper & zypper, const Container & container )
       ++it;
   }
 
-  unsigned skip_count = 0;
+  // Stage 1: --plus-content may temporarily enable disabled repos.
+  // The message is printed in stage 3, next to the repo's refresh output.
+  struct RepoToInit
+  {
+    std::list<RepoInfo>::iterator it;	///< the repo in gData
+    RepoInfo repo;			///< play with a copy, persistent changes need to be made in gData!
+    bool postContentcheck;		///< disabled repos may get temp. enabled to check for --plus-content
+    std::string plusContentInfo;	///< --plus-content message to print before refreshing
+    WorkerPool::Result prefetched;	///< refresh already done by a worker
+  };
+  std::vector<RepoToInit> toInit;
   for ( std::list<RepoInfo>::iterator it = gData.repos.begin(); it !=  gData.repos.end(); ++it )
   {
-    RepoInfo repo( *it );	// play with a copy, persistent changes need to be made in gData!
-    MIL << "checking if to refresh " << repo.alias() << endl;
+    toInit.push_back( RepoToInit{ it, *it, false, std::string(), WorkerPool::Result() } );
+    RepoInfo & repo( toInit.back().repo );
+    bool & postContentcheck( toInit.back().postContentcheck );
+    std::string & plusContentInfo( toInit.back().plusContentInfo );
 
-    // disabled repos may get temp. enabled to check for --plus-content
-    bool postContentcheck = false;
     if ( ! repo.enabled() )
     {
       if ( plusContent.count( repo ) )
       {
 	MIL << "[--plus-content] check says use " << repo.alias() << endl;
-	zypper.out().info( str::Format(_("Temporarily enabling repository '%s'.")) % repo.asUserString(),
-			   " [--plus-content]" );
+	plusContentInfo = str::Format(_("Temporarily enabling repository '%s'.")) % repo.asUserString();
 	repo.setEnabled( true );	// found by its alias: no postContentcheck needed
 	it->setEnabled( true );		// in gData!
       }
@@ -836,26 +1360,102 @@ void do_init_repos( Zypper & zypper, const Container & container )
       {
 	// Preliminarily enable if last content matches or no content info available.
 	// Final check is done after refresh.
-	if ( repo.hasContentAny( gData.plusContentRepos ) || !repo.hasContent() )
+	if ( repo_may_provide_content( zypper, repo, gData.plusContentRepos ) )
 	{
 	  postContentcheck = true;	// preliminary enable it
 	  repo.setEnabled( true );
 	  MIL << "[--plus-content] check " << repo.alias() << endl;
-	  zypper.out().info( str::Format(_("Scanning content of disabled repository '%s'.")) % repo.asUserString(),
-			     " [--plus-content]" );
+	  plusContentInfo = str::Format(_("Scanning content of disabled repository '%s'.")) % repo.asUserString();
 	}
       }
     }
+  }
+
+  // Stage 2 (root only): If main.refreshJobs allows, let workers concurrently probe,
+  // download and build the caches. While one worker waits for a mirror, another one
+  // builds a solv file. Failed repos take the serial path below.
+  if ( geteuid() == 0 && zypper.config().refresh_jobs > 1 )
+  {
+    std::vector<RepoRefreshRequest> batch;
+    std::vector<RepoToInit *> batchOwner;
+    for ( RepoToInit & el : toInit )
+    {
+      if ( ! ( el.repo.enabled() && worker_may_refresh( el.repo ) ) )
+	continue;
+      bool do_refresh = el.repo.autorefresh() && !zypper.config().no_refresh;
+      if ( el.postContentcheck )
+      {
+	// scanned repos are built only if they provide the content
+	if ( do_refresh )
+	  batch.push_back( RepoRefreshRequest( el.repo, RefreshRepoCmd::DownloadOnly ) );
+	else
+	  continue;
+      }
+      else
+	batch.push_back( RepoRefreshRequest( el.repo, do_refresh ? RefreshRepoCmd::Default : RefreshRepoCmd::BuildOnly ) );
+      batchOwner.push_back( &el );
+    }
+    if ( batch.size() > 1 )
+    {
+      std::vector<WorkerPool::Result> results( refresh_repos_in_workers( zypper, batch, zypper.config().refresh_jobs ) );
+      for ( unsigned i = 0; i < results.size(); ++i )
+	batchOwner[i]->prefetched = std::move( results[i] );
+    }
+  }
+
+  // Stage 3: report in order, refresh and build whatever is left.
+  unsigned skip_count = 0;
+  for ( RepoToInit & el : toInit )
+  {
+    std::list<RepoInfo>::iterator it( el.it );
+    const RepoInfo & repo( el.repo );
+    bool postContentcheck = el.postContentcheck;
+    MIL << "checking if to refresh " << repo.alias() << endl;
+    Timings::Phase phase( "repo", repo.alias() );
+    if ( ! el.plusContentInfo.empty() )
+      zypper.out().info( el.plusContentInfo, " [--plus-content]" );
+
+    // build the cache or disable the repo
+    auto buildCacheOrSkip = [&]() -> bool
+    {
+      if ( ! build_cache( zypper, repo, false ) )
+	return true;
+
+      // If an error is returned, it means zypp attempted to build the metadata
+      // cache for the repo and failed.  For non-root probably because writing
+      // is not allowed. Display a refresh hint then.
+      if ( geteuid() != 0 )
+      {
+	MIL <<  "We're running as non-root, skipping building of " << repo.alias() + "cache" << endl;
+	zypper.out().warning(
+	  str::Format(_( "The metadata cache needs to be built for the '%s' repository. You can run 'zypper refresh' as root to do this."))
+	  % repo.asUserString(), Out::QUIET );
+      }
+
+      WAR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
+      zypper.out().warning( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString(),
+			    Out::QUIET );
+
+      it->setEnabled( false );
+      postContentcheck = false;
+      ++skip_count;
+      return false;
+    };
 
     bool do_refresh = repo.enabled() && repo.autorefresh() && !zypper.config().no_refresh;
-    if ( do_refresh )
+    if ( repo.enabled() && el.prefetched.ok() )
+    {
+      report_worker_refresh( zypper, repo, el.prefetched.data );
+    }
+    else if ( do_refresh )
     {
       MIL << "calling refresh for " << repo.alias() << endl;
 
       // handle root user differently
       if ( geteuid() == 0 )
       {
-        if ( refresh_raw_metadata( zypper, repo, false ) || build_cache( zypper, repo, false ) )
+        // scanned repos are built only if they provide the content
+        if ( refresh_raw_metadata( zypper, repo, false ) || ( !postContentcheck && build_cache( zypper, repo, false ) ) )
         {
 	  WAR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
           zypper.out().warning( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString(),
@@ -885,34 +1485,14 @@ void do_init_repos( Zypper & zypper, const Container & container )
     }
     // even if refresh is not required, try to build the cache
     // for the case of non-existing cache
-    else if ( repo.enabled() )
+    else if ( repo.enabled() && !postContentcheck )
     {
-      if ( build_cache( zypper, repo, false ) )
-      {
-	// If an error is returned, it means zypp attempted to build the metadata
-	// cache for the repo and failed.  For non-root probably because writing
-	// is not allowed. Display a refresh hint then.
-	if ( geteuid() != 0 )
-	{
-	  MIL <<  "We're running as non-root, skipping building of " << repo.alias() + "cache" << endl;
-	  zypper.out().warning(
-	    str::Format(_( "The metadata cache needs to be built for the '%s' repository. You can run 'zypper refresh' as root to do this."))
-	    % repo.asUserString(), Out::QUIET );
-	}
-
-	WAR << "Skipping repository '" << repo.alias() << "' because of the above error." << endl;
-	zypper.out().warning( str::Format(_("Skipping repository '%s' because of the above error.")) % repo.asUserString(),
-			      Out::QUIET );
-
-	it->setEnabled( false );
-	postContentcheck = false;
-	++skip_count;
-      }
+      buildCacheOrSkip();
     }
 
     if ( postContentcheck )
     {
-      if ( repo.hasContentAny( gData.plusContentRepos ) )
+      if ( repo_provides_content( zypper, repo, gData.plusContentRepos ) && buildCacheOrSkip() )
       {
 	MIL << "[--plus-content] check says use " << repo.alias() << endl;
 	zypper.out().info( str::Format(_("Temporarily enabling repository '%s'.")) % repo.asUserString(),
@@ -1151,6 +1731,419 @@ void clean_repos(Zypper & zypper , std::vector<std::string> specificRepos, Clean
     zypper.out().info(_("All repositories have been cleaned up.") );
 }
 
+// ----------------------------------------------------------------------------
+namespace
+{
+  /** First line of a cache bundle's manifest. */
+  const std::string cacheBundleMagic( "# zypper repo cache bundle 2" );
+  /** First line of a bundle without solv caches (still accepted). */
+  const std::string cacheBundleMagicRawOnly( "# zypper repo cache bundle 1" );
+  /** Name of the manifest within a cache bundle. */
+  const std::string cacheBundleManifest( "MANIFEST" );
+  /** The files of a solv cache in a bundle (the cookie holds the raw metadata status it was built from). */
+  const std::vector<std::string> cacheBundleSolvFiles { "solv", "cookie" };
+
+  /** The versions the bundled solv caches were written with; they are used only if they match. */
+  inline std::string cacheBundleTools()
+  { return "libzypp-" LIBZYPP_VERSION_STRING " libsolv-" LIBSOLV_VERSION_STRING; }
+
+  /** The repo caches in a bundle (relative to the bundle root). */
+  inline Pathname bundleRawPath( const RepoInfo & repo )
+  { return Pathname("raw") / repo.escaped_alias(); }
+  inline Pathname bundleSolvPath( const RepoInfo & repo )
+  { return Pathname("solv") / repo.escaped_alias(); }
+
+  /** The repo caches on the system. */
+  inline Pathname systemRawPath( Zypper & zypper, const RepoInfo & repo )
+  { return zypper.config().rm_options.repoRawCachePath / repo.escaped_alias(); }
+  inline Pathname systemSolvPath( Zypper & zypper, const RepoInfo & repo )
+  { return zypper.config().rm_options.repoSolvCachePath / repo.escaped_alias(); }
+
+  /** Collect all regular files below \a root_r / \a dir_r (relative to \a root_r).
+   * Returns false if there is anything else than directories and regular files (e.g. symlinks).
+   */
+  bool collectFiles( const Pathname & root_r, const Pathname & dir_r, std::list<Pathname> & files_r )
+  {
+    std::list<std::string> entries;
+    filesystem::readdir( entries, root_r / dir_r, /*dots*/false );
+    bool ret = true;
+    for ( const std::string & entry : entries )
+    {
+      PathInfo pi( root_r / dir_r / entry, PathInfo::LSTAT );
+      if ( pi.isDir() )
+      {
+	if ( ! collectFiles( root_r, dir_r / entry, files_r ) )
+	  ret = false;
+      }
+      else if ( pi.isFile() )
+	files_r.push_back( dir_r / entry );
+      else
+      {
+	WAR << "Not a regular file: " << pi << endl;
+	ret = false;
+      }
+    }
+    return ret;
+  }
+
+  /** Whether the manifest entry \a path_r is a plain relative path below \a dir_r. */
+  bool isBelow( const std::string & path_r, const Pathname & dir_r )
+  {
+    std::vector<std::string> words;
+    str::split( path_r, std::back_inserter(words), "/" );
+    for ( const std::string & word : words )
+      if ( word == "." || word == ".." )
+	return false;
+    return ! path_r.empty() && path_r[0] != '/' && str::startsWith( path_r, dir_r.asString() + "/" );
+  }
+
+  /** Absolute version of a command line \a path_r. */
+  Pathname absolutePath( const Pathname & path_r )
+  {
+    if ( path_r.absolute() )
+      return path_r;
+    char buf[PATH_MAX];
+    return ::getcwd( buf, sizeof(buf) ) ? Pathname( buf ) / path_r : path_r;
+  }
+
+  /** Run \a argv_r, logging its output. Returns the exit status. */
+  int runTar( const std::vector<std::string> & argv_r )
+  {
+    ExternalProgram prog( argv_r, ExternalProgram::Stderr_To_Stdout );
+    for ( std::string line = prog.receiveLine(); ! line.empty(); line = prog.receiveLine() )
+      WAR << "tar: " << line;
+    return prog.close();
+  }
+
+  /** A repo described in a cache bundle manifest. */
+  struct BundledRepo
+  {
+    std::string alias;
+    std::string url;
+    std::string checksum;	///< raw metadata status checksum
+    Date timestamp;		///< raw metadata status timestamp
+    std::string solvChecksum;	///< raw metadata status checksum the bundled solv cache was built from (if bundled)
+
+    /** Its caches in the bundle. */
+    Pathname rawPath() const
+    { RepoInfo repo; repo.setAlias( alias ); return bundleRawPath( repo ); }
+    Pathname solvPath() const
+    { RepoInfo repo; repo.setAlias( alias ); return bundleSolvPath( repo ); }
+  };
+
+  /** Install the bundled solv cache of \a repo from \a staging_r.
+   * Each file is copied next to its destination and renamed into place,
+   * the cookie last, so an interrupted import just leaves an outdated cache.
+   */
+  bool installBundledSolv( Zypper & zypper, const RepoInfo & repo, const Pathname & staging_r )
+  {
+    Pathname dir( systemSolvPath( zypper, repo ) );
+    if ( filesystem::assert_dir( dir ) != 0 )
+      return false;
+    filesystem::unlink( dir / "cookie" );
+    for ( const std::string & name : cacheBundleSolvFiles )
+    {
+      Pathname tmp( dir / ( name + ".new" ) );
+      if ( filesystem::copy( staging_r / bundleSolvPath( repo ) / name, tmp ) != 0
+	|| filesystem::rename( tmp, dir / name ) != 0 )
+      {
+	filesystem::unlink( tmp );
+	return false;
+      }
+    }
+    filesystem::unlink( dir / "solv.idx" );	// stale; libzypp recreates it
+    return true;
+  }
+} // namespace
+
+int export_repo_cache( Zypper & zypper, const std::list<RepoInfo> & repos, const Pathname & file_r )
+{
+  RepoManager & manager( zypper.repoManager() );
+  filesystem::TmpDir staging( filesystem::TmpDir::defaultLocation(), "zypper-cache-bundle" );
+
+  std::ofstream manifest( (staging.path() / cacheBundleManifest).c_str() );
+  manifest << cacheBundleMagic << endl;
+  manifest << "tools\t" << cacheBundleTools() << endl;
+
+  unsigned exported = 0;
+  for ( const RepoInfo & repo : repos )
+  {
+    RepoStatus rawStatus( manager.metadataStatus( repo ) );
+    if ( rawStatus.empty() )
+    {
+      zypper.out().warning( str::Format(_("Repository '%s' has no cached metadata. Refresh it first.")) % repo.asUserString() );
+      continue;
+    }
+
+    std::list<Pathname> files;
+    filesystem::assert_dir( staging.path() / bundleRawPath( repo ) );
+    if ( filesystem::copy_dir_content( systemRawPath( zypper, repo ), staging.path() / bundleRawPath( repo ) ) != 0
+      || ! collectFiles( staging.path(), bundleRawPath( repo ), files ) )
+    {
+      zypper.out().error( str::Format(_("Can't copy %s.")) % systemRawPath( zypper, repo ) );
+      return ZYPPER_EXIT_ERR_ZYPP;
+    }
+
+    // The solv cache comes along if it was built from these metadata;
+    // otherwise the importing host builds it.
+    std::list<Pathname> solvFiles;
+    if ( manager.isCached( repo ) && manager.cacheStatus( repo ) == rawStatus )
+    {
+      filesystem::assert_dir( staging.path() / bundleSolvPath( repo ) );
+      for ( const std::string & name : cacheBundleSolvFiles )
+      {
+	if ( filesystem::copy( systemSolvPath( zypper, repo ) / name, staging.path() / bundleSolvPath( repo ) / name ) != 0 )
+	{
+	  zypper.out().error( str::Format(_("Can't copy %s.")) % ( systemSolvPath( zypper, repo ) / name ) );
+	  return ZYPPER_EXIT_ERR_ZYPP;
+	}
+	solvFiles.push_back( bundleSolvPath( repo ) / name );
+      }
+    }
+    else
+      zypper.out().info( str::Format(_("The solv cache of repository '%s' is not up to date and is not exported.")) % repo.asUserString(), Out::HIGH );
+
+    manifest << "repo\t" << repo.alias() << "\t" << repo.url() << "\t"
+	     << rawStatus.checksum() << "\t" << Date::ValueType(rawStatus.timestamp()) << endl;
+    for ( const Pathname & file : files )
+      manifest << "file\t" << filesystem::checksum( staging.path() / file, Digest::sha256() ) << "\t" << file << endl;
+    if ( ! solvFiles.empty() )
+    {
+      manifest << "solv\t" << manager.cacheStatus( repo ).checksum() << endl;
+      for ( const Pathname & file : solvFiles )
+	manifest << "file\t" << filesystem::checksum( staging.path() / file, Digest::sha256() ) << "\t" << file << endl;
+    }
+
+    zypper.out().info( str::Format(_("Adding cache of repository '%s'.")) % repo.asUserString(), Out::HIGH );
+    ++exported;
+  }
+
+  manifest.close();
+  if ( ! manifest )
+  {
+    zypper.out().error( _("Can't write the cache bundle manifest.") );
+    return ZYPPER_EXIT_ERR_ZYPP;
+  }
+  if ( ! exported )
+  {
+    zypper.out().error( _("No repository cache to export.") );
+    return ZYPPER_EXIT_ERR_ZYPP;
+  }
+
+  Pathname file( absolutePath( file_r ) );
+  if ( runTar( { "tar", "-czf", file.asString(), "-C", staging.path().asString(), "." } ) != 0 )
+  {
+    zypper.out().error( str::Format(_("Can't open %s for writing.")) % file,
+			_("Maybe you do not have write permissions?") );
+    return ZYPPER_EXIT_ERR_ZYPP;
+  }
+
+  zypper.out().info( str::Format(PL_("The cache of %1% repository has been exported to %2%.",
+				     "The cache of %1% repositories has been exported to %2%.", exported)) % exported % file );
+  return ZYPPER_EXIT_OK;
+}
+
+int import_repo_cache( Zypper & zypper, const Pathname & file_r, const std::list<RepoInfo> & repos )
+{
+  RepoManager & manager( zypper.repoManager() );
+  filesystem::TmpDir staging( filesystem::TmpDir::defaultLocation(), "zypper-cache-bundle" );
+
+  Pathname file( absolutePath( file_r ) );
+  if ( ! PathInfo( file ).isFile()
+    || runTar( { "tar", "-xzf", file.asString(), "--no-same-owner", "-C", staging.path().asString() } ) != 0 )
+  {
+    zypper.out().error( str::Format(_("Can't read the cache bundle %s.")) % file );
+    return ZYPPER_EXIT_ERR_INVALID_ARGS;
+  }
+
+  // parse and verify the manifest
+  std::vector<BundledRepo> bundled;
+  std::map<std::string,std::list<std::pair<Pathname,std::string>>> bundledFiles;	// by alias
+  std::set<std::string> manifestFiles { cacheBundleManifest };
+  std::string bundleTools;
+  {
+    std::ifstream manifest( (staging.path() / cacheBundleManifest).c_str() );
+    std::string line;
+    if ( ! std::getline( manifest, line ) || ( line != cacheBundleMagic && line != cacheBundleMagicRawOnly ) )
+    {
+      zypper.out().error( str::Format(_("%s is not a repository cache bundle.")) % file );
+      return ZYPPER_EXIT_ERR_INVALID_ARGS;
+    }
+    bool rawOnly = ( line == cacheBundleMagicRawOnly );
+
+    while ( std::getline( manifest, line ) )
+    {
+      std::vector<std::string> fields;
+      str::split( line, std::back_inserter(fields), "\t" );
+      if ( fields.size() == 2 && fields[0] == "tools" && ! rawOnly && bundled.empty() )
+      {
+	bundleTools = fields[1];
+      }
+      else if ( fields.size() == 2 && fields[0] == "solv" && ! rawOnly && ! bundled.empty() && bundled.back().solvChecksum.empty() )
+      {
+	bundled.back().solvChecksum = fields[1];
+      }
+      else if ( fields.size() == 3 && fields[0] == "file" && ! bundled.empty() && ! bundled.back().solvChecksum.empty()
+	     && isBelow( fields[2], bundled.back().solvPath() ) )
+      {
+	bundledFiles[bundled.back().alias].push_back( std::make_pair( Pathname( fields[2] ), fields[1] ) );
+	manifestFiles.insert( fields[2] );
+      }
+      else if ( fields.size() == 5 && fields[0] == "repo" )
+      {
+	BundledRepo repo;
+	repo.alias = fields[1];
+	repo.url = fields[2];
+	repo.checksum = fields[3];
+	repo.timestamp = Date( str::strtonum<Date::ValueType>( fields[4] ) );
+	bundled.push_back( repo );
+      }
+      else if ( fields.size() == 3 && fields[0] == "file" && ! bundled.empty() && bundled.back().solvChecksum.empty()
+	     && isBelow( fields[2], bundled.back().rawPath() ) )
+      {
+	bundledFiles[bundled.back().alias].push_back( std::make_pair( Pathname( fields[2] ), fields[1] ) );
+	manifestFiles.insert( fields[2] );
+      }
+      else
+      {
+	ERR << "Bad manifest line: " << line << endl;
+	zypper.out().error( str::Format(_("%s is not a repository cache bundle.")) % file );
+	return ZYPPER_EXIT_ERR_INVALID_ARGS;
+      }
+    }
+  }
+
+  // the bundle must contain exactly the files listed in the manifest, and nothing but regular files
+  {
+    std::list<Pathname> files;
+    bool plain = collectFiles( staging.path(), Pathname(), files );
+    std::set<std::string> stagedFiles;
+    for ( const Pathname & f : files )
+      stagedFiles.insert( f.asString() );
+    if ( ! plain || stagedFiles != manifestFiles )
+    {
+      ERR << "Bundle content does not match the manifest" << endl;
+      zypper.out().error( str::Format(_("%s is not a repository cache bundle.")) % file );
+      return ZYPPER_EXIT_ERR_INVALID_ARGS;
+    }
+  }
+
+  unsigned imported = 0;
+  unsigned errors = 0;
+  for ( const BundledRepo & brepo : bundled )
+  {
+    if ( ! repos.empty()
+      && std::find_if( repos.begin(), repos.end(), [&brepo]( const RepoInfo & r ) { return r.alias() == brepo.alias; } ) == repos.end() )
+      continue;
+
+    if ( ! manager.hasRepo( brepo.alias ) )
+    {
+      zypper.out().info( str::Format(_("Repository '%s' is not defined, skipping its cache.")) % brepo.alias, Out::HIGH );
+      continue;
+    }
+    RepoInfo repo( manager.getRepo( brepo.alias ) );
+
+    // the cache must have been built from the same source
+    if ( repo.url().asString() != brepo.url )
+    {
+      zypper.out().warning( str::Format(_("The cache of repository '%s' was created for a different URI (%s), skipping it."))
+			    % repo.asUserString() % brepo.url );
+      continue;
+    }
+
+    RepoStatus localStatus( manager.metadataStatus( repo ) );
+    if ( ! localStatus.empty() && localStatus.checksum() == brepo.checksum && manager.cacheStatus( repo ) == localStatus )
+    {
+      zypper.out().info( str::Format(_("The cache of repository '%s' is up to date.")) % repo.asUserString(), Out::HIGH );
+      continue;
+    }
+    if ( ! localStatus.empty() && localStatus.timestamp() > brepo.timestamp )
+    {
+      zypper.out().info( str::Format(_("The cached metadata of repository '%s' are newer than the bundled ones, skipping them.")) % repo.asUserString() );
+      continue;
+    }
+
+    // verify the bundled files
+    std::string badFile;
+    for ( const auto & el : bundledFiles[brepo.alias] )
+    {
+      Pathname path( staging.path() / el.first );
+      if ( ! PathInfo( path ).isFile() || filesystem::checksum( path, Digest::sha256() ) != el.second )
+      {
+	badFile = el.first.asString();
+	break;
+      }
+    }
+    if ( ! badFile.empty() || bundledFiles[brepo.alias].empty() )
+    {
+      ERR << "Checksum mismatch: " << badFile << endl;
+      zypper.out().error( str::Format(_("The bundled cache of repository '%s' is corrupted.")) % repo.asUserString() );
+      ++errors;
+      continue;
+    }
+
+    // Install it by refreshing the repo from the bundled metadata, so they are
+    // signature checked exactly like downloaded ones, then install the solv cache.
+    // refreshMetadata replaces the raw cache only if the new metadata are fine.
+    RepoInfo bundledRepo( repo );
+    bundledRepo.setBaseUrl( Url( "dir:" + url::encode( (staging.path() / bundleRawPath( repo )).asString(), "/" ) ) );
+    bundledRepo.setMirrorListUrl( Url() );
+    bundledRepo.setPath( Pathname("/") );
+    try
+    {
+      manager.refreshMetadata( bundledRepo, RepoManager::RefreshForced );
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      zypper.out().error( e, str::Format(_("Can't import the metadata of repository '%s'.")) % repo.asUserString() );
+      ++errors;
+      continue;
+    }
+
+    // The bundled solv cache is used only if it was built from exactly the
+    // metadata now installed, by the same libzypp and libsolv; otherwise
+    // (or if bundled without one) it is built here.
+    bool solvInstalled = false;
+    if ( ! brepo.solvChecksum.empty() )
+    {
+      RepoStatus installedStatus( manager.metadataStatus( repo ) );
+      if ( bundleTools != cacheBundleTools() )
+	MIL << "Solv cache of " << repo.alias() << " was written by " << bundleTools << ", not " << cacheBundleTools() << endl;
+      else if ( installedStatus.empty() || installedStatus.checksum() != brepo.solvChecksum )
+	MIL << "Solv cache of " << repo.alias() << " was built from other metadata: " << brepo.solvChecksum << endl;
+      else if ( ! installBundledSolv( zypper, repo, staging.path() ) )
+	WAR << "Can't install the bundled solv cache of " << repo.alias() << endl;
+      else
+	solvInstalled = ( manager.cacheStatus( repo ) == installedStatus );
+
+      if ( ! solvInstalled )
+	zypper.out().info( str::Format(_("The bundled solv cache of repository '%s' does not match, building it.")) % repo.asUserString(), Out::HIGH );
+    }
+    try
+    {
+      manager.buildCache( repo, solvInstalled ? RepoManager::BuildIfNeeded : RepoManager::BuildForced );
+    }
+    catch ( const Exception & e )
+    {
+      ZYPP_CAUGHT( e );
+      zypper.out().error( e, str::Format(_("Can't build the cache of repository '%s'.")) % repo.asUserString() );
+      manager.cleanCache( repo );
+      ++errors;
+      continue;
+    }
+
+    zypper.out().info( str::Format(_("Imported the cache of repository '%s'.")) % repo.asUserString() );
+    ++imported;
+  }
+
+  if ( errors )
+    return ZYPPER_EXIT_ERR_ZYPP;
+  if ( ! imported )
+    zypper.out().info( _("No repository cache has been imported.") );
+  return ZYPPER_EXIT_OK;
+}
+
 // ----------------------------------------------------------------------------
 
 bool add_repo( Zypper & zypper, RepoInfo & repo, bool noCheck )
@@ -1613,6 +2606,7 @@ void modify_repo( Zypper & zypper, const std::string & alias, const RepoServiceC
       bool didVolatileChanges = false;
 
       manager.modifyRepository( alias, repo );
+      zypper.repoIndexChanged();
 
       if ( changed_enabled )
       {
@@ -1715,8 +2709,8 @@ void checkIfToRefreshPluginServices(Zypper & zypper, RepoManager::RefreshService
   if ( geteuid() != 0 )
     return;
 
-  RepoManager & repoManager = zypper.repoManager();
-  for ( const auto & service : repoManager.knownServices() )
+  std::vector<ServiceInfo> services;
+  for ( const auto & service : zypper.repoManager().knownServices() )
   {
     if ( service.type() != repo::ServiceType::PLUGIN )
       continue;
@@ -1724,9 +2718,14 @@ void checkIfToRefreshPluginServices(Zypper & zypper, RepoManager::RefreshService
       continue;
     if ( ! service.autorefresh() )
       continue;
+    services.push_back( service );
+  }
 
-    bool error = refresh_service( zypper, service, flags_r );
-    if (error)
+  std::vector<bool> errors( refresh_services( zypper, services, flags_r ) );
+  for ( unsigned i = 0; i < services.size(); ++i )
+  {
+    const ServiceInfo & service( services[i] );
+    if ( errors[i] )
     {
       ERR << "Skipping service '" << service.alias() << "' because of the above error." << endl;
       zypper.out().error( str::Format(_("Skipping service '%s' because of the above error.")) % service.asUserString() );
@@ -1760,6 +2759,26 @@ void load_resolvables( Zypper & zypper )
 
 // ---------------------------------------------------------------------------
 
+// libsolv must add the repos to the pool one by one, but this way reading the
+// next repos solv file from disk overlaps with parsing the current one.
+void prefetch_solv_caches( const Pathname & solvCachePath_r, const std::list<RepoInfo> & repos_r )
+{
+  for ( const RepoInfo & repo : repos_r )
+  {
+    if ( ! repo.enabled() )
+      continue;
+
+    Pathname solvfile( solvCachePath_r / repo.escaped_alias() / "solv" );
+    int fd = ::open( solvfile.c_str(), O_RDONLY | O_CLOEXEC );
+    if ( fd < 0 )
+      continue;	// not yet cached; will be built on the fly
+    int err = ::posix_fadvise( fd, 0, 0, POSIX_FADV_WILLNEED );
+    if ( err )
+      DBG << "posix_fadvise " << solvfile << ": " << ::strerror( err ) << endl;
+    ::close( fd );
+  }
+}
+
 void load_repo_resolvables( Zypper & zypper )
 {
   RepoManager & manager = zypper.repoManager();
@@ -1768,6 +2787,8 @@ void load_repo_resolvables( Zypper & zypper )
   zypper.out().info(_("Loading repository data...") );
   if ( gData.repos.empty() )
     zypper.out().warning(_("No repositories defined. Operating only with the installed resolvables. Nothing can be installed.") );
+  else
+    prefetch_solv_caches( zypper.config().rm_options.repoSolvCachePath, gData.repos );
 
   for_( it, gData.repos.begin(), gData.repos.end() )
   {
@@ -1812,7 +2833,10 @@ void load_repo_resolvables( Zypper & zypper )
         }
       }
 
-      manager.loadFromCache( repo );
+      {
+        Timings::Phase phase( "load", repo.alias() );
+        manager.loadFromCache( repo );
+      }
 
       // check that the metadata is not outdated
       // feature #301904
@@ -1850,6 +2874,7 @@ void load_target_resolvables(Zypper & zypper)
 
   try
   {
+    Timings::Phase phase( "load", "@System" );
     God->target()->load();
   }
   catch ( const Exception & e )
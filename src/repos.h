@@ -9,6 +9,7 @@
 #define ZMART_SOURCES_H
 
 #include <list>
+#include <set>
 
 #include <boost/lexical_cast.hpp>
 
@@ -19,6 +20,8 @@
 
 #include "Zypper.h"
 #include "commands/reposerviceoptionsets.h"
+#include "commands/repos/refresh.h"
+#include "utils/WorkerPool.h"
 
 #define  TMP_RPM_REPO_ALIAS  "_tmpRPMcache_"
 
@@ -115,6 +118,27 @@ enum class CleanRepoBits {
 ZYPP_DECLARE_FLAGS_AND_OPERATORS(CleanRepoFlags, CleanRepoBits)
 void clean_repos(Zypper & zypper, std::vector<std::string> specificRepos, CleanRepoFlags flags );
 
+/**
+ * Write the raw metadata of \a repos into the tar archive \a file_r, together
+ * with their solv caches if built from exactly these metadata.
+ *
+ * Repos without cached metadata are skipped. Returns the exit code.
+ */
+int export_repo_cache( Zypper & zypper, const std::list<RepoInfo> & repos, const Pathname & file_r );
+
+/**
+ * Install the repo caches from a bundle written by \ref export_repo_cache.
+ *
+ * Only caches of defined repos with a matching URI are imported (restricted to
+ * \a repos unless empty). The bundle must hold exactly the regular files listed
+ * in its manifest, with matching checksums. The metadata are refreshed from the
+ * bundle (so their signature is checked). The bundled solv cache is installed if
+ * it was built from these metadata by the same libzypp and libsolv versions,
+ * otherwise it is rebuilt. Caches of repos with newer local metadata are left
+ * untouched. Returns the exit code.
+ */
+int import_repo_cache( Zypper & zypper, const Pathname & file_r, const std::list<RepoInfo> & repos );
+
 /**
  * Try match given string with any known repository.
  *
@@ -215,6 +239,12 @@ void load_target_resolvables( Zypper & zypper );
  */
 void load_repo_resolvables( Zypper & zypper );
 
+/**
+ * Let the kernel start reading the solv caches of all enabled \a repos_r
+ * below \a solvCachePath_r in the background (done by \ref load_repo_resolvables).
+ */
+void prefetch_solv_caches( const Pathname & solvCachePath_r, const std::list<RepoInfo> & repos_r );
+
 ColorString repoPriorityNumber( unsigned prio_r, int width_r = 0 );
 ColorString repoPriorityNumberAnnotated( unsigned prio_r, int width_r = 0 );
 
@@ -227,8 +257,60 @@ void repoPrioSummary( Zypper & zypper );
 
 bool refresh_raw_metadata( Zypper & zypper, const RepoInfo & repo, bool force_download );
 
+/** Probe all baseurls of \a repo concurrently, the first one to answer wins.
+ * Each url must provide the repos index file (\c repodata/repomd.xml or
+ * \c content), so only rpm-md and susetags repos are raced. The winner is
+ * moved to the front of the repos baseurls and the result of its check is
+ * returned in \a stat_r. The losers are asked to stop and the \ref MirrorStats
+ * are updated (not saved). Returns \c false if no url answered.
+ */
+bool race_mirrors( Zypper & zypper, RepoInfo & repo, RepoManager::RefreshCheckPolicy policy_r, RepoManager::RefreshCheckStatus & stat_r );
+
 bool build_cache( Zypper & zypper, const RepoInfo & repo, bool force_build );
 
+/** Whether \a repo may be refreshed by a \ref WorkerPool process.
+ * Media needing user interaction (CD/DVD) and repos whose type is not yet
+ * known (probing would modify the .repo file) must be refreshed in zypper itself.
+ */
+bool worker_may_refresh( const RepoInfo & repo );
+
+/**
+ * Silently refresh raw metadata and solv cache of \a repos in up to \a jobs_r
+ * concurrent worker processes (\see \ref WorkerPool).
+ *
+ * Workers are non-interactive and never import keys. Results are returned in
+ * order of \a repos. Pass the data of a successful result to \ref report_worker_refresh.
+ * A failed repo must be refreshed again via \ref refresh_raw_metadata and
+ * \ref build_cache, which provides the usual error reporting and user interaction.
+ */
+std::vector<WorkerPool::Result> refresh_repos_in_workers( Zypper & zypper, const std::vector<RepoInfo> & repos, RefreshRepoCmd::RefreshFlags flags_r, unsigned jobs_r );
+
+/** A repo and how to refresh it (\ref refresh_repos_in_workers). */
+typedef std::pair<RepoInfo,RefreshRepoCmd::RefreshFlags> RepoRefreshRequest;
+
+/** \overload Refresh each repo according to its own flags. */
+std::vector<WorkerPool::Result> refresh_repos_in_workers( Zypper & zypper, const std::vector<RepoRefreshRequest> & requests_r, unsigned jobs_r );
+
+/** Report the refresh a worker did for \a repo like \ref refresh_raw_metadata and \ref build_cache would. */
+void report_worker_refresh( Zypper & zypper, const RepoInfo & repo, const std::string & data_r );
+
+/**
+ * Whether the cached metadata of \a repo suggest it provides any of the
+ * --plus-content \a keywords_r. Also \c true if no metadata are cached yet.
+ *
+ * The keywords are remembered in a persistent index (repo alias -> keywords),
+ * which is valid as long as the cookie (checksum) of the repos raw metadata
+ * does not change. So the metadata must be parsed again only after a refresh.
+ */
+bool repo_may_provide_content( Zypper & zypper, const RepoInfo & repo, const std::set<std::string> & keywords_r );
+
+/**
+ * Whether the cached metadata of \a repo contain any of the --plus-content
+ * \a keywords_r. Like \ref repo_may_provide_content, but \c false if no
+ * metadata are cached.
+ */
+bool repo_provides_content( Zypper & zypper, const RepoInfo & repo, const std::set<std::string> & keywords_r );
+
 /**
  * Iterate over \a positionalArgs and try to treat it as a .rpm file, in case it turns out to be a valid
  * rpm file, remove the arg from the list and place the file in a temporary repository
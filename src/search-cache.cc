@@ -0,0 +1,235 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file search-cache.cc
+ * On-disk cache of 'zypper search' results.
+ */
+#include <unistd.h>
+
+#include <algorithm>
+#include <list>
+#include <vector>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/Digest.h>
+#include <zypp/PathInfo.h>
+#include <zypp/RepoManager.h>
+#include <zypp/ZConfig.h>
+
+#include "Zypper.h"
+
+#include "search-cache.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  const std::string magic( "ZYPPER-SEARCH-CACHE 2" );
+
+  /** The files the rpm database may consist of, relative to the root. */
+  const std::vector<std::string> & rpmdbFiles()
+  {
+    static const std::vector<std::string> _files {
+      "var/lib/rpm/Packages", "var/lib/rpm/Packages.db", "var/lib/rpm/rpmdb.sqlite",
+      "usr/lib/sysimage/rpm/Packages", "usr/lib/sysimage/rpm/Packages.db", "usr/lib/sysimage/rpm/rpmdb.sqlite",
+    };
+    return _files;
+  }
+
+  /** Size and mtime of the rpm database files; any commit changes them. */
+  std::string rpmdbState( Zypper & zypper )
+  {
+    std::string ret;
+    for ( const std::string & file : rpmdbFiles() )
+    {
+      PathInfo info( Pathname( zypper.config().root_dir ) / file );
+      if ( info.isFile() )
+	ret += file + "=" + str::numstring( info.size() ) + ":" + str::numstring( info.mtime() ) + " ";
+    }
+    return ret;
+  }
+
+  /** Size and mtime of the locks file; adding or removing locks changes them. */
+  std::string locksState( Zypper & zypper )
+  {
+    PathInfo info( Pathname::assertprefix( zypper.config().root_dir, ZConfig::instance().locksFile() ) );
+    if ( ! info.isFile() )
+      return std::string();
+    return str::numstring( info.size() ) + ":" + str::numstring( info.mtime() );
+  }
+
+  // A field is stored as its length and the bytes, each followed by a newline.
+  inline void putField( std::ostream & out_r, const std::string & field_r )
+  { out_r << field_r.size() << '\n' << field_r << '\n'; }
+
+  inline bool getField( std::istream & in_r, std::string & field_r )
+  {
+    std::string line;
+    if ( ! std::getline( in_r, line ) )
+      return false;
+    std::string::size_type len = str::strtonum<std::string::size_type>( line );
+    field_r.resize( len );
+    if ( len && ! in_r.read( &field_r[0], len ) )
+      return false;
+    return in_r.get() == '\n';
+  }
+
+  /** Remove the oldest entries in \a dir_r beyond \a keep_r. */
+  void pruneEntries( const Pathname & dir_r, unsigned keep_r )
+  {
+    std::list<std::string> names;
+    if ( filesystem::readdir( names, dir_r, false ) != 0 || names.size() <= keep_r )
+      return;
+
+    std::vector<std::pair<time_t,Pathname>> entries;
+    for ( const std::string & name : names )
+    {
+      PathInfo info( dir_r / name );
+      if ( info.isFile() )
+	entries.push_back( { info.mtime(), info.path() } );
+    }
+    if ( entries.size() <= keep_r )
+      return;
+    std::sort( entries.begin(), entries.end() );
+    for ( unsigned i = 0; i < entries.size() - keep_r; ++i )
+      filesystem::unlink( entries[i].second );
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+SearchResultCache::SearchResultCache( Zypper & zypper, const std::string & query_r )
+{
+  std::string key( query_r );
+  key += "\nlocale: " + ZConfig::instance().textLocale().code();
+  key += "\nsystem: " + std::string( zypper.config().disable_system_resolvables ? "no" : "yes" );
+  key += "\nrpmdb: " + rpmdbState( zypper );
+  key += "\nlocks: " + locksState( zypper );
+  for ( const RepoInfo & repo : zypper.runtimeData().repos )
+  {
+    if ( ! repo.enabled() )
+      continue;
+    RepoStatus status( zypper.repoManager().cacheStatus( repo ) );
+    if ( status.empty() )
+    {
+      DBG << "No search cache: " << repo.alias() << " is not cached" << endl;
+      return;	// e.g. a temporary repo
+    }
+    // names and labels are shown in the results, but renaming a repo does not touch its cache
+    key += "\nrepo: " + repo.alias() + " " + status.checksum() + "\n  " + repo.name() + "\n  " + repo.asUserString();
+  }
+
+  _key = std::move(key);
+  _file = zypper.config().rm_options.repoCachePath / "search-results" / Digest::digest( "sha1", _key );
+}
+
+SearchResultCache::~SearchResultCache()
+{
+  if ( _out.is_open() )
+  {
+    _out.close();
+    filesystem::unlink( _file.extend( ".new" ) );
+  }
+}
+
+bool SearchResultCache::replay( const std::function<void( bool details_r, bool streamed_r, TableRow row_r )> & row_r, std::string & hint_r ) const
+{
+  if ( ! usable() )
+    return false;
+
+  std::ifstream in( _file.c_str() );
+  std::string field;
+  if ( ! ( std::getline( in, field ) && field == magic && getField( in, field ) && field == _key ) )
+    return false;	// missing or hash collision
+  if ( ! std::getline( in, field ) || field.size() != 2 )
+    return false;
+  bool details = ( field[0] == '1' );
+  bool streamed = ( field[1] == '1' );
+  MIL << "Search result from cache " << _file << endl;
+
+  std::string line;
+  while ( std::getline( in, line ) && line.size() && line[0] == 'R' )
+  {
+    unsigned columnCount = 0;
+    unsigned detailCount = 0;
+    std::vector<std::string> words;
+    str::split( line, std::back_inserter( words ) );
+    if ( words.size() != 3 )
+      break;
+    str::strtonum( words[1], columnCount );
+    str::strtonum( words[2], detailCount );
+
+    TableRow row;
+    for ( ; columnCount; --columnCount )
+    {
+      if ( ! getField( in, field ) )
+	return true;	// can't happen as the file is written atomically
+      row.add( field );
+    }
+    for ( ; detailCount; --detailCount )
+    {
+      if ( ! getField( in, field ) )
+	return true;
+      row.addDetail( field );
+    }
+    row_r( details, streamed, std::move(row) );
+  }
+  if ( line == "E" && getField( in, field ) )
+    hint_r = field;
+  return true;
+}
+
+void SearchResultCache::storeBegin( bool details_r, bool streamed_r )
+{
+  if ( ! usable() || geteuid() != 0 )
+    return;	// the zypp cache belongs to root
+
+  filesystem::assert_dir( _file.dirname() );
+  _out.open( _file.extend( ".new" ).c_str() );
+  if ( ! _out )
+  {
+    WAR << "Can't write search cache " << _file << endl;
+    return;
+  }
+  _out << magic << '\n';
+  putField( _out, _key );
+  _out << ( details_r ? '1' : '0' ) << ( streamed_r ? '1' : '0' ) << '\n';
+}
+
+void SearchResultCache::storeRow( const TableRow & row_r )
+{
+  if ( ! _out.is_open() )
+    return;
+  _out << "R " << row_r.columnsNoTr().size() << " " << row_r.details().size() << '\n';
+  for ( const std::string & column : row_r.columnsNoTr() )
+    putField( _out, column );
+  for ( const std::string & detail : row_r.details() )
+    putField( _out, detail );
+}
+
+void SearchResultCache::storeEnd( const std::string & hint_r )
+{
+  if ( ! _out.is_open() )
+    return;
+  _out << "E\n";
+  putField( _out, hint_r );
+  _out.close();
+
+  Pathname tmp( _file.extend( ".new" ) );
+  if ( ! _out || filesystem::rename( tmp, _file ) != 0 )
+  {
+    WAR << "Can't write search cache " << _file << endl;
+    filesystem::unlink( tmp );
+    return;
+  }
+  pruneEntries( _file.dirname(), maxEntries );
+}
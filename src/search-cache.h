@@ -0,0 +1,92 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file search-cache.h
+ * On-disk cache of 'zypper search' results.
+ */
+#ifndef ZYPPER_SEARCH_CACHE_H
+#define ZYPPER_SEARCH_CACHE_H
+
+#include <fstream>
+#include <functional>
+#include <string>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/Pathname.h>
+
+#include "Table.h"
+
+class Zypper;
+
+///////////////////////////////////////////////////////////////////
+/// \class SearchResultCache
+/// \brief The cached result of one search.
+///
+/// An entry is keyed by the normalized search (options and arguments),
+/// the enabled repos along with the cookies of their metadata and their
+/// names, and the state of the rpm database and the locks file. So any
+/// refresh, commit, lock change or repo rename invalidates it.
+/// The entries are stored in the zypp cache directory; as this belongs
+/// to root, only root stores results. The rows are stored as they are
+/// added, so a result must not be kept in memory for this.
+///
+/// \code
+///   SearchResultCache cache( zypper, query );	// target and repos initialized
+///   std::string hint;
+///   if ( cache.replay( []( bool details_r, bool streamed_r, TableRow row_r ) { ... }, hint ) )
+///     return;
+///   cache.storeBegin( details, streamed );
+///   cache.storeRow( row );
+///   cache.storeEnd( hint );
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class SearchResultCache : private zypp::base::NonCopyable
+{
+public:
+  /** The entry of \a query_r, the normalized search options and arguments.
+   * The target and the repos must be initialized, their state is part
+   * of the key.
+   */
+  SearchResultCache( Zypper & zypper, const std::string & query_r );
+
+  /** An unfinished result is dropped. */
+  ~SearchResultCache();
+
+  /** Whether results can be cached at all (not with temporary repos). */
+  bool usable() const
+  { return ! _file.empty(); }
+
+  /** Pass the rows of the cached result to \a row_r along with the kind
+   * of rows (\c true: a \ref FillSearchTableSolvable row, else a
+   * \ref FillSearchTableSelectable one) and whether they were streamed
+   * (see \ref Out::searchResultRow) rather than printed as a whole table.
+   * \a hint_r is set to the hint stored along with the result.
+   * \return \c false if there is no (valid) cached result.
+   */
+  bool replay( const std::function<void( bool details_r, bool streamed_r, TableRow row_r )> & row_r, std::string & hint_r ) const;
+
+  /** \name Storing a result.
+   * \ref storeBegin, \ref storeRow for each row (in the order they are
+   * printed), \ref storeEnd. Nothing is stored unless \ref storeEnd is
+   * called. Does nothing if the user can't write the cache.
+   */
+  //@{
+  void storeBegin( bool details_r, bool streamed_r );
+  void storeRow( const TableRow & row_r );
+  void storeEnd( const std::string & hint_r );
+  //@}
+
+  /** Number of results kept; the least recently stored are removed. */
+  static const unsigned maxEntries = 64;
+
+private:
+  zypp::Pathname _file;
+  std::string _key;
+  std::ofstream _out;
+};
+
+#endif // ZYPPER_SEARCH_CACHE_H
@@ -0,0 +1,570 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file search-index.cc
+ * Persistent per-repo indexes used by 'zypper search'.
+ */
+#include <unistd.h>
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <map>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/Easy.h>
+#include <zypp/base/StrMatcher.h>
+#include <zypp/base/String.h>
+#include <zypp/sat/LookupAttr.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/PathInfo.h>
+#include <zypp/RepoManager.h>
+
+#include "Zypper.h"
+#include "utils/SolvableIndex.h"
+#include "utils/Timings.h"
+#include "utils/Trigrams.h"
+
+#include "search-index.h"
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  typedef SolvableIndex::Offset Offset;
+  typedef std::vector<Offset> Offsets;
+
+  /** The keys a solvable is indexed by. */
+  typedef std::function<void( const sat::Solvable & solv_r, std::vector<std::string> & keys_r )> KeysFunction;
+
+  /** Word characters are ASCII letters and digits; anything else separates words. */
+  inline bool isWordChar( char ch )
+  { return ( ch >= 'a' && ch <= 'z' ) || ( ch >= 'A' && ch <= 'Z' ) || ( ch >= '0' && ch <= '9' ); }
+
+  inline char asciiLower( char ch )
+  { return ( ch >= 'A' && ch <= 'Z' ) ? ch + ( 'a' - 'A' ) : ch; }
+
+  inline std::string asciiLowered( std::string str_r )
+  {
+    for ( char & ch : str_r )
+      ch = asciiLower( ch );
+    return str_r;
+  }
+
+  inline bool isAscii( const std::string & str_r )
+  {
+    for ( char ch : str_r )
+      if ( static_cast<unsigned char>(ch) >= 0x80 )
+	return false;
+    return true;
+  }
+
+  /** A word of the search pattern and how it must appear in the text. */
+  struct PatternWord
+  {
+    std::string word;	///< lowercased
+    bool head = false;	///< a separator precedes it, so it starts a word of the text
+    bool tail = false;	///< a separator follows it, so it ends a word of the text
+  };
+
+  /** Append the lowercased words of \a text_r to \a words_r. */
+  void splitWords( const char * text_r, std::vector<std::string> & words_r )
+  {
+    if ( ! text_r )
+      return;
+    for ( const char * p = text_r; *p; )
+    {
+      if ( ! isWordChar( *p ) )
+      { ++p; continue; }
+      std::string word;
+      for ( ; isWordChar( *p ); ++p )
+	word += asciiLower( *p );
+      words_r.push_back( std::move(word) );
+    }
+  }
+
+  /** The words of \a pattern_r; empty if the pattern has no words or non-ASCII characters. */
+  std::vector<PatternWord> patternWords( const std::string & pattern_r )
+  {
+    std::vector<PatternWord> ret;
+    for ( std::string::size_type pos = 0; pos < pattern_r.size(); )
+    {
+      if ( static_cast<unsigned char>(pattern_r[pos]) >= 0x80 )
+	return std::vector<PatternWord>();	// we don't know how to fold the case
+      if ( ! isWordChar( pattern_r[pos] ) )
+      { ++pos; continue; }
+
+      PatternWord word;
+      word.head = ( pos != 0 );
+      for ( ; pos < pattern_r.size() && isWordChar( pattern_r[pos] ); ++pos )
+	word.word += asciiLower( pattern_r[pos] );
+      word.tail = ( pos != pattern_r.size() );
+      ret.push_back( std::move(word) );
+    }
+    return ret;
+  }
+
+  /** The solvables of \a repo_r; their position is the \ref SolvableIndex::Offset. */
+  std::vector<sat::Solvable> repoSolvables( const sat::Repository & repo_r )
+  {
+    std::vector<sat::Solvable> ret;
+    ret.reserve( repo_r.solvablesSize() );
+    for ( const sat::Solvable & solv : repo_r.solvables() )
+      ret.push_back( solv );
+    return ret;
+  }
+
+  /** The file of the \a kind_r index of \a repo_r and the \a cookie_r it must be built for.
+   * The index is stored next to the repos solv file and keyed by the solv
+   * files cookie. The system repos solv file has no cookie of its own (it
+   * is rebuilt whenever the rpm database changes), so its size and mtime
+   * are used. Returns an empty path if \a repo_r has no solv cache.
+   */
+  Pathname repoIndexFile( Zypper & zypper, const sat::Repository & repo_r, const std::string & kind_r, std::string & cookie_r )
+  {
+    Pathname dir( zypper.config().rm_options.repoSolvCachePath );
+    if ( repo_r.isSystemRepo() )
+    {
+      dir /= repo_r.alias();
+      PathInfo solv( dir / "solv" );
+      if ( ! solv.isFile() )
+	return Pathname();
+      cookie_r = str::numstring( solv.size() ) + ":" + str::numstring( solv.mtime() );
+    }
+    else
+    {
+      RepoInfo info( repo_r.info() );
+      RepoStatus status( zypper.repoManager().cacheStatus( info ) );
+      if ( status.empty() )
+	return Pathname();	// e.g. a temporary repo
+      dir /= info.escaped_alias();
+      cookie_r = status.checksum();
+    }
+    return dir / ( "zypper-" + kind_r + ".idx" );
+  }
+
+  /** The up to date \a kind_r index of \a repo_r or \c nullptr. */
+  std::unique_ptr<SolvableIndex> repoIndex( Zypper & zypper, const sat::Repository & repo_r, const std::vector<sat::Solvable> & solvables_r,
+					    const std::string & kind_r )
+  {
+    std::string cookie;
+    Pathname file( repoIndexFile( zypper, repo_r, kind_r, cookie ) );
+    if ( file.empty() )
+      return nullptr;
+    std::unique_ptr<SolvableIndex> index( SolvableIndex::load( file, cookie ) );
+    if ( index && index->solvableCount() == solvables_r.size() )
+      return index;
+    return nullptr;
+  }
+
+  /** Build the \a kind_r index of \a repo_r from \a solvables_r using \a keys_r unless it is up to date. */
+  void buildRepoIndex( Zypper & zypper, const sat::Repository & repo_r, const std::vector<sat::Solvable> & solvables_r,
+		       const std::string & kind_r, const KeysFunction & keys_r )
+  {
+    if ( repoIndex( zypper, repo_r, solvables_r, kind_r ) )
+      return;
+    std::string cookie;
+    Pathname file( repoIndexFile( zypper, repo_r, kind_r, cookie ) );
+    if ( file.empty() )
+      return;
+
+    Timings::Phase phase( "build index", kind_r + ":" + repo_r.alias() );
+    SolvableIndex::Builder builder;
+    std::vector<std::string> keys;
+    for ( Offset offset = 0; offset < solvables_r.size(); ++offset )
+    {
+      keys.clear();
+      keys_r( solvables_r[offset], keys );
+      for ( const std::string & key : keys )
+	builder.add( key, offset );
+    }
+    if ( ! builder.save( file, cookie, solvables_r.size() ) )
+      WAR << "Can't write the " << kind_r << " index of " << repo_r.alias() << std::endl;
+  }
+
+  /** Whether \a query_r looks into \a repo_r at all. */
+  bool queryRepo( const PoolQuery & query_r, const sat::Repository & repo_r )
+  {
+    if ( repo_r.isSystemRepo() ? query_r.statusFilterFlags() == PoolQuery::UNINSTALLED_ONLY
+			       : query_r.statusFilterFlags() == PoolQuery::INSTALLED_ONLY )
+      return false;
+    return query_r.repos().empty() || query_r.repos().count( repo_r.alias() );
+  }
+
+  /** Whether \a query_r wants the kind of \a solv_r. */
+  inline bool queryKind( const PoolQuery & query_r, const sat::Solvable & solv_r )
+  { return query_r.kinds().empty() || query_r.kinds().count( solv_r.kind() ); }
+
+  /** Sorted, unique offsets of solvables having a word matching \a word_r. */
+  Offsets wordCandidates( const SolvableIndex & index_r, const PatternWord & word_r )
+  {
+    Offsets ret;
+    if ( word_r.head && word_r.tail )
+    {
+      const SolvableIndex::Postings & postings( index_r.find( word_r.word ) );
+      ret.assign( postings.begin(), postings.end() );
+      return ret;	// already sorted and unique
+    }
+
+    if ( word_r.head )
+      index_r.findPrefix( word_r.word, ret );
+    else
+    {
+      boost::string_ref word( word_r.word );
+      index_r.forEachKey( [&]( boost::string_ref key_r, const SolvableIndex::Postings & postings_r ) {
+	if ( word_r.tail ? key_r.ends_with( word ) : key_r.find( word ) != boost::string_ref::npos )
+	  ret.insert( ret.end(), postings_r.begin(), postings_r.end() );
+      } );
+    }
+    std::sort( ret.begin(), ret.end() );
+    ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+    return ret;
+  }
+
+  /** Solvables having all of \a words_r (sorted by offset). */
+  Offsets candidates( const SolvableIndex & index_r, std::vector<PatternWord> words_r )
+  {
+    // Exact words are cheapest and most selective, the vocabulary scans come last.
+    std::stable_sort( words_r.begin(), words_r.end(), []( const PatternWord & lhs, const PatternWord & rhs ) {
+      return ( lhs.head + lhs.tail ) > ( rhs.head + rhs.tail );
+    } );
+
+    Offsets ret;
+    bool first = true;
+    for ( const PatternWord & word : words_r )
+    {
+      Offsets found( wordCandidates( index_r, word ) );
+      if ( first )
+      {
+	ret.swap( found );
+	first = false;
+      }
+      else
+      {
+	Offsets both;
+	std::set_intersection( ret.begin(), ret.end(), found.begin(), found.end(), std::back_inserter( both ) );
+	ret.swap( both );
+      }
+      if ( ret.empty() )
+	break;
+    }
+    return ret;
+  }
+
+  void descriptionKeys( const sat::Solvable & solv_r, std::vector<std::string> & keys_r )
+  {
+    splitWords( solv_r.lookupStrAttribute( sat::SolvAttr::summary ).c_str(), keys_r );
+    splitWords( solv_r.lookupStrAttribute( sat::SolvAttr::description ).c_str(), keys_r );
+  }
+
+  void nameKeys( const sat::Solvable & solv_r, std::vector<std::string> & keys_r )
+  { trigram::split( solv_r.name(), keys_r ); }
+
+  /** Keys of the file index: a files basename and its directory (without trailing slash). */
+  const std::string basenameKey( "b:" );
+  const std::string dirnameKey( "d:" );
+
+  void fileKeys( const sat::Solvable & solv_r, std::vector<std::string> & keys_r )
+  {
+    std::vector<std::string> keys;
+    sat::LookupAttr files( sat::SolvAttr::filelist, solv_r );
+    for_( it, files.begin(), files.end() )
+    {
+      std::string path( asciiLowered( it.asString() ) );
+      std::string::size_type pos = path.rfind( '/' );
+      if ( pos == std::string::npos )
+	keys.push_back( basenameKey + path );
+      else
+      {
+	keys.push_back( dirnameKey + path.substr( 0, pos ) );
+	keys.push_back( basenameKey + path.substr( pos + 1 ) );
+      }
+    }
+    // most files share their directory with others
+    std::sort( keys.begin(), keys.end() );
+    keys.erase( std::unique( keys.begin(), keys.end() ), keys.end() );
+    keys_r.insert( keys_r.end(), keys.begin(), keys.end() );
+  }
+
+  inline void sortUnique( Offsets & offsets_r )
+  {
+    std::sort( offsets_r.begin(), offsets_r.end() );
+    offsets_r.erase( std::unique( offsets_r.begin(), offsets_r.end() ), offsets_r.end() );
+  }
+
+  inline Offsets intersection( const Offsets & lhs_r, const Offsets & rhs_r )
+  {
+    Offsets ret;
+    std::set_intersection( lhs_r.begin(), lhs_r.end(), rhs_r.begin(), rhs_r.end(), std::back_inserter( ret ) );
+    return ret;
+  }
+
+  inline Offsets unite( const Offsets & lhs_r, const Offsets & rhs_r )
+  {
+    Offsets ret;
+    std::set_union( lhs_r.begin(), lhs_r.end(), rhs_r.begin(), rhs_r.end(), std::back_inserter( ret ) );
+    return ret;
+  }
+
+  /** Solvables having a \a kind_r key whose value (the part behind \a kind_r) satisfies \a pred_r. */
+  Offsets keysIf( const SolvableIndex & index_r, const std::string & kind_r, const std::function<bool( boost::string_ref value_r )> & pred_r )
+  {
+    Offsets ret;
+    index_r.forEachKey( kind_r, [&]( boost::string_ref key_r, const SolvableIndex::Postings & postings_r ) {
+      if ( pred_r( key_r.substr( kind_r.size() ) ) )
+	ret.insert( ret.end(), postings_r.begin(), postings_r.end() );
+    } );
+    sortUnique( ret );
+    return ret;
+  }
+
+  /** Solvables which may have a file matching the lowercased \a pattern_r in \a mode_r.
+   * See \ref search_files for the supported patterns.
+   */
+  Offsets fileCandidates( const SolvableIndex & index_r, const std::string & pattern_r, Match::Mode mode_r )
+  {
+    auto contains = [&pattern_r]( boost::string_ref value_r ) { return value_r.find( pattern_r ) != boost::string_ref::npos; };
+    if ( pattern_r[0] != '/' )
+    {
+      // no slash at all: part of a basename or directory
+      return unite( keysIf( index_r, basenameKey, contains ), keysIf( index_r, dirnameKey, contains ) );
+    }
+
+    std::string::size_type pos = pattern_r.rfind( '/' );
+    std::string dir( pattern_r.substr( 0, pos ) );
+    std::string base( pattern_r.substr( pos + 1 ) );
+    if ( mode_r == Match::STRING )
+    {
+      const SolvableIndex::Postings & dirs( index_r.find( dirnameKey + dir ) );
+      const SolvableIndex::Postings & bases( index_r.find( basenameKey + base ) );
+      Offsets ret;
+      std::set_intersection( dirs.begin(), dirs.end(), bases.begin(), bases.end(), std::back_inserter( ret ) );
+      return ret;
+    }
+
+    // Either the patterns last slash is the one in front of the basename (so
+    // the directory ends with the patterns dir and the basename starts with
+    // its base), or the pattern is part of the directory.
+    Offsets ret;
+    if ( base.empty() || ! dir.empty() )
+      ret = keysIf( index_r, dirnameKey, [&dir]( boost::string_ref value_r ) { return value_r.ends_with( dir ); } );
+    if ( ! base.empty() )
+    {
+      Offsets bases;
+      index_r.findPrefix( basenameKey + base, bases );
+      sortUnique( bases );
+      ret = dir.empty() ? bases : intersection( ret, bases );
+    }
+    return unite( ret, keysIf( index_r, dirnameKey, contains ) );
+  }
+
+  /** Solvables having all \a keys_r (sorted by offset). */
+  Offsets allKeys( const SolvableIndex & index_r, const std::vector<std::string> & keys_r )
+  {
+    // start with the rarest key to keep the intersections small
+    std::vector<SolvableIndex::Postings> postings;
+    for ( const std::string & key : keys_r )
+    {
+      postings.push_back( index_r.find( key ) );
+      if ( postings.back().empty() )
+	return Offsets();
+    }
+    std::sort( postings.begin(), postings.end(), []( const SolvableIndex::Postings & lhs, const SolvableIndex::Postings & rhs ) {
+      return lhs.size() < rhs.size();
+    } );
+
+    Offsets ret( postings.front().begin(), postings.front().end() );
+    for ( unsigned i = 1; i < postings.size() && ! ret.empty(); ++i )
+    {
+      Offsets both;
+      std::set_intersection( ret.begin(), ret.end(), postings[i].begin(), postings[i].end(), std::back_inserter( both ) );
+      ret.swap( both );
+    }
+    return ret;
+  }
+
+  /** Add the solvables \a query_r looks at and \a match_r accepts to \a result_r.
+   * Repos having a \a kind_r index only check the solvables \a candidates_r
+   * returns, the others are scanned.
+   */
+  void searchRepos( Zypper & zypper, const PoolQuery & query_r, const std::string & kind_r,
+		    const std::function<Offsets( const SolvableIndex & index_r )> & candidates_r,
+		    const std::function<bool( const sat::Solvable & solv_r )> & match_r,
+		    PoolQueryResult & result_r )
+  {
+    for ( const sat::Repository & repo : sat::Pool::instance().repos() )
+    {
+      if ( ! queryRepo( query_r, repo ) )
+	continue;
+
+      std::vector<sat::Solvable> solvables( repoSolvables( repo ) );
+      std::unique_ptr<SolvableIndex> index( repoIndex( zypper, repo, solvables, kind_r ) );
+      if ( index )
+      {
+	Offsets found( candidates_r( *index ) );
+	DBG << repo.alias() << ": " << found.size() << " of " << solvables.size() << " " << kind_r << " candidates" << std::endl;
+	for ( Offset offset : found )
+	{
+	  const sat::Solvable & solv( solvables[offset] );
+	  if ( queryKind( query_r, solv ) && match_r( solv ) )
+	    result_r += solv;
+	}
+      }
+      else
+      {
+	for ( const sat::Solvable & solv : solvables )
+	{
+	  if ( queryKind( query_r, solv ) && match_r( solv ) )
+	    result_r += solv;
+	}
+      }
+    }
+  }
+
+  /** The \ref StrMatcher flags \a query_r would use for \a mode_r. */
+  inline Match matchFlags( const PoolQuery & query_r, Match::Mode mode_r )
+  {
+    Match flags( mode_r );
+    if ( ! query_r.caseSensitive() )
+      flags |= Match::NOCASE;
+    return flags;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+bool search_descriptions( Zypper & zypper, const std::string & pattern_r, const PoolQuery & query_r, PoolQueryResult & result_r )
+{
+  Match::Mode mode( query_r.matchMode() );
+  if ( query_r.matchWord() || ( mode != Match::SUBSTRING && mode != Match::STRING ) )
+    return false;
+
+  std::vector<PatternWord> words( patternWords( pattern_r ) );
+  if ( words.empty() )
+    return false;
+
+  StrMatcher matcher( pattern_r, matchFlags( query_r, mode ) );
+  searchRepos( zypper, query_r, "words",
+	       [&words]( const SolvableIndex & index_r ) { return candidates( index_r, words ); },
+	       [&matcher]( const sat::Solvable & solv_r ) {
+		 return matcher( solv_r.lookupStrAttribute( sat::SolvAttr::summary ) )
+		     || matcher( solv_r.lookupStrAttribute( sat::SolvAttr::description ) );
+	       },
+	       result_r );
+  return true;
+}
+
+bool search_names( Zypper & zypper, const std::string & pattern_r, Match::Mode mode_r, const PoolQuery & query_r, PoolQueryResult & result_r )
+{
+  if ( mode_r == Match::OTHER )
+  {
+    if ( query_r.matchWord() )
+      return false;	// the query wraps the pattern in word boundaries
+    mode_r = query_r.matchMode();
+  }
+  if ( pattern_r.find( ':' ) != std::string::npos )
+    return false;	// explicit kind prefix, let the query handle it
+
+  std::vector<std::string> trigrams( trigram::required( pattern_r, mode_r ) );
+  if ( trigrams.empty() )
+    return false;
+
+  StrMatcher matcher( pattern_r, matchFlags( query_r, mode_r ) );
+  try
+  {
+    matcher.compile();
+  }
+  catch ( const MatchException & )
+  {
+    return false;	// the query will report the invalid pattern
+  }
+  searchRepos( zypper, query_r, "trigrams",
+	       [&trigrams]( const SolvableIndex & index_r ) { return allKeys( index_r, trigrams ); },
+	       [&matcher]( const sat::Solvable & solv_r ) { return matcher( solv_r.name() ); },
+	       result_r );
+  return true;
+}
+
+std::vector<std::string> similar_names( Zypper & zypper, const std::string & name_r, const PoolQuery & query_r, unsigned max_r )
+{
+  std::vector<std::string> ret;
+  if ( ! isAscii( name_r ) )
+    return ret;
+
+  unsigned maxDistance = trigram::typoDistance( name_r );
+  std::map<std::string,unsigned> distances;
+  PoolQueryResult found;
+  searchRepos( zypper, query_r, "trigrams",
+	       [&]( const SolvableIndex & index_r ) { return trigram::similar( index_r, name_r, maxDistance ); },
+	       [&]( const sat::Solvable & solv_r ) {
+		 std::string name( solv_r.name() );
+		 if ( name == name_r || distances.count( name ) )
+		   return false;
+		 unsigned distance = trigram::distance( name, name_r, maxDistance );
+		 if ( distance > maxDistance )
+		   return false;
+		 distances[name] = distance;
+		 return true;
+	       },
+	       found );
+
+  for ( const auto & el : distances )
+    ret.push_back( el.first );
+  std::stable_sort( ret.begin(), ret.end(), [&distances]( const std::string & lhs, const std::string & rhs ) {
+    return distances[lhs] < distances[rhs];
+  } );
+  if ( ret.size() > max_r )
+    ret.resize( max_r );
+  return ret;
+}
+
+bool search_files( Zypper & zypper, const std::string & pattern_r, Match::Mode mode_r, const PoolQuery & query_r, PoolQueryResult & result_r )
+{
+  if ( mode_r == Match::OTHER )
+  {
+    if ( query_r.matchWord() )
+      return false;	// the query wraps the pattern in word boundaries
+    mode_r = query_r.matchMode();
+  }
+  if ( pattern_r.empty() || ! isAscii( pattern_r ) )
+    return false;
+  if ( mode_r == Match::SUBSTRING )
+  {
+    if ( pattern_r[0] != '/' && pattern_r.find( '/' ) != std::string::npos )
+      return false;	// a relative path may start anywhere
+  }
+  else if ( mode_r != Match::STRING || pattern_r[0] != '/' )
+    return false;
+
+  std::string pattern( asciiLowered( pattern_r ) );
+  StrMatcher matcher( pattern_r, matchFlags( query_r, mode_r ) );
+  searchRepos( zypper, query_r, "files",
+	       [&pattern,mode_r]( const SolvableIndex & index_r ) { return fileCandidates( index_r, pattern, mode_r ); },
+	       [&matcher]( const sat::Solvable & solv_r ) {
+		 sat::LookupAttr files( sat::SolvAttr::filelist, solv_r );
+		 for_( it, files.begin(), files.end() )
+		 {
+		   if ( matcher( it.c_str() ) )
+		     return true;
+		 }
+		 return false;
+	       },
+	       result_r );
+  return true;
+}
+
+void build_search_indexes( Zypper & zypper, const sat::Repository & repo_r )
+{
+  if ( ! repo_r || geteuid() != 0 )
+    return;	// the solv cache belongs to root
+
+  std::vector<sat::Solvable> solvables( repoSolvables( repo_r ) );
+  buildRepoIndex( zypper, repo_r, solvables, "words", descriptionKeys );
+  buildRepoIndex( zypper, repo_r, solvables, "trigrams", nameKeys );
+  buildRepoIndex( zypper, repo_r, solvables, "files", fileKeys );
+}
@@ -0,0 +1,94 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file search-index.h
+ * Persistent per-repo indexes used by 'zypper search'.
+ */
+#ifndef ZYPPER_SEARCH_INDEX_H
+#define ZYPPER_SEARCH_INDEX_H
+
+#include <string>
+#include <vector>
+
+#include <zypp/PoolQuery.h>
+#include <zypp/PoolQueryResult.h>
+#include <zypp/sat/Repository.h>
+
+class Zypper;
+
+/**
+ * Add the solvables whose summary or description matches \a pattern_r
+ * to \a result_r, like adding \c SolvAttr::summary and \c SolvAttr::description
+ * with \c Match::OTHER to \a query_r would do. The repos, kinds, installed
+ * status, match mode and case sensitivity are taken from \a query_r.
+ *
+ * Each repo keeps an index of the words in its summaries and descriptions
+ * next to its solv file, valid as long as the solv file does not change
+ * (see \ref build_search_indexes). Only the solvables having all the words
+ * of \a pattern_r are actually matched. Repos without an up to date index
+ * (e.g. temporary repos) are scanned.
+ *
+ * \return \c false if the index can't be used for this \a pattern_r or
+ * match mode (e.g. \c Match::REGEX or \c PoolQuery::matchWord); \a result_r
+ * is unchanged then and \a query_r must do the search.
+ */
+bool search_descriptions( Zypper & zypper, const std::string & pattern_r, const zypp::PoolQuery & query_r, zypp::PoolQueryResult & result_r );
+
+/**
+ * Add the solvables whose name matches \a pattern_r in \a mode_r
+ * (\c Match::OTHER: the match mode of \a query_r) to \a result_r, like
+ * adding \c SolvAttr::name to \a query_r would do. The repos, kinds,
+ * installed status and case sensitivity are taken from \a query_r.
+ *
+ * Each repo keeps an index of the trigrams of its solvable names next to
+ * its solv file (see \ref search_descriptions). Only the solvables having
+ * all the trigrams the pattern requires are actually matched. This works
+ * for substrings, globs and regular expressions without groups or
+ * alternations.
+ *
+ * \return \c false if \a pattern_r does not require any trigram (e.g. it
+ * is too short) or \a query_r's \c matchWord applies; \a result_r is
+ * unchanged then and \a query_r must do the search.
+ */
+bool search_names( Zypper & zypper, const std::string & pattern_r, zypp::Match::Mode mode_r, const zypp::PoolQuery & query_r, zypp::PoolQueryResult & result_r );
+
+/**
+ * Add the solvables having a file whose full path matches \a pattern_r in
+ * \a mode_r (\c Match::OTHER: the match mode of \a query_r) to \a result_r,
+ * like adding \c SolvAttr::filelist to \a query_r would do.
+ *
+ * Each repo keeps an index of the basenames and directories of the files
+ * of its solvables next to its solv file (see \ref search_descriptions).
+ * Supported are exact absolute paths, absolute substrings (e.g. the
+ * \c /usr/bin/foo of <tt>zypper se --provides /usr/bin/foo</tt>), and
+ * substrings without any slash.
+ *
+ * \return \c false for other patterns and match modes; \a result_r is
+ * unchanged then and \a query_r must do the search.
+ */
+bool search_files( Zypper & zypper, const std::string & pattern_r, zypp::Match::Mode mode_r, const zypp::PoolQuery & query_r, zypp::PoolQueryResult & result_r );
+
+/**
+ * The names \a name_r may be a typo of: names within a small edit distance
+ * (see \ref trigram::typoDistance) of the solvables \a query_r looks at
+ * (repos, kinds and installed status), closest first. At most \a max_r
+ * names are returned; \a name_r itself is not.
+ *
+ * The candidates are looked up in the name trigram index of each repo
+ * (see \ref search_names).
+ */
+std::vector<std::string> similar_names( Zypper & zypper, const std::string & name_r, const zypp::PoolQuery & query_r, unsigned max_r = 3 );
+
+/**
+ * Build the indexes of \a repo_r used by \ref search_descriptions,
+ * \ref search_names and \ref search_files unless they are up to date.
+ * \a repo_r must be loaded into the pool. This is done by the refresh
+ * commands only, and only as root.
+ */
+void build_search_indexes( Zypper & zypper, const zypp::sat::Repository & repo_r );
+
+#endif // ZYPPER_SEARCH_INDEX_H
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <algorithm>
 
 #include <zypp/ZYpp.h> // for ResPool::instance()
 
@@ -18,6 +19,8 @@
 #include "utils/misc.h"
 #include "global-settings.h"
 
+#include "solve-commit.h"
+#include "utils/ListingCache.h"
 #include "search.h"
 
 extern ZYpp::Ptr God;
@@ -70,20 +73,25 @@ bool FillSearchTableSolvable::operator()( const PoolItem & pi_r ) const
   // That's why we can/must discard installed items, if an identical available
   // is present. Most probably done to get the correct repo. (but not efficient).
   // As we need the picklistPos anyway we can use it to dicard picklistNoPos ones.
+  ListingCache & cache( ListingCache::forPool() );
   ui::Selectable::Ptr sel { ui::Selectable::get( pi_r ) };
-  ui::Selectable::picklist_size_type picklistPos { sel->picklistPos( pi_r ) };
+  ui::Selectable::picklist_size_type picklistPos { cache.picklistPos( pi_r, sel ) };
 
   if ( picklistPos == ui::Selectable::picklistNoPos )
     return false;
 
+  // The solver is run only if the status of a patch, pattern or product is needed.
+  if ( traits::isPseudoInstalled( pi_r->kind() ) )
+    establishPPPStatus( Zypper::instance() );
+
   // On the fly filter unwanted according to _instNotinst
   const char *statusIndicator = nullptr;
   if ( indeterminate(_instNotinst)  )
-    statusIndicator = computeStatusIndicator( pi_r, sel );
+    statusIndicator = cache.statusIndicator( pi_r, sel );
   else
   {
     bool iType;
-    statusIndicator = computeStatusIndicator( pi_r, sel, &iType );
+    statusIndicator = cache.statusIndicator( pi_r, sel, &iType );
     if ( (bool)_instNotinst != iType )
       return false;
   }
@@ -97,7 +105,7 @@ bool FillSearchTableSolvable::operator()( const PoolItem & pi_r ) const
     << pi_r->arch().asString()
     << ( pi_r->isSystem()
        ? (std::string("(") + _("System Packages") + ")")
-       : pi_r->repository().asUserString() );
+       : cache.repoUserString( pi_r ) );
 
   row.userData( SolvableCSI(pi_r.satSolvable(), picklistPos) );
 
@@ -213,6 +221,10 @@ bool FillSearchTableSelectable::operator()( const ui::Selectable::constPtr & s )
   if ( s->kind() == ResKind::pattern && ! asKind<Pattern>(s->theObj())->userVisible() )
     return true;
 
+  // The solver is run only if the status of a patch, pattern or product is needed.
+  if ( traits::isPseudoInstalled( s->kind() ) )
+    establishPPPStatus( Zypper::instance() );
+
   // On the fly filter unwanted according to _instNotinst
   const char *statusIndicator = nullptr;
   if ( indeterminate(_instNotinst)  )
@@ -269,7 +281,7 @@ void list_patches( Zypper & zypper )
 
 static void list_patterns_xml( Zypper & zypper, SolvableFilterMode mode_r )
 {
-  cout << "<pattern-list>" << endl;
+  cout << "<pattern-list>\n";
 
   bool repofilter =  InitRepoSettings::instance()._repoFilter.size() ;	// suppress @System if repo filter is on
   bool installed_only = mode_r == SolvableFilterMode::ShowOnlyInstalled;
@@ -286,10 +298,10 @@ static void list_patterns_xml( Zypper & zypper, SolvableFilterMode mode_r )
       continue;
 
     Pattern::constPtr pattern = asKind<Pattern>(pi.resolvable());
-    cout << asXML( *pattern, isInstalled ) << endl;
+    cout << asXML( *pattern, isInstalled ) << '\n';
   }
 
-  cout << "</pattern-list>" << endl;
+  cout << "</pattern-list>\n";
 }
 
 static void list_pattern_table( Zypper & zypper, SolvableFilterMode mode_r )
@@ -376,7 +388,30 @@ void list_packages(Zypper & zypper , ListPackagesFlags flags_r )
 	  || ( unneeded && status_r.isUnneeded() ) );
   };
 
+  // display the result, even if --quiet specified
+  tbl << ( TableHeader()
+      // translators: S for installed Status
+      << N_("S")
+      << N_("Repository")
+      << N_("Name")
+      << table::EditionStyleSetter( tbl, N_("Version") )
+      << N_("Arch") );
+
+  // Sorted by name the selectables are visited in order and the rows are
+  // streamed; this is the stable sort of the rows by name.
+  bool sortByRepo = flags_r.testFlag( ListPackagesBits::SortByRepo );
+  std::vector<ui::Selectable::Ptr> selectables;
   for( const auto & sel : God->pool().proxy().byKind<Package>() )
+    selectables.push_back( sel );
+  if ( ! sortByRepo )
+  {
+    std::stable_sort( selectables.begin(), selectables.end(),
+		      []( const ui::Selectable::Ptr & lhs, const ui::Selectable::Ptr & rhs ) { return lhs->name() < rhs->name(); } );
+    tbl.streamTo( cout, Out::searchResultSample );
+  }
+
+  ListingCache & cache( ListingCache::forPool() );
+  for( const auto & sel : selectables )
   {
     // filter on selectable level
     // legacy: unlike 'search -i', 'packages -i' lists all versions (i and v) IFF hasInstalled
@@ -411,12 +446,12 @@ void list_packages(Zypper & zypper , ListPackagesFlags flags_r )
 	}
       }
 
-      const std::string & piRepoName( pi->repository().info().name() );
+      const std::string & piRepoName( cache.repoName( pi ) );
       if ( repofilter && piRepoName == "@System" )
 	continue;
 
       tbl << ( TableRow()
-	  << computeStatusIndicator( pi, sel )
+	  << cache.statusIndicator( pi, sel )
 	  << piRepoName
 	  << pi->name()
           << pi->edition().asString()
@@ -424,24 +459,17 @@ void list_packages(Zypper & zypper , ListPackagesFlags flags_r )
     }
   }
 
-  if ( tbl.empty() )
+  if ( ! sortByRepo )
+  {
+    tbl.endStream();
+    if ( ! tbl.streamedRows() )
+      zypper.out().info(_("No packages found.") );
+  }
+  else if ( tbl.empty() )
     zypper.out().info(_("No packages found.") );
   else
   {
-    // display the result, even if --quiet specified
-    tbl << ( TableHeader()
-	// translators: S for installed Status
-	<< N_("S")
-	<< N_("Repository")
-	<< N_("Name")
-	<< table::EditionStyleSetter( tbl, N_("Version") )
-	<< N_("Arch") );
-
-    if ( flags_r.testFlag( ListPackagesBits::SortByRepo ) )
-      tbl.sort( 1 ); // Repo
-    else
-      tbl.sort( 2 ); // Name
-
+    tbl.sort( 1 ); // Repo
     cout << tbl;
   }
 }
@@ -452,7 +480,7 @@ void list_products_xml( Zypper & zypper, SolvableFilterMode mode_r, const std::v
   bool installed_only = mode_r == SolvableFilterMode::ShowOnlyInstalled;
   bool notinst_only = mode_r == SolvableFilterMode::ShowOnlyNotInstalled;
 
-  cout << "<product-list>" << endl;
+  cout << "<product-list>\n";
   for ( const auto & pi : God->pool().byKind<Product>() )
   {
     if ( pi.status().isInstalled() && notinst_only )
@@ -462,9 +490,9 @@ void list_products_xml( Zypper & zypper, SolvableFilterMode mode_r, const std::v
     if ( repofilter && pi.repository().info().name() == "@System" )
       continue;
     Product::constPtr product = asKind<Product>(pi.resolvable());
-    cout << asXML( *product, pi.status().isInstalled(), fwdTags ) << endl;
+    cout << asXML( *product, pi.status().isInstalled(), fwdTags ) << '\n';
   }
-  cout << "</product-list>" << endl;
+  cout << "</product-list>\n";
 }
 
 void list_product_table(Zypper & zypper , SolvableFilterMode mode_r)
@@ -10,6 +10,9 @@
 
 #include <zypp/ZYppFactory.h>
 #include <zypp/base/Logger.h>
+#include <zypp/base/LogControl.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/sat/Pool.h>
 #include <zypp/TriBool.h>
 #include <zypp/FileChecker.h>
 #include <zypp/base/InputStream.h>
@@ -23,6 +26,7 @@
 #include "utils/misc.h"
 #include "utils/prompt.h"	// Continue? and solver problem prompt
 #include "utils/pager.h"	// to view the summary
+#include "utils/Timings.h"
 #include "global-settings.h"
 
 #include "solve-commit.h"
@@ -376,6 +380,19 @@ bool resolve( Zypper & zypper )
   return God->resolver()->resolvePool();
 }
 
+void establishPPPStatus( Zypper & zypper )
+{
+  static SerialNumberWatcher _poolSerial;
+  if ( ! _poolSerial.remember( sat::Pool::instance().serial().serial() ) )
+    return;	// done for this pool
+
+  // have REPOS and TARGET
+  MIL << "-------------- Calling SAT Solver to establish the PPP status -------------------" << endl;
+  base::LogControl::TmpLineWriter shutUp;	// reduce logging; some day libzypp/libsolv may offer a shotcut to establish
+  Timings::Phase phase( "resolve" );
+  resolve( zypper );
+}
+
 static bool verify( Zypper & zypper )
 {
   dump_pool();
@@ -573,17 +590,21 @@ void solve_and_commit (Zypper & zypper , Summary::ViewOptions summaryOptions_r,
       while ( true )
       {
         bool success;
-        if ( zypper.command() == ZypperCommand::VERIFY )
-          success = verify(zypper);
-        else if ( zypper.command() == ZypperCommand::DIST_UPGRADE )
         {
-          zypper.out().info(_("Computing distribution upgrade...") );
-          success = dist_upgrade(zypper);
-        }
-        else
-        {
-          zypper.out().info(_("Resolving package dependencies...") );
-          success = resolve( zypper );
+          // not including the problem prompts below
+          Timings::Phase phase( "resolve" );
+          if ( zypper.command() == ZypperCommand::VERIFY )
+            success = verify(zypper);
+          else if ( zypper.command() == ZypperCommand::DIST_UPGRADE )
+          {
+            zypper.out().info(_("Computing distribution upgrade...") );
+            success = dist_upgrade(zypper);
+          }
+          else
+          {
+            zypper.out().info(_("Resolving package dependencies...") );
+            success = resolve( zypper );
+          }
         }
 
         // go on, we've got solution or we don't want a solution (we want testcase)
@@ -609,6 +630,7 @@ void solve_and_commit (Zypper & zypper , Summary::ViewOptions summaryOptions_r,
 
     // SHOW SUMMARY
 
+    Timings::Phase summaryPhase( "summary" );
     Summary summary( God->pool(), summaryOptions_r );
 
     if ( zypper.out().verbosity() == Out::HIGH )
@@ -630,7 +652,7 @@ void solve_and_commit (Zypper & zypper , Summary::ViewOptions summaryOptions_r,
       summary.dumpAsXmlTo( cout );
     else
       summary.dumpTo( cout );
-
+    summaryPhase.end();
 
     if ( summary.packagesToGetAndInstall()
       || summary.packagesToRemove()
@@ -801,7 +823,10 @@ void solve_and_commit (Zypper & zypper , Summary::ViewOptions summaryOptions_r,
 	    zypper.out().info( s.str(), Out::HIGH );
 	  }
 
+          Timings::Phase commitPhase( "commit" );
           ZYppCommitResult result = God->commit( get_commit_policy( zypper, dlMode_r ) );
+          commitPhase.addBytes( summary.toDownload() );	// packages not yet in the cache
+          commitPhase.end();
           gData.show_media_progress_hack = false;
 	  gData.entered_commit = false;
 
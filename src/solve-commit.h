@@ -25,6 +25,13 @@
  */
 bool resolve(Zypper & zypper);
 
+/**
+ * Run the solver once to establish the status of patches, patterns and
+ * products. Does nothing if this was already done for the current pool
+ * content, so it can be called whenever the status is about to be shown.
+ */
+void establishPPPStatus( Zypper & zypper );
+
 
 /**
  * Defines the \ref solve_and_commit commit policy.
@@ -15,6 +15,7 @@
 #include "main.h"
 #include "global-settings.h"
 #include "utils/misc.h"
+#include "utils/ListingCache.h"
 
 using namespace zypp;
 typedef std::set<PoolItem> Candidates;
@@ -800,6 +801,7 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, b
     unsigned cols = th.cols();
 
     ResPoolProxy uipool( ResPool::instance().proxy() );
+    ListingCache & cache( ListingCache::forPool() );
 
     Candidates candidates;
     find_updates( *it, candidates, all_r );
@@ -807,9 +809,9 @@ void list_updates(Zypper & zypper, const ResKindSet & kinds, bool best_effort, b
     for ( const PoolItem & pi : candidates )
     {
       TableRow tr (cols);
-      tr << computeStatusIndicator( pi );
+      tr << cache.statusIndicator( pi );
       if (!hide_repo) {
-        tr << pi.repoInfo().asUserString();
+        tr << cache.repoUserString( pi );
       }
       tr << pi.name ();
 
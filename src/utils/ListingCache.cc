@@ -0,0 +1,93 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file ListingCache.cc
+ * Per pool values needed for each row of a solvable listing.
+ */
+#include <algorithm>
+
+#include <zypp/base/SerialNumber.h>
+#include <zypp/ResTraits.h>
+#include <zypp/sat/Pool.h>
+
+#include "utils/misc.h"
+#include "ListingCache.h"
+
+using namespace zypp;
+
+ListingCache & ListingCache::forPool()
+{
+  static ListingCache _cache;
+  static SerialNumberWatcher _poolSerial;
+
+  if ( _poolSerial.remember( sat::Pool::instance().serial().serial() ) )
+    _cache = ListingCache();
+  return _cache;
+}
+
+ListingCache::Entry & ListingCache::entry( const PoolItem & pi_r )
+{
+  sat::detail::SolvableIdType id( pi_r.satSolvable().id() );
+  if ( id >= _entries.size() )
+    _entries.resize( std::max<size_t>( id + 1, sat::Pool::instance().capacity() ) );
+  return _entries[id];
+}
+
+ListingCache::picklist_size_type ListingCache::picklistPos( const PoolItem & pi_r, ui::Selectable::constPtr sel_r )
+{
+  Entry & ret( entry( pi_r ) );
+  if ( ! ret.picklistPosKnown )
+  {
+    if ( ! sel_r )
+      sel_r = ui::Selectable::get( pi_r );
+    // remember the positions of all items in the picklist
+    picklist_size_type pos = 0;
+    if ( sel_r )
+    {
+      for ( const PoolItem & pi : sel_r->picklist() )
+      {
+	Entry & el( entry( pi ) );
+	el.picklistPos = pos++;
+	el.picklistPosKnown = true;
+      }
+    }
+    if ( ! ret.picklistPosKnown )
+    {
+      ret.picklistPos = ui::Selectable::picklistNoPos;
+      ret.picklistPosKnown = true;
+    }
+  }
+  return ret.picklistPos;
+}
+
+const char * ListingCache::statusIndicator( const PoolItem & pi_r, ui::Selectable::constPtr sel_r, bool * iType_r )
+{
+  if ( traits::isPseudoInstalled( pi_r->kind() ) )
+    return computeStatusIndicator( pi_r, sel_r, iType_r );	// solver dependent
+
+  Entry & ret( entry( pi_r ) );
+  if ( ! ret.statusIndicator )
+    ret.statusIndicator = computeStatusIndicator( pi_r, sel_r, &ret.iType );
+  if ( iType_r )
+    *iType_r = ret.iType;
+  return ret.statusIndicator;
+}
+
+const ListingCache::RepoStrings & ListingCache::repoStrings( const PoolItem & pi_r )
+{
+  Repository repo( pi_r.repository() );
+  auto it = _repos.find( repo.id() );
+  if ( it == _repos.end() )
+    it = _repos.insert( { repo.id(), RepoStrings { repo.asUserString(), repo.info().name() } } ).first;
+  return it->second;
+}
+
+const std::string & ListingCache::repoUserString( const PoolItem & pi_r )
+{ return repoStrings( pi_r ).userString; }
+
+const std::string & ListingCache::repoName( const PoolItem & pi_r )
+{ return repoStrings( pi_r ).name; }
@@ -0,0 +1,91 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file ListingCache.h
+ * Per pool values needed for each row of a solvable listing.
+ */
+#ifndef ZYPPER_UTILS_LISTINGCACHE_H
+#define ZYPPER_UTILS_LISTINGCACHE_H
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <zypp/PoolItem.h>
+#include <zypp/ui/Selectable.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class ListingCache
+/// \brief Values needed for each row of a solvable listing.
+///
+/// Listings like 'search --details', 'packages' or 'list-updates' need
+/// the picklist position, the status indicator and the repository label
+/// of each item. Computed per row, \c Selectable::picklistPos walks the
+/// picklist and the repository label is looked up in the repo info again
+/// and again. Here a picklist is walked once for all its items and each
+/// value is computed once per pool.
+///
+/// The status of patches, patterns and products depends on the solver
+/// and is not cached.
+///
+/// \code
+///   ListingCache & cache( ListingCache::forPool() );
+///   if ( cache.picklistPos( pi ) != ui::Selectable::picklistNoPos )
+///     row << cache.statusIndicator( pi ) << cache.repoUserString( pi );
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class ListingCache
+{
+public:
+  typedef zypp::ui::Selectable::picklist_size_type picklist_size_type;
+
+  /** The cache for the current pool. Reset when the pool content changes. */
+  static ListingCache & forPool();
+
+  /** Like \c Selectable::picklistPos: \a pi_r's position in its selectable's
+   * picklist or \c Selectable::picklistNoPos. Pass \a sel_r if you have it.
+   */
+  picklist_size_type picklistPos( const zypp::PoolItem & pi_r, zypp::ui::Selectable::constPtr sel_r = nullptr );
+
+  /** Like \ref computeStatusIndicator, optionally telling whether \a pi_r
+   * is treated as (i)nstalled. Pass \a sel_r if you have it.
+   */
+  const char * statusIndicator( const zypp::PoolItem & pi_r, zypp::ui::Selectable::constPtr sel_r = nullptr, bool * iType_r = nullptr );
+
+  /** \overload */
+  const char * statusIndicator( const zypp::PoolItem & pi_r, bool * iType_r )
+  { return statusIndicator( pi_r, nullptr, iType_r ); }
+
+  /** \c Repository::asUserString of \a pi_r's repository. */
+  const std::string & repoUserString( const zypp::PoolItem & pi_r );
+
+  /** \c RepoInfo::name of \a pi_r's repository. */
+  const std::string & repoName( const zypp::PoolItem & pi_r );
+
+private:
+  struct Entry
+  {
+    picklist_size_type picklistPos = 0;
+    const char * statusIndicator = nullptr;	//!< nullptr: not yet computed
+    bool picklistPosKnown = false;
+    bool iType = false;
+  };
+
+  struct RepoStrings
+  {
+    std::string userString;
+    std::string name;
+  };
+
+  Entry & entry( const zypp::PoolItem & pi_r );
+  const RepoStrings & repoStrings( const zypp::PoolItem & pi_r );
+
+  std::vector<Entry> _entries;	//!< by solvable id
+  std::unordered_map<zypp::sat::detail::RepoIdType, RepoStrings> _repos;
+};
+
+#endif // ZYPPER_UTILS_LISTINGCACHE_H
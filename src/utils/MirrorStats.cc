@@ -0,0 +1,153 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file MirrorStats.cc
+ * Persistent latency and failure statistics of repository baseurls.
+ */
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/String.h>
+#include <zypp/PathInfo.h>
+
+#include "MirrorStats.h"
+
+using namespace zypp;
+using std::endl;
+
+MirrorStats::MirrorStats( Pathname file_r )
+: _file( std::move(file_r) )
+{
+  std::ifstream in( _file.c_str() );
+  if ( ! in )
+    return;
+
+  // <lastCheck> <latency> <failures> <url>
+  std::string line;
+  while ( std::getline( in, line ) )
+  {
+    std::istringstream fields( line );
+    Date::ValueType lastCheck = 0;
+    Entry entry;
+    std::string url;
+    if ( fields >> lastCheck >> entry.latency >> entry.failures >> url )
+    {
+      entry.lastCheck = Date( lastCheck );
+      _entries[url] = entry;
+    }
+    else if ( ! str::trim( line ).empty() )
+      WAR << _file << ": ignore malformed line '" << line << "'" << endl;
+  }
+  DBG << "Read " << _entries.size() << " mirror stats from " << _file << endl;
+}
+
+const MirrorStats::Entry * MirrorStats::find( const Url & url_r ) const
+{
+  auto it = _entries.find( key( url_r ) );
+  return it == _entries.end() ? nullptr : &it->second;
+}
+
+void MirrorStats::recordSuccess( const Url & url_r, unsigned latency_r )
+{
+  auto res = _entries.insert( std::make_pair( key( url_r ), Entry() ) );
+  Entry & entry( res.first->second );
+  if ( res.second || entry.failures )
+    entry.latency = latency_r;
+  else
+    entry.latency = ( 3 * entry.latency + latency_r ) / 4;	// smooth out single outliers
+  entry.failures = 0;
+  entry.lastCheck = Date::now();
+  _dirty = true;
+}
+
+void MirrorStats::recordFailure( const Url & url_r )
+{
+  Entry & entry( _entries[key( url_r )] );
+  ++entry.failures;
+  entry.lastCheck = Date::now();
+  _dirty = true;
+}
+
+void MirrorStats::recordLowerBound( const Url & url_r, unsigned latency_r )
+{
+  Entry & entry( _entries[key( url_r )] );
+  entry.latency = std::max( entry.latency, latency_r );
+  entry.lastCheck = Date::now();
+  _dirty = true;
+}
+
+std::vector<Url> MirrorStats::ranked( std::vector<Url> urls_r ) const
+{
+  // (class, latency): 0 working, 1 unknown, 2.. failing
+  auto rank = [this]( const Url & url_r ) -> std::pair<unsigned,unsigned> {
+    const Entry * entry = find( url_r );
+    if ( ! entry )
+      return { 1, 0 };
+    if ( entry->failures )
+      return { 1 + entry->failures, entry->latency };
+    return { 0, entry->latency };
+  };
+
+  std::stable_sort( urls_r.begin(), urls_r.end(), [&rank]( const Url & lhs, const Url & rhs ) {
+    return rank( lhs ) < rank( rhs );
+  } );
+  return urls_r;
+}
+
+bool MirrorStats::needsProbe( const std::vector<Url> & urls_r, Date::Duration maxAge_r ) const
+{
+  if ( urls_r.empty() )
+    return false;
+
+  for ( const Url & url : urls_r )
+  {
+    if ( ! find( url ) )
+      return true;
+  }
+
+  const Entry & best( *find( ranked( urls_r ).front() ) );
+  return best.failures || Date::now() - best.lastCheck > maxAge_r;
+}
+
+bool MirrorStats::save()
+{
+  if ( ! _dirty )
+    return true;
+
+  if ( filesystem::assert_dir( _file.dirname() ) != 0 )
+  {
+    WAR << "Can't create " << _file.dirname() << " to save mirror stats" << endl;
+    return false;
+  }
+
+  Pathname tmp( _file.extend( ".new" ) );
+  {
+    std::ofstream out( tmp.c_str() );
+    for ( const auto & el : _entries )
+    {
+      const Entry & entry( el.second );
+      out << Date::ValueType(entry.lastCheck) << " " << entry.latency << " " << entry.failures << " " << el.first << endl;
+    }
+    if ( ! out )
+    {
+      WAR << "Can't write mirror stats to " << tmp << endl;
+      filesystem::unlink( tmp );
+      return false;
+    }
+  }
+
+  if ( filesystem::rename( tmp, _file ) != 0 )
+  {
+    WAR << "Can't save mirror stats to " << _file << endl;
+    filesystem::unlink( tmp );
+    return false;
+  }
+  _dirty = false;
+  return true;
+}
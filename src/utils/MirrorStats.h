@@ -0,0 +1,90 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file MirrorStats.h
+ * Persistent latency and failure statistics of repository baseurls.
+ */
+#ifndef ZYPPER_UTILS_MIRRORSTATS_H
+#define ZYPPER_UTILS_MIRRORSTATS_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <zypp/Url.h>
+#include <zypp/Date.h>
+#include <zypp/Pathname.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class MirrorStats
+/// \brief Remember how fast the baseurls of a repo responded.
+///
+/// For each url the smoothed response time of its metadata check, the
+/// number of consecutive failures and the time of the last check are
+/// stored in a small text file (one url per line). \ref ranked orders a
+/// repos baseurls, so the fastest working mirror is tried first.
+///
+/// Urls are stored without password. Nothing is written unless
+/// statistics changed.
+///////////////////////////////////////////////////////////////////
+class MirrorStats
+{
+public:
+  /** Statistics of a single url. */
+  struct Entry
+  {
+    unsigned latency = 0;	///< smoothed response time in ms
+    unsigned failures = 0;	///< consecutive failures
+    zypp::Date lastCheck;	///< when the url was last checked
+  };
+
+public:
+  /** Ctor, loading the statistics from \a file_r (if it exists). */
+  explicit MirrorStats( zypp::Pathname file_r );
+
+  /** The file the statistics are loaded from and saved to. */
+  const zypp::Pathname & file() const
+  { return _file; }
+
+  /** Statistics of \a url_r or \c nullptr if unknown. */
+  const Entry * find( const zypp::Url & url_r ) const;
+
+  /** \a url_r responded after \a latency_r ms. */
+  void recordSuccess( const zypp::Url & url_r, unsigned latency_r );
+
+  /** \a url_r failed. */
+  void recordFailure( const zypp::Url & url_r );
+
+  /** \a url_r did not respond within \a latency_r ms (e.g. lost a race). */
+  void recordLowerBound( const zypp::Url & url_r, unsigned latency_r );
+
+  /** \a urls_r reordered: working urls by latency, then unknown ones, then failing ones.
+   * Urls ranking equal keep their original order.
+   */
+  std::vector<zypp::Url> ranked( std::vector<zypp::Url> urls_r ) const;
+
+  /** Whether \a urls_r should be probed again because some of them are
+   * unknown, or the preferred one was not checked within \a maxAge_r or
+   * failed.
+   */
+  bool needsProbe( const std::vector<zypp::Url> & urls_r, zypp::Date::Duration maxAge_r = zypp::Date::day ) const;
+
+  /** Write the statistics back to \ref file if they changed.
+   * \return \c false if writing failed.
+   */
+  bool save();
+
+private:
+  static std::string key( const zypp::Url & url_r )
+  { return url_r.asString(); }
+
+  zypp::Pathname _file;
+  std::map<std::string,Entry> _entries;
+  bool _dirty = false;
+};
+
+#endif // ZYPPER_UTILS_MIRRORSTATS_H
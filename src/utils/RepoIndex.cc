@@ -0,0 +1,135 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file RepoIndex.cc
+ * Lookup of repositories by number, alias, name or URL.
+ */
+#include <algorithm>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/Easy.h>
+#include <zypp/base/String.h>
+#include <zypp/Pathname.h>
+
+#include "RepoIndex.h"
+
+using namespace zypp;
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  enum UrlViewBits
+  {
+    LOOSE_QUERY	= 1,	///< ignore the query string
+    LOOSE_AUTH	= 2,	///< ignore username and password
+  };
+
+  /** The repo number \a spec_r denotes (1-based) or 0. */
+  unsigned repoNumber( const std::string & spec_r )
+  {
+    if ( spec_r.empty() || spec_r.size() > 9 || spec_r.find_first_not_of( "0123456789" ) != std::string::npos )
+      return 0;
+    return str::strtonum<unsigned>( spec_r );
+  }
+
+  /** Remember the first (lowest) index for \a key_r. */
+  inline void addFirst( std::unordered_map<std::string,unsigned> & table_r, const std::string & key_r, unsigned idx_r )
+  { table_r.insert( std::make_pair( key_r, idx_r ) ); }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+void RepoIndex::init()
+{
+  for ( unsigned idx = 0; idx < _repos.size(); ++idx )
+  {
+    addFirst( _byAlias, _repos[idx].alias(), idx );
+    addFirst( _byName, _repos[idx].name(), idx );
+  }
+  _byUrl.resize( ( LOOSE_QUERY|LOOSE_AUTH ) + 1 );
+  DBG << "Indexed " << _repos.size() << " repos" << endl;
+}
+
+std::string RepoIndex::urlKey( Url url_r, unsigned view_r )
+{
+  // repo urls are expected to be directories, so a trailing slash
+  // does not matter (bnc #585082)
+  url_r.setPathName( Pathname( url_r.getPathName() ).asString() );
+
+  if ( ! view_r )
+    return url_r.asCompleteString();
+
+  url::ViewOption urlview = url::ViewOption::DEFAULTS + url::ViewOption::WITH_PASSWORD;
+  if ( view_r & LOOSE_AUTH )
+    urlview = urlview - url::ViewOptions::WITH_PASSWORD - url::ViewOptions::WITH_USERNAME;
+  if ( view_r & LOOSE_QUERY )
+    urlview = urlview - url::ViewOptions::WITH_QUERY_STR;
+  return url_r.asString( urlview );
+}
+
+const RepoIndex::Table & RepoIndex::urlTable( unsigned view_r ) const
+{
+  Table & table( _byUrl[view_r] );
+  if ( ! ( _urlViews & ( 1 << view_r ) ) )
+  {
+    _urlViews |= ( 1 << view_r );
+    for ( unsigned idx = 0; idx < _repos.size(); ++idx )
+    {
+      const RepoInfo & repo( _repos[idx] );
+      for_( urlit, repo.baseUrlsBegin(), repo.baseUrlsEnd() )
+      {
+	try
+	{ addFirst( table, urlKey( *urlit, view_r ), idx ); }
+	catch ( const url::UrlException & ) {}
+      }
+    }
+    DBG << "Indexed " << table.size() << " repo urls (view " << view_r << ")" << endl;
+  }
+  return table;
+}
+
+const RepoInfo * RepoIndex::find( const std::string & spec_r, bool looseQuery_r, bool looseAuth_r ) const
+{
+  // Alias, number or name; the first repo matching any of them wins.
+  // Name can be ambiguous, in which case the first match is returned.
+  unsigned best = _repos.size();
+  {
+    unsigned number = repoNumber( spec_r );
+    if ( number && number <= _repos.size() )
+      best = number - 1;
+
+    auto it = _byAlias.find( spec_r );
+    if ( it != _byAlias.end() )
+      best = std::min( best, it->second );
+
+    it = _byName.find( spec_r );
+    if ( it != _byName.end() )
+      best = std::min( best, it->second );
+  }
+  if ( best < _repos.size() )
+    return &_repos[best];
+
+  // URL only if the above did not find anything.
+  try
+  {
+    Url url( spec_r );	// no need to continue if spec_r is no Url.
+    unsigned view = ( looseQuery_r ? LOOSE_QUERY : 0 ) | ( looseAuth_r ? LOOSE_AUTH : 0 );
+    const Table & table( urlTable( view ) );
+    auto it = table.find( urlKey( url, view ) );
+    if ( it != table.end() )
+      return &_repos[it->second];
+  }
+  catch ( const url::UrlException & ) {}
+
+  return nullptr;
+}
+
+const RepoInfo * RepoIndex::findAlias( const std::string & alias_r ) const
+{
+  auto it = _byAlias.find( alias_r );
+  return it == _byAlias.end() ? nullptr : &_repos[it->second];
+}
@@ -0,0 +1,67 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file RepoIndex.h
+ * Lookup of repositories by number, alias, name or URL.
+ */
+#ifndef ZYPPER_UTILS_REPOINDEX_H
+#define ZYPPER_UTILS_REPOINDEX_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include <zypp/RepoInfo.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class RepoIndex
+/// \brief Resolve repo specs given on the command line in constant time.
+///
+/// Built once from the known repos (in \c RepoManager order, which also
+/// defines the repo numbers). A spec matches the first repo whose number,
+/// alias or name equals the spec. Otherwise, if the spec is an URL, the
+/// first repo having a matching baseurl. Trailing slashes of URL paths are
+/// ignored. The URL tables for the loose comparisons (without query string
+/// and/or credentials) are built on first use.
+///
+/// The index holds copies of the repos, so it must be rebuilt whenever
+/// repos are added, removed or modified.
+///////////////////////////////////////////////////////////////////
+class RepoIndex
+{
+public:
+  /** Ctor indexing the repos in [\a begin_r, \a end_r). */
+  template <class Iterator>
+  RepoIndex( Iterator begin_r, Iterator end_r )
+  : _repos( begin_r, end_r )
+  { init(); }
+
+  /** The number of indexed repos. */
+  unsigned size() const
+  { return _repos.size(); }
+
+  /** The repo matching \a spec_r or \c nullptr. */
+  const zypp::RepoInfo * find( const std::string & spec_r, bool looseQuery_r = false, bool looseAuth_r = false ) const;
+
+  /** The repo with alias \a alias_r or \c nullptr. */
+  const zypp::RepoInfo * findAlias( const std::string & alias_r ) const;
+
+private:
+  typedef std::unordered_map<std::string,unsigned> Table;
+
+  void init();
+  const Table & urlTable( unsigned view_r ) const;
+  static std::string urlKey( zypp::Url url_r, unsigned view_r );
+
+  std::vector<zypp::RepoInfo> _repos;
+  Table _byAlias;
+  Table _byName;
+  mutable std::vector<Table> _byUrl;	///< per URL view, built on demand
+  mutable unsigned _urlViews = 0;	///< bit set of the URL views built
+};
+
+#endif // ZYPPER_UTILS_REPOINDEX_H
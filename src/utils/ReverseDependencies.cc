@@ -0,0 +1,161 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file ReverseDependencies.cc
+ * Index of the solvables depending on a solvable.
+ */
+#include <algorithm>
+#include <map>
+#include <memory>
+
+#include <zypp/base/Easy.h>
+#include <zypp/base/Logger.h>
+#include <zypp/base/SerialNumber.h>
+#include <zypp/ZConfig.h>
+#include <zypp/sat/Pool.h>
+#include <zypp/sat/WhatProvides.h>
+
+#include "ReverseDependencies.h"
+
+// libzypp logger settings
+#undef  ZYPP_BASE_LOGGER_LOGGROUP
+#define ZYPP_BASE_LOGGER_LOGGROUP "zypper"
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** The \ref Dep stored in \a attr_r. */
+  bool depFor( const sat::SolvAttr & attr_r, Dep & dep_r )
+  {
+    static const std::vector<std::pair<sat::SolvAttr,Dep>> deps {
+      { sat::SolvAttr::provides,	Dep::PROVIDES },
+      { sat::SolvAttr::requires,	Dep::REQUIRES },
+      { sat::SolvAttr::conflicts,	Dep::CONFLICTS },
+      { sat::SolvAttr::obsoletes,	Dep::OBSOLETES },
+      { sat::SolvAttr::recommends,	Dep::RECOMMENDS },
+      { sat::SolvAttr::suggests,	Dep::SUGGESTS },
+      { sat::SolvAttr::supplements,	Dep::SUPPLEMENTS },
+      { sat::SolvAttr::enhances,	Dep::ENHANCES },
+    };
+    for ( const auto & el : deps )
+    {
+      if ( el.first == attr_r )
+      {
+	dep_r = el.second;
+	return true;
+      }
+    }
+    return false;
+  }
+
+  /** Whether \c sat::Pool::whatMatchesSolvable would consider \a slv_r:
+   * installed, or installable on this system.
+   */
+  inline bool considered( const sat::Solvable & slv_r )
+  {
+    if ( slv_r.isSystem() )
+      return true;
+    return ! slv_r.isKind( ResKind::srcpackage )
+        && slv_r.arch().compatibleWith( ZConfig::instance().systemArchitecture() );
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+const ReverseDependencies & ReverseDependencies::forPool( const sat::SolvAttr & attr_r )
+{
+  static std::map<sat::SolvAttr, std::unique_ptr<ReverseDependencies>> _indexes;
+  static SerialNumberWatcher _poolSerial;
+
+  if ( _poolSerial.remember( sat::Pool::instance().serial().serial() ) )
+    _indexes.clear();
+
+  std::unique_ptr<ReverseDependencies> & index( _indexes[attr_r] );
+  if ( ! index )
+    index.reset( new ReverseDependencies( attr_r ) );
+  return *index;
+}
+
+ReverseDependencies::ReverseDependencies( const sat::SolvAttr & attr_r )
+: _attr( attr_r )
+{
+  Dep dep( Dep::REQUIRES );
+  if ( ! depFor( attr_r, dep ) )
+  {
+    WAR << "Not a dependency: " << attr_r << endl;
+    return;
+  }
+
+  // (provider, entry) for each matched dependency, in order of the dependents
+  sat::Pool pool( sat::Pool::instance() );
+  std::vector<std::pair<sat::detail::SolvableIdType,Entry>> edges;
+  for_( it, pool.solvablesBegin(), pool.solvablesEnd() )
+  {
+    const sat::Solvable & dependent( *it );
+    if ( ! considered( dependent ) )
+      continue;
+
+    for ( const Capability & cap : dependent.dep( dep ) )
+    {
+      for ( const sat::Solvable & provider : sat::WhatProvides( cap ) )
+      {
+	if ( provider != dependent )
+	  edges.push_back( { provider.id(), Entry { dependent, cap } } );
+      }
+    }
+  }
+
+  // counting sort by provider, keeping the order of the dependents
+  _offsets.assign( pool.capacity() + 1, 0 );
+  for ( const auto & edge : edges )
+    ++_offsets[edge.first + 1];
+  for ( unsigned idx = 1; idx < _offsets.size(); ++idx )
+    _offsets[idx] += _offsets[idx - 1];
+
+  std::vector<unsigned> next( _offsets.begin(), _offsets.end() - 1 );
+  _entries.resize( edges.size() );
+  for ( const auto & edge : edges )
+    _entries[next[edge.first]++] = edge.second;
+
+  MIL << "Reverse " << attr_r << " index: " << _entries.size() << " dependencies of " << pool.capacity() << " solvables" << endl;
+}
+
+void ReverseDependencies::dependents( const std::vector<sat::Solvable> & providers_r, DependentsMap & result_r, bool withCaps_r ) const
+{
+  for ( const sat::Solvable & provider : providers_r )
+  {
+    forEachDependent( provider, [&]( const sat::Solvable & dependent_r, const Capability & cap_r ) {
+      CapabilitySet & caps( result_r[dependent_r] );
+      if ( withCaps_r )
+	caps.insert( cap_r );
+    } );
+  }
+}
+
+std::vector<sat::Solvable> ReverseDependencies::transitiveDependents( const std::vector<sat::Solvable> & providers_r ) const
+{
+  std::vector<sat::Solvable> ret;
+  std::vector<bool> seen( _offsets.size(), false );
+
+  std::vector<sat::Solvable> todo( providers_r );
+  while ( ! todo.empty() )
+  {
+    sat::Solvable provider( todo.back() );
+    todo.pop_back();
+    forEachDependent( provider, [&]( const sat::Solvable & dependent_r, const Capability & ) {
+      if ( ! seen[dependent_r.id()] )
+      {
+	seen[dependent_r.id()] = true;
+	ret.push_back( dependent_r );
+	todo.push_back( dependent_r );
+      }
+    } );
+  }
+  std::sort( ret.begin(), ret.end(), []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); } );
+  return ret;
+}
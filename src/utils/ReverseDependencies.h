@@ -0,0 +1,91 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file ReverseDependencies.h
+ * Index of the solvables depending on a solvable.
+ */
+#ifndef ZYPPER_UTILS_REVERSEDEPENDENCIES_H
+#define ZYPPER_UTILS_REVERSEDEPENDENCIES_H
+
+#include <unordered_map>
+#include <vector>
+
+#include <zypp/Capability.h>
+#include <zypp/sat/Solvable.h>
+#include <zypp/sat/SolvAttr.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class ReverseDependencies
+/// \brief Index of the solvables depending on a solvable.
+///
+/// For one kind of dependency (e.g. \c SolvAttr::requires) the index
+/// tells for each solvable in the pool which other solvables have a
+/// dependency of this kind matched by its provides, like
+/// \c sat::Pool::whatMatchesSolvable does, together with the matched
+/// capabilities. Instead of scanning the pool for each solvable, the
+/// pool is scanned once when the index is built.
+///
+/// \code
+///   const ReverseDependencies & revdeps( ReverseDependencies::forPool( sat::SolvAttr::requires ) );
+///   revdeps.forEachDependent( slv, []( sat::Solvable dependent_r, Capability cap_r ) { ... } );
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class ReverseDependencies
+{
+public:
+  typedef std::unordered_map<zypp::sat::Solvable, zypp::CapabilitySet> DependentsMap;
+
+  /** The index of \a attr_r for the current pool.
+   * Built on first use and rebuilt when the pool content changes.
+   */
+  static const ReverseDependencies & forPool( const zypp::sat::SolvAttr & attr_r );
+
+  /** Build the index of the dependencies \a attr_r (\c SolvAttr::requires, ...) in the current pool. */
+  explicit ReverseDependencies( const zypp::sat::SolvAttr & attr_r );
+
+  /** The kind of dependency indexed. */
+  const zypp::sat::SolvAttr & attr() const
+  { return _attr; }
+
+  /** Call \a fnc_r( sat::Solvable dependent, Capability cap ) for each
+   * dependency \a cap of a solvable matched by \a provider_r.
+   * A dependent having more than one matched dependency is passed once
+   * per capability.
+   */
+  template <class TFnc>
+  void forEachDependent( const zypp::sat::Solvable & provider_r, TFnc fnc_r ) const
+  {
+    if ( provider_r.id() + 1 >= _offsets.size() )
+      return;
+    for ( unsigned idx = _offsets[provider_r.id()]; idx < _offsets[provider_r.id() + 1]; ++idx )
+      fnc_r( _entries[idx].dependent, _entries[idx].cap );
+  }
+
+  /** Add the dependents of all \a providers_r to \a result_r, along with
+   * the matched capabilities if \a withCaps_r.
+   */
+  void dependents( const std::vector<zypp::sat::Solvable> & providers_r, DependentsMap & result_r, bool withCaps_r = true ) const;
+
+  /** All solvables ultimately depending on \a providers_r: their dependents,
+   * the dependents of those and so on. A provider is part of the result
+   * only if it depends on another one (e.g. a dependency cycle).
+   */
+  std::vector<zypp::sat::Solvable> transitiveDependents( const std::vector<zypp::sat::Solvable> & providers_r ) const;
+
+private:
+  struct Entry
+  {
+    zypp::sat::Solvable dependent;
+    zypp::Capability cap;
+  };
+
+  zypp::sat::SolvAttr _attr;
+  std::vector<unsigned> _offsets;	//!< entries of solvable id N: [_offsets[N], _offsets[N+1])
+  std::vector<Entry> _entries;
+};
+
+#endif // ZYPPER_UTILS_REVERSEDEPENDENCIES_H
@@ -0,0 +1,259 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file SolvableIndex.cc
+ * On-disk inverted index: key -> solvables of a repository.
+ */
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include <algorithm>
+#include <fstream>
+
+#include <zypp/base/Logger.h>
+#include <zypp/PathInfo.h>
+
+#include "SolvableIndex.h"
+
+using namespace zypp;
+using std::endl;
+
+/** File header; followed by the cookie, the \ref Key table, the key strings and the postings. */
+struct SolvableIndex::Header
+{
+  char		magic[8];
+  uint32_t	cookieSize;
+  uint32_t	solvables;
+  uint32_t	keys;
+  uint32_t	reserved;
+  uint64_t	keysOff;
+  uint64_t	stringsOff;
+  uint64_t	stringsSize;
+  uint64_t	postingsOff;
+  uint64_t	postingsCount;
+};
+
+/** Entry of the sorted key table. */
+struct SolvableIndex::Key
+{
+  uint32_t	str;	///< offset in the strings area
+  uint32_t	len;	///< length of the key
+  uint32_t	post;	///< index of the first posting
+  uint32_t	count;	///< number of postings
+};
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  const char indexMagic[8] = { 'Z', 'Y', 'P', 'I', 'D', 'X', '\0', '\1' };
+
+  inline uint64_t align( uint64_t off_r, uint64_t to_r )
+  { return ( off_r + to_r - 1 ) / to_r * to_r; }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+void SolvableIndex::Builder::add( const std::string & key_r, Offset offset_r )
+{
+  std::vector<Offset> & postings( _postings[key_r] );
+  if ( postings.empty() || postings.back() < offset_r )
+    postings.push_back( offset_r );
+  else if ( ! std::binary_search( postings.begin(), postings.end(), offset_r ) )
+    postings.insert( std::lower_bound( postings.begin(), postings.end(), offset_r ), offset_r );
+}
+
+bool SolvableIndex::Builder::save( const Pathname & file_r, const std::string & cookie_r, unsigned solvables_r ) const
+{
+  Header header;
+  ::memset( &header, 0, sizeof(header) );
+  ::memcpy( header.magic, indexMagic, sizeof(header.magic) );
+  header.cookieSize = cookie_r.size();
+  header.solvables = solvables_r;
+  header.keys = _postings.size();
+
+  std::vector<Key> keys;
+  keys.reserve( _postings.size() );
+  std::string strings;
+  uint64_t postingsCount = 0;
+  for ( const auto & el : _postings )
+  {
+    Key key;
+    key.str = strings.size();
+    key.len = el.first.size();
+    key.post = postingsCount;
+    key.count = el.second.size();
+    keys.push_back( key );
+    strings += el.first;
+    postingsCount += el.second.size();
+  }
+
+  header.keysOff = align( sizeof(Header) + cookie_r.size(), 8 );
+  header.stringsOff = header.keysOff + keys.size() * sizeof(Key);
+  header.stringsSize = strings.size();
+  header.postingsOff = align( header.stringsOff + strings.size(), sizeof(Offset) );
+  header.postingsCount = postingsCount;
+
+  if ( filesystem::assert_dir( file_r.dirname() ) != 0 )
+  {
+    WAR << "Can't create " << file_r.dirname() << " to save index" << endl;
+    return false;
+  }
+
+  Pathname tmp( file_r.extend( ".new" ) );
+  {
+    std::ofstream out( tmp.c_str(), std::ios::binary );
+    const std::string pad( 8, '\0' );
+    out.write( reinterpret_cast<const char *>(&header), sizeof(header) );
+    out.write( cookie_r.data(), cookie_r.size() );
+    out.write( pad.data(), header.keysOff - sizeof(header) - cookie_r.size() );
+    out.write( reinterpret_cast<const char *>(keys.data()), keys.size() * sizeof(Key) );
+    out.write( strings.data(), strings.size() );
+    out.write( pad.data(), header.postingsOff - header.stringsOff - strings.size() );
+    for ( const auto & el : _postings )
+      out.write( reinterpret_cast<const char *>(el.second.data()), el.second.size() * sizeof(Offset) );
+    if ( ! out )
+    {
+      WAR << "Can't write index " << tmp << endl;
+      filesystem::unlink( tmp );
+      return false;
+    }
+  }
+  if ( filesystem::rename( tmp, file_r ) != 0 )
+  {
+    WAR << "Can't save index " << file_r << endl;
+    filesystem::unlink( tmp );
+    return false;
+  }
+  MIL << "Saved index " << file_r << ": " << keys.size() << " keys, " << postingsCount << " postings" << endl;
+  return true;
+}
+
+std::unique_ptr<SolvableIndex> SolvableIndex::load( const Pathname & file_r, const std::string & cookie_r )
+{
+  std::unique_ptr<SolvableIndex> ret;
+
+  int fd = ::open( file_r.c_str(), O_RDONLY | O_CLOEXEC );
+  if ( fd < 0 )
+    return ret;
+
+  struct stat st;
+  if ( ::fstat( fd, &st ) == 0 && size_t(st.st_size) >= sizeof(Header) )
+  {
+    void * data = ::mmap( nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    if ( data != MAP_FAILED )
+    {
+      ret.reset( new SolvableIndex( data, st.st_size ) );
+      if ( ! ret->valid( cookie_r ) )
+      {
+	DBG << "Ignore outdated or corrupt index " << file_r << endl;
+	ret.reset();
+      }
+    }
+  }
+  ::close( fd );
+  return ret;
+}
+
+SolvableIndex::SolvableIndex( const void * data_r, size_t size_r )
+: _data( static_cast<const char *>(data_r) )
+, _size( size_r )
+{}
+
+SolvableIndex::~SolvableIndex()
+{ ::munmap( const_cast<char *>(_data), _size ); }
+
+bool SolvableIndex::valid( const std::string & cookie_r ) const
+{
+  const Header & header( *reinterpret_cast<const Header *>(_data) );
+  if ( ::memcmp( header.magic, indexMagic, sizeof(header.magic) ) != 0 )
+    return false;
+  if ( sizeof(Header) + header.cookieSize > _size
+    || std::string( _data + sizeof(Header), header.cookieSize ) != cookie_r )
+    return false;
+
+  if ( header.keysOff % 8 || header.postingsOff % sizeof(Offset)
+    || header.keysOff + uint64_t(header.keys) * sizeof(Key) > header.stringsOff
+    || header.stringsOff + header.stringsSize > header.postingsOff
+    || header.postingsOff + header.postingsCount * sizeof(Offset) > _size )
+    return false;
+
+  const Key * keys = reinterpret_cast<const Key *>(_data + header.keysOff);
+  for ( unsigned i = 0; i < header.keys; ++i )
+  {
+    if ( uint64_t(keys[i].str) + keys[i].len > header.stringsSize
+      || uint64_t(keys[i].post) + keys[i].count > header.postingsCount )
+      return false;
+  }
+  return true;
+}
+
+unsigned SolvableIndex::solvableCount() const
+{ return reinterpret_cast<const Header *>(_data)->solvables; }
+
+unsigned SolvableIndex::keyCount() const
+{ return reinterpret_cast<const Header *>(_data)->keys; }
+
+boost::string_ref SolvableIndex::keyAt( unsigned idx_r ) const
+{
+  const Header & header( *reinterpret_cast<const Header *>(_data) );
+  const Key & key( reinterpret_cast<const Key *>(_data + header.keysOff)[idx_r] );
+  return boost::string_ref( _data + header.stringsOff + key.str, key.len );
+}
+
+SolvableIndex::Postings SolvableIndex::postingsAt( unsigned idx_r ) const
+{
+  const Header & header( *reinterpret_cast<const Header *>(_data) );
+  const Key & key( reinterpret_cast<const Key *>(_data + header.keysOff)[idx_r] );
+  Postings ret;
+  ret._begin = reinterpret_cast<const Offset *>(_data + header.postingsOff) + key.post;
+  ret._end = ret._begin + key.count;
+  return ret;
+}
+
+SolvableIndex::Postings SolvableIndex::find( boost::string_ref key_r ) const
+{
+  unsigned idx = lowerBound( key_r );
+  if ( idx < keyCount() && keyAt( idx ) == key_r )
+    return postingsAt( idx );
+  return Postings();
+}
+
+void SolvableIndex::forEachKey( const std::function<void( boost::string_ref key_r, const Postings & postings_r )> & fnc_r ) const
+{
+  for ( unsigned i = 0, keys = keyCount(); i < keys; ++i )
+    fnc_r( keyAt( i ), postingsAt( i ) );
+}
+
+void SolvableIndex::forEachKey( boost::string_ref prefix_r, const std::function<void( boost::string_ref key_r, const Postings & postings_r )> & fnc_r ) const
+{
+  for ( unsigned idx = lowerBound( prefix_r ), keys = keyCount(); idx < keys && keyAt( idx ).starts_with( prefix_r ); ++idx )
+    fnc_r( keyAt( idx ), postingsAt( idx ) );
+}
+
+void SolvableIndex::findPrefix( boost::string_ref prefix_r, std::vector<Offset> & result_r ) const
+{
+  forEachKey( prefix_r, [&result_r]( boost::string_ref, const Postings & postings_r ) {
+    result_r.insert( result_r.end(), postings_r.begin(), postings_r.end() );
+  } );
+}
+
+unsigned SolvableIndex::lowerBound( boost::string_ref key_r ) const
+{
+  unsigned lo = 0;
+  unsigned hi = keyCount();
+  while ( lo < hi )
+  {
+    unsigned mid = lo + ( hi - lo ) / 2;
+    if ( keyAt( mid ).compare( key_r ) < 0 )
+      lo = mid + 1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
@@ -0,0 +1,128 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file SolvableIndex.h
+ * On-disk inverted index: key -> solvables of a repository.
+ */
+#ifndef ZYPPER_UTILS_SOLVABLEINDEX_H
+#define ZYPPER_UTILS_SOLVABLEINDEX_H
+
+#include <stdint.h>
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/Pathname.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class SolvableIndex
+/// \brief Read-only inverted index mapping string keys to solvables.
+///
+/// Solvables are denoted by their position within the repository
+/// (in order of iteration), so the index is independent of the pool a
+/// repo is loaded into. It is only valid for the very solv file it was
+/// built from, which is what the \a cookie passed to \ref load and
+/// \ref Builder::save is for.
+///
+/// The file is mapped into memory; keys are sorted, so exact lookups are
+/// a binary search and nothing needs to be parsed when loading.
+///
+/// \code
+///   SolvableIndex::Builder builder;
+///   builder.add( "word", 0 );
+///   builder.save( file, cookie, 1 );
+///   std::unique_ptr<SolvableIndex> index( SolvableIndex::load( file, cookie ) );
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class SolvableIndex : private zypp::base::NonCopyable
+{
+public:
+  /** Position of a solvable within its repository. */
+  typedef uint32_t Offset;
+
+  /** Sorted, unique offsets of a key. */
+  struct Postings
+  {
+    const Offset * begin() const	{ return _begin; }
+    const Offset * end() const		{ return _end; }
+    bool empty() const			{ return _begin == _end; }
+    unsigned size() const		{ return _end - _begin; }
+
+    const Offset * _begin = nullptr;
+    const Offset * _end = nullptr;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class SolvableIndex::Builder
+  /// \brief Collect keys and write the index file.
+  ///////////////////////////////////////////////////////////////////
+  class Builder
+  {
+  public:
+    /** Solvable \a offset_r has \a key_r. Offsets should be added in ascending order. */
+    void add( const std::string & key_r, Offset offset_r );
+
+    /** The number of distinct keys. */
+    unsigned size() const
+    { return _postings.size(); }
+
+    /** Write the index to \a file_r (atomically).
+     * \return \c false if writing failed.
+     */
+    bool save( const zypp::Pathname & file_r, const std::string & cookie_r, unsigned solvables_r ) const;
+
+  private:
+    std::map<std::string,std::vector<Offset>> _postings;
+  };
+
+public:
+  /** Map the index in \a file_r if it exists and was built for \a cookie_r.
+   * \return \c nullptr if the file is missing, outdated or corrupt.
+   */
+  static std::unique_ptr<SolvableIndex> load( const zypp::Pathname & file_r, const std::string & cookie_r );
+
+  ~SolvableIndex();
+
+  /** The number of solvables the repo had when the index was built. */
+  unsigned solvableCount() const;
+
+  /** The number of distinct keys. */
+  unsigned keyCount() const;
+
+  /** The offsets of solvables having \a key_r (empty if none). */
+  Postings find( boost::string_ref key_r ) const;
+
+  /** Invoke \a fnc_r for all keys (in sorted order). */
+  void forEachKey( const std::function<void( boost::string_ref key_r, const Postings & postings_r )> & fnc_r ) const;
+
+  /** Invoke \a fnc_r for all keys starting with \a prefix_r (in sorted order). */
+  void forEachKey( boost::string_ref prefix_r, const std::function<void( boost::string_ref key_r, const Postings & postings_r )> & fnc_r ) const;
+
+  /** The offsets of solvables having any key starting with \a prefix_r, appended to \a result_r. */
+  void findPrefix( boost::string_ref prefix_r, std::vector<Offset> & result_r ) const;
+
+private:
+  struct Header;
+  struct Key;
+
+  SolvableIndex( const void * data_r, size_t size_r );
+  bool valid( const std::string & cookie_r ) const;
+  unsigned lowerBound( boost::string_ref key_r ) const;
+  boost::string_ref keyAt( unsigned idx_r ) const;
+  Postings postingsAt( unsigned idx_r ) const;
+
+  const char * _data;
+  size_t _size;
+};
+
+#endif // ZYPPER_UTILS_SOLVABLEINDEX_H
@@ -0,0 +1,181 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file Timings.cc
+ * Per-phase wall time, transfer and memory instrumentation (--timings).
+ */
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include <zypp/base/Logger.h>
+
+#include "Timings.h"
+
+using namespace zypp;
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** \a str_r as JSON string literal. */
+  std::string jsonString( const std::string & str_r )
+  {
+    std::string ret( "\"" );
+    for ( unsigned char ch : str_r )
+    {
+      switch ( ch )
+      {
+	case '"':  ret += "\\\""; break;
+	case '\\': ret += "\\\\"; break;
+	case '\n': ret += "\\n"; break;
+	case '\t': ret += "\\t"; break;
+	default:
+	  if ( ch < 0x20 )
+	  {
+	    char buf[8];
+	    ::snprintf( buf, sizeof(buf), "\\u%04x", ch );
+	    ret += buf;
+	  }
+	  else
+	    ret += ch;
+      }
+    }
+    return ret += "\"";
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+Timings::Phase::Phase( std::string name_r, std::string detail_r )
+{
+  Timings & timings( Timings::instance() );
+  if ( ! timings._enabled )
+    return;
+
+  Record record;
+  record.name = std::move(name_r);
+  record.detail = std::move(detail_r);
+  record.depth = timings._depth++;
+  record.start = timings.now();
+  record.rssStart = rss();
+  _idx = timings._records.size();
+  timings._records.push_back( std::move(record) );
+}
+
+void Timings::Phase::end()
+{
+  if ( _idx < 0 )
+    return;
+  unsigned idx = _idx;
+  _idx = -1;
+
+  Timings & timings( Timings::instance() );
+  if ( timings._depth )
+    --timings._depth;
+  if ( idx >= timings._records.size() )
+    return;	// cleared meanwhile
+
+  Record & record( timings._records[idx] );
+  record.duration = timings.now() - record.start;
+  record.rssDelta = rss() - record.rssStart;
+  record.processPeakRss = peakRss();
+  DBG << "Phase " << record.name << " " << record.detail << ": " << record.duration / 1000 << "ms" << endl;
+}
+
+void Timings::Phase::addBytes( ByteCount bytes_r )
+{
+  Timings & timings( Timings::instance() );
+  if ( _idx >= 0 && unsigned(_idx) < timings._records.size() )
+  {
+    ByteCount & bytes( timings._records[_idx].bytes );
+    bytes = ByteCount( ByteCount::SizeType(bytes) + ByteCount::SizeType(bytes_r) );
+  }
+}
+
+Timings & Timings::instance()
+{
+  static Timings _instance;
+  return _instance;
+}
+
+void Timings::enable()
+{
+  _enabled = true;
+  _base = Clock::now();
+  MIL << "Recording phase timings" << endl;
+}
+
+long long Timings::now() const
+{ return std::chrono::duration_cast<std::chrono::microseconds>( Clock::now() - _base ).count(); }
+
+long Timings::rss()
+{
+  long pages = 0;
+  FILE * statm = ::fopen( "/proc/self/statm", "r" );
+  if ( ! statm )
+    return 0;
+  if ( ::fscanf( statm, "%*ld %ld", &pages ) != 1 )
+    pages = 0;
+  ::fclose( statm );
+  return pages * ( ::sysconf( _SC_PAGESIZE ) / 1024 );
+}
+
+long Timings::peakRss()
+{
+  struct rusage usage;
+  if ( ::getrusage( RUSAGE_SELF, &usage ) != 0 )
+    return 0;
+  return usage.ru_maxrss;	// KiB on Linux
+}
+
+std::ostream & Timings::dumpTraceTo( std::ostream & str, const std::string & command_r ) const
+{
+  long long end = now();
+  pid_t pid = ::getpid();
+
+  str << "{\"displayTimeUnit\":\"ms\",";
+  str << "\"otherData\":{\"command\":" << jsonString( command_r ) << "},";
+  str << "\"traceEvents\":[";
+  const char * sep = "";
+  for ( const Record & record : _records )
+  {
+    // complete events; a phase still running lasts until now
+    str << sep << endl
+	<< "{\"name\":" << jsonString( record.name ) << ",\"cat\":\"zypper\",\"ph\":\"X\""
+	<< ",\"ts\":" << record.start
+	<< ",\"dur\":" << ( record.duration < 0 ? end - record.start : record.duration )
+	<< ",\"pid\":" << pid << ",\"tid\":" << pid
+	<< ",\"args\":{";
+    if ( ! record.detail.empty() )
+      str << "\"detail\":" << jsonString( record.detail ) << ",";
+    str << "\"bytes\":" << ByteCount::SizeType(record.bytes)
+	<< ",\"rss_delta_kib\":" << ( record.duration < 0 ? rss() - record.rssStart : record.rssDelta )
+	<< ",\"process_peak_rss_kib\":" << ( record.duration < 0 ? peakRss() : record.processPeakRss )
+	<< "}}";
+    sep = ",";
+  }
+  return str << endl << "]}" << endl;
+}
+
+bool Timings::writeTrace( const std::string & command_r ) const
+{
+  if ( _traceFile.empty() )
+    return true;
+
+  std::ofstream out( _traceFile.c_str() );
+  dumpTraceTo( out, command_r );
+  if ( ! out )
+  {
+    WAR << "Can't write timings trace to " << _traceFile << endl;
+    return false;
+  }
+  MIL << "Timings trace written to " << _traceFile << endl;
+  return true;
+}
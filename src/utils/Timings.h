@@ -0,0 +1,137 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file Timings.h
+ * Per-phase wall time, transfer and memory instrumentation (--timings).
+ */
+#ifndef ZYPPER_UTILS_TIMINGS_H
+#define ZYPPER_UTILS_TIMINGS_H
+
+#include <chrono>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <zypp/base/NonCopyable.h>
+#include <zypp/ByteCount.h>
+#include <zypp/Pathname.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class Timings
+/// \brief Collects the duration of the phases of a zypper run.
+///
+/// Phases are recorded by placing a \ref Timings::Phase on the stack.
+/// Phases may nest (e.g. the refresh of a single repo within \c init_repos).
+/// Nothing is recorded unless \ref enable was called, so a disabled
+/// \ref Timings::Phase costs just a flag check.
+///
+/// Besides the wall time each record holds the number of bytes the phase
+/// reported to have transferred, how much the RSS grew during the phase and
+/// the peak RSS of the whole process so far when the phase ended. The records can be written as Chrome trace event JSON
+/// (load it in \c chrome://tracing or Perfetto).
+///
+/// \code
+///   {
+///     Timings::Phase phase( "download", repo.alias() );
+///     ...
+///     phase.addBytes( size );
+///   }
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class Timings : private zypp::base::NonCopyable
+{
+public:
+  typedef std::chrono::steady_clock Clock;
+
+  /** A finished (or still running) phase. */
+  struct Record
+  {
+    std::string name;		///< the phase
+    std::string detail;		///< what the phase worked on (e.g. repo alias)
+    unsigned depth = 0;		///< nesting level (0: toplevel)
+    long long start = 0;	///< us since \ref enable
+    long long duration = -1;	///< us; -1 while the phase is running
+    zypp::ByteCount bytes;	///< transferred bytes reported by the phase
+    long rssStart = 0;		///< resident set size in KiB at the start of the phase
+    long rssDelta = 0;		///< RSS growth in KiB during the phase (may be negative)
+    long processPeakRss = 0;	///< peak RSS of the process in KiB when the phase ended (not per phase)
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class Timings::Phase
+  /// \brief Records the scope it lives in as a phase.
+  ///////////////////////////////////////////////////////////////////
+  class Phase : private zypp::base::NonCopyable
+  {
+  public:
+    explicit Phase( std::string name_r, std::string detail_r = std::string() );
+    ~Phase()
+    { end(); }
+
+    /** Account \a bytes_r transferred by this phase. */
+    void addBytes( zypp::ByteCount bytes_r );
+
+    /** End the phase before the scope is left. */
+    void end();
+
+  private:
+    int _idx = -1;
+  };
+
+public:
+  /** The global instance. */
+  static Timings & instance();
+
+  /** Whether phases are recorded. */
+  bool enabled() const
+  { return _enabled; }
+
+  /** Start recording; the time base is reset. */
+  void enable();
+
+  /** Where to write the trace file (empty: none). */
+  const zypp::Pathname & traceFile() const
+  { return _traceFile; }
+
+  void setTraceFile( zypp::Pathname file_r )
+  { _traceFile = std::move(file_r); }
+
+  /** The recorded phases in order of their start. */
+  const std::vector<Record> & records() const
+  { return _records; }
+
+  /** Forget all recorded phases (the time base is kept). */
+  void clear()
+  { _records.clear(); _depth = 0; }
+
+  /** Write the records as Chrome trace event JSON to \a str. */
+  std::ostream & dumpTraceTo( std::ostream & str, const std::string & command_r = std::string() ) const;
+
+  /** Write the records to \ref traceFile.
+   * \return \c false if writing failed.
+   */
+  bool writeTrace( const std::string & command_r = std::string() ) const;
+
+  /** The current RSS of this process in KiB. */
+  static long rss();
+
+  /** The peak RSS this process had so far in KiB. */
+  static long peakRss();
+
+private:
+  Timings() {}
+
+  long long now() const;
+
+  bool _enabled = false;
+  Clock::time_point _base;
+  unsigned _depth = 0;
+  std::vector<Record> _records;
+  zypp::Pathname _traceFile;
+};
+
+#endif // ZYPPER_UTILS_TIMINGS_H
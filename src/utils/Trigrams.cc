@@ -0,0 +1,252 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file Trigrams.cc
+ * Trigrams of strings and the trigrams required by search patterns.
+ */
+#include <algorithm>
+
+#include "Trigrams.h"
+
+using namespace zypp;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  inline char asciiLower( char ch )
+  { return ( ch >= 'A' && ch <= 'Z' ) ? ch + ( 'a' - 'A' ) : ch; }
+
+  inline bool isAsciiAlnum( char ch )
+  { return ( ch >= 'a' && ch <= 'z' ) || ( ch >= 'A' && ch <= 'Z' ) || ( ch >= '0' && ch <= '9' ); }
+
+  /** Position of the ']' closing the bracket expression starting at \a pos_r or \c npos. */
+  std::string::size_type bracketEnd( const std::string & pattern_r, std::string::size_type pos_r )
+  {
+    ++pos_r;
+    if ( pos_r < pattern_r.size() && ( pattern_r[pos_r] == '!' || pattern_r[pos_r] == '^' ) )
+      ++pos_r;
+    if ( pos_r < pattern_r.size() && pattern_r[pos_r] == ']' )
+      ++pos_r;	// a leading ']' is part of the set
+    return pattern_r.find( ']', pos_r );
+  }
+
+  /** Literal parts of a \c Match::GLOB pattern. */
+  bool globFragments( const std::string & pattern_r, std::vector<std::string> & fragments_r )
+  {
+    std::string current;
+    for ( std::string::size_type pos = 0; pos < pattern_r.size(); ++pos )
+    {
+      char ch = pattern_r[pos];
+      if ( ch == '*' || ch == '?' )
+      {
+	fragments_r.push_back( std::move(current) );
+	current.clear();
+      }
+      else if ( ch == '[' )
+      {
+	pos = bracketEnd( pattern_r, pos );
+	if ( pos == std::string::npos )
+	  return false;
+	fragments_r.push_back( std::move(current) );
+	current.clear();
+      }
+      else if ( ch == '\\' && pos + 1 < pattern_r.size() )
+	current += pattern_r[++pos];
+      else
+	current += ch;
+    }
+    fragments_r.push_back( std::move(current) );
+    return true;
+  }
+
+  /** Literal parts of a \c Match::REGEX (POSIX extended) pattern without groups and alternation. */
+  bool regexFragments( const std::string & pattern_r, std::vector<std::string> & fragments_r )
+  {
+    std::string current;
+    auto flush = [&]() {
+      fragments_r.push_back( std::move(current) );
+      current.clear();
+    };
+
+    for ( std::string::size_type pos = 0; pos < pattern_r.size(); ++pos )
+    {
+      char ch = pattern_r[pos];
+      switch ( ch )
+      {
+	case '(':
+	case ')':
+	case '|':
+	  return false;
+
+	case '?':
+	case '*':
+	case '{':
+	  // the preceding char is optional (an interval may start at 0)
+	  if ( ! current.empty() )
+	    current.erase( current.size() - 1 );
+	  flush();
+	  if ( ch == '{' )
+	  {
+	    pos = pattern_r.find( '}', pos );
+	    if ( pos == std::string::npos )
+	      return false;
+	  }
+	  break;
+
+	case '+':
+	case '.':
+	case '^':
+	case '$':
+	  flush();
+	  break;
+
+	case '[':
+	  pos = bracketEnd( pattern_r, pos );
+	  if ( pos == std::string::npos )
+	    return false;
+	  flush();
+	  break;
+
+	case '\\':
+	  if ( pos + 1 == pattern_r.size() )
+	    return false;
+	  ch = pattern_r[++pos];
+	  if ( isAsciiAlnum( ch ) )
+	    flush();	// \w, \b, \1 ...
+	  else
+	    current += ch;
+	  break;
+
+	default:
+	  current += ch;
+	  break;
+      }
+    }
+    flush();
+    return true;
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+namespace trigram
+{
+  void split( boost::string_ref text_r, std::vector<std::string> & result_r )
+  {
+    if ( text_r.size() < 3 )
+      return;
+
+    std::vector<std::string> trigrams;
+    trigrams.reserve( text_r.size() - 2 );
+    for ( std::string::size_type pos = 0; pos + 3 <= text_r.size(); ++pos )
+    {
+      std::string trigram( text_r.data() + pos, 3 );
+      for ( char & ch : trigram )
+	ch = asciiLower( ch );
+      trigrams.push_back( std::move(trigram) );
+    }
+    std::sort( trigrams.begin(), trigrams.end() );
+    trigrams.erase( std::unique( trigrams.begin(), trigrams.end() ), trigrams.end() );
+    result_r.insert( result_r.end(), trigrams.begin(), trigrams.end() );
+  }
+
+  std::vector<std::string> required( const std::string & pattern_r, Match::Mode mode_r )
+  {
+    std::vector<std::string> ret;
+    for ( char ch : pattern_r )
+    {
+      if ( static_cast<unsigned char>(ch) >= 0x80 )
+	return ret;	// we don't know how the matcher folds the case
+    }
+
+    std::vector<std::string> fragments;
+    switch ( mode_r )
+    {
+      case Match::SUBSTRING:
+      case Match::STRING:
+	fragments.push_back( pattern_r );
+	break;
+      case Match::GLOB:
+	if ( ! globFragments( pattern_r, fragments ) )
+	  return ret;
+	break;
+      case Match::REGEX:
+	if ( ! regexFragments( pattern_r, fragments ) )
+	  return ret;
+	break;
+      default:
+	return ret;
+    }
+
+    for ( const std::string & fragment : fragments )
+      split( fragment, ret );
+    std::sort( ret.begin(), ret.end() );
+    ret.erase( std::unique( ret.begin(), ret.end() ), ret.end() );
+    return ret;
+  }
+
+  unsigned distance( boost::string_ref lhs_r, boost::string_ref rhs_r, unsigned max_r )
+  {
+    unsigned lsize = lhs_r.size();
+    unsigned rsize = rhs_r.size();
+    if ( ( lsize > rsize ? lsize - rsize : rsize - lsize ) > max_r )
+      return max_r + 1;
+
+    // optimal string alignment; three rows of the matrix
+    std::vector<unsigned> prev2( rsize + 1 );
+    std::vector<unsigned> prev( rsize + 1 );
+    std::vector<unsigned> curr( rsize + 1 );
+    for ( unsigned j = 0; j <= rsize; ++j )
+      prev[j] = j;
+
+    for ( unsigned i = 1; i <= lsize; ++i )
+    {
+      curr[0] = i;
+      unsigned rowMin = curr[0];
+      char lch = asciiLower( lhs_r[i-1] );
+      for ( unsigned j = 1; j <= rsize; ++j )
+      {
+	char rch = asciiLower( rhs_r[j-1] );
+	unsigned cost = ( lch == rch ? 0 : 1 );
+	curr[j] = std::min( { prev[j] + 1, curr[j-1] + 1, prev[j-1] + cost } );
+	if ( i > 1 && j > 1 && lch == asciiLower( rhs_r[j-2] ) && asciiLower( lhs_r[i-2] ) == rch )
+	  curr[j] = std::min( curr[j], prev2[j-2] + 1 );
+	rowMin = std::min( rowMin, curr[j] );
+      }
+      if ( rowMin > max_r )
+	return max_r + 1;	// the distance can't get lower
+      prev2.swap( prev );
+      prev.swap( curr );
+    }
+    return std::min( prev[rsize], max_r + 1 );
+  }
+
+  unsigned typoDistance( boost::string_ref word_r )
+  { return word_r.size() <= 5 ? 1 : 2; }
+
+  std::vector<SolvableIndex::Offset> similar( const SolvableIndex & index_r, const std::string & word_r, unsigned distance_r )
+  {
+    std::vector<SolvableIndex::Offset> ret;
+    std::vector<std::string> trigrams;
+    split( word_r, trigrams );
+    if ( trigrams.empty() )
+      return ret;
+
+    // an edit touches at most 4 trigrams (a transposition)
+    unsigned minShared = ( trigrams.size() > 4 * distance_r ? trigrams.size() - 4 * distance_r : 1 );
+    std::vector<unsigned> shared( index_r.solvableCount(), 0 );
+    for ( const std::string & trigram : trigrams )
+    {
+      for ( SolvableIndex::Offset offset : index_r.find( trigram ) )
+      {
+	if ( offset < shared.size() && ++shared[offset] == minShared )
+	  ret.push_back( offset );
+      }
+    }
+    std::sort( ret.begin(), ret.end() );
+    return ret;
+  }
+} // namespace trigram
@@ -0,0 +1,72 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file Trigrams.h
+ * Trigrams of strings and the trigrams required by search patterns.
+ */
+#ifndef ZYPPER_UTILS_TRIGRAMS_H
+#define ZYPPER_UTILS_TRIGRAMS_H
+
+#include <string>
+#include <vector>
+
+#include <boost/utility/string_ref.hpp>
+
+#include <zypp/base/StrMatcher.h>
+
+#include "SolvableIndex.h"
+
+///////////////////////////////////////////////////////////////////
+/// Trigrams are the substrings of length 3 of a string, ASCII
+/// letters lowercased. A string can only match a pattern if it
+/// contains all the trigrams of the literal parts the pattern
+/// requires, so an index of the trigrams of all strings narrows
+/// the candidates which must be checked by the real matcher.
+///////////////////////////////////////////////////////////////////
+namespace trigram
+{
+  /** Append the (unique) trigrams of \a text_r to \a result_r. */
+  void split( boost::string_ref text_r, std::vector<std::string> & result_r );
+
+  /** The trigrams any string matching \a pattern_r in \a mode_r must contain.
+   *
+   * Literal parts of \c Match::SUBSTRING, \c Match::STRING and
+   * \c Match::GLOB patterns are taken as they are. \c Match::REGEX
+   * patterns are supported as long as they don't use grouping or
+   * alternation; characters made optional by a quantifier are dropped.
+   *
+   * \return An empty vector if the pattern does not require any trigram
+   * (too short, unsupported syntax, non-ASCII characters, other modes).
+   */
+  std::vector<std::string> required( const std::string & pattern_r, zypp::Match::Mode mode_r );
+
+  /** \name Typos
+   * A string within an edit distance \c d of a word shares all but at most
+   * <tt>4*d</tt> of its trigrams, so a trigram index also finds the strings
+   * a misspelled word was meant to be.
+   */
+  //@{
+  /** The edit distance of \a lhs_r and \a rhs_r (ASCII letters compared
+   * case-insensitive; insertions, deletions, substitutions and transpositions
+   * of adjacent characters count 1), or \a max_r + 1 if it exceeds \a max_r.
+   */
+  unsigned distance( boost::string_ref lhs_r, boost::string_ref rhs_r, unsigned max_r );
+
+  /** The edit distance up to which a string is taken as typo of \a word_r:
+   * 1 for words of up to 5 characters, 2 for longer ones.
+   */
+  unsigned typoDistance( boost::string_ref word_r );
+
+  /** The offsets in the trigram \a index_r (keys built by \ref split)
+   * sharing enough trigrams with \a word_r to be within \a distance_r of
+   * it (but at least one). The candidates must be checked by \ref distance.
+   */
+  std::vector<SolvableIndex::Offset> similar( const SolvableIndex & index_r, const std::string & word_r, unsigned distance_r );
+  //@}
+} // namespace trigram
+
+#endif // ZYPPER_UTILS_TRIGRAMS_H
@@ -0,0 +1,262 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file WorkerPool.cc
+ * Run independent jobs concurrently in forked worker processes.
+ */
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <errno.h>
+#include <string.h>
+
+#include <cstdio>
+#include <iostream>
+
+#include <zypp/base/Logger.h>
+#include <zypp/base/Exception.h>
+
+#include "WorkerPool.h"
+
+using std::endl;
+
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  /** In a worker: set by SIGTERM, see \ref WorkerPool::terminating. */
+  volatile sig_atomic_t _terminating = 0;
+
+  void sigterm_handler( int )
+  { _terminating = 1; }
+
+  /** A running worker process. */
+  struct Worker
+  {
+    unsigned idx = 0;	///< index of the job
+    pid_t pid = -1;
+    int fd = -1;	///< read end of the result pipe
+  };
+
+  /** Executed in the child: run the job, send the payload and never return. */
+  void runInChild( const WorkerPool::Job & job_r, int fd_r )
+  {
+    ::signal( SIGINT, SIG_DFL );
+    ::signal( SIGTERM, sigterm_handler );	// the job may return early and clean up
+    ::signal( SIGPIPE, SIG_DFL );
+
+    int devnull = ::open( "/dev/null", O_RDWR );
+    if ( devnull >= 0 )
+    {
+      ::dup2( devnull, STDIN_FILENO );
+      ::dup2( devnull, STDOUT_FILENO );
+      ::dup2( devnull, STDERR_FILENO );
+      if ( devnull > STDERR_FILENO )
+	::close( devnull );
+    }
+
+    int status = 127;
+    std::string data;
+    try
+    {
+      status = job_r( data );
+    }
+    catch ( const zypp::Exception & excpt )
+    {
+      ZYPP_CAUGHT( excpt );
+      data = excpt.asUserString();
+    }
+    catch ( ... )
+    {
+      ERR << "Worker " << ::getpid() << " caught unknown exception" << endl;
+    }
+
+    for ( const char * p = data.c_str(), * e = p + data.size(); p < e; )
+    {
+      ssize_t n = ::write( fd_r, p, e - p );
+      if ( n < 0 )
+      {
+	if ( errno == EINTR )
+	  continue;
+	break;
+      }
+      p += n;
+    }
+    ::close( fd_r );
+    ::_exit( status & 0x7f );
+  }
+
+  /** Wait for the worker and remember its exit status. */
+  void reap( const Worker & worker_r, WorkerPool::Result & result_r )
+  {
+    int status = 0;
+    pid_t ret = -1;
+    while ( (ret = ::waitpid( worker_r.pid, &status, 0 )) < 0 && errno == EINTR )
+    {;} // just loop
+
+    if ( ret != worker_r.pid )
+    {
+      ERR << "waitpid for worker " << worker_r.pid << " failed (" << ::strerror(errno) << ")" << endl;
+      result_r.status = -1;
+    }
+    else if ( WIFEXITED(status) )
+    {
+      result_r.status = WEXITSTATUS(status);
+    }
+    else
+    {
+      WAR << "Worker " << worker_r.pid << " did not exit normally (" << status << ")" << endl;
+      result_r.status = -1;
+    }
+    DBG << "Worker " << worker_r.pid << " job " << worker_r.idx << " done: " << result_r.status << endl;
+  }
+
+  /** Wait for a worker asked to stop; kill it if it takes longer than \a graceMs_r. */
+  void reapTerminated( const Worker & worker_r, WorkerPool::Result & result_r, unsigned graceMs_r )
+  {
+    for ( unsigned waited = 0; waited < graceMs_r; waited += 10 )
+    {
+      int status = 0;
+      pid_t ret = ::waitpid( worker_r.pid, &status, WNOHANG );
+      if ( ret == worker_r.pid || ( ret < 0 && errno != EINTR ) )
+	return;
+      ::usleep( 10 * 1000 );
+    }
+    WAR << "Worker " << worker_r.pid << " did not stop within " << graceMs_r << "ms, killing it" << endl;
+    ::kill( worker_r.pid, SIGKILL );
+    reap( worker_r, result_r );
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
+WorkerPool::WorkerPool( unsigned maxJobs_r )
+: _maxJobs( maxJobs_r ? maxJobs_r : 1 )
+{}
+
+bool WorkerPool::terminating()
+{ return _terminating; }
+
+std::vector<WorkerPool::Result> WorkerPool::run( DoneCallback done_r )
+{
+  std::vector<Job> jobs;
+  jobs.swap( _jobs );
+
+  std::vector<Result> results( jobs.size() );
+  std::vector<Worker> running;
+  unsigned next = 0;
+  _canceled = false;	// a reused pool starts afresh
+  _terminate = false;
+
+  MIL << "Running " << jobs.size() << " jobs in up to " << _maxJobs << " workers" << endl;
+  while ( next < jobs.size() || ! running.empty() )
+  {
+    if ( _canceled && next < jobs.size() )
+    {
+      MIL << "Canceled: dropping " << jobs.size() - next << " queued jobs" << endl;
+      next = jobs.size();
+    }
+    if ( _canceled && _terminate )
+    {
+      MIL << "Canceled: terminating " << running.size() << " workers" << endl;
+      for ( const Worker & worker : running )
+	::kill( worker.pid, SIGTERM );
+      for ( const Worker & worker : running )
+      {
+	reapTerminated( worker, results[worker.idx], terminateGraceMs );
+	::close( worker.fd );
+	results[worker.idx].status = -1;
+      }
+      break;
+    }
+
+    // start workers until the limit is reached
+    while ( next < jobs.size() && running.size() < _maxJobs )
+    {
+      Worker worker;
+      worker.idx = next++;
+
+      int fds[2];
+      if ( ::pipe( fds ) != 0 )
+      {
+	ERR << "pipe for job " << worker.idx << " failed (" << ::strerror(errno) << ")" << endl;
+	if ( done_r ) done_r( worker.idx, results[worker.idx] );
+	continue;
+      }
+
+      // avoid duplicating buffered output in the child
+      std::cout.flush();
+      std::cerr.flush();
+      ::fflush( nullptr );
+
+      worker.pid = ::fork();
+      if ( worker.pid == 0 )
+      {
+	::close( fds[0] );
+	for ( const Worker & sibling : running )
+	  ::close( sibling.fd );
+	runInChild( jobs[worker.idx], fds[1] );	// does not return
+      }
+      ::close( fds[1] );
+
+      if ( worker.pid < 0 )
+      {
+	ERR << "fork for job " << worker.idx << " failed (" << ::strerror(errno) << ")" << endl;
+	::close( fds[0] );
+	if ( done_r ) done_r( worker.idx, results[worker.idx] );
+	continue;
+      }
+      worker.fd = fds[0];
+      DBG << "Worker " << worker.pid << " runs job " << worker.idx << endl;
+      running.push_back( worker );
+    }
+
+    if ( running.empty() )
+      continue;
+
+    // collect payloads; a worker is done when its pipe is closed
+    std::vector<struct pollfd> pfds;
+    for ( const Worker & worker : running )
+      pfds.push_back( { worker.fd, POLLIN, 0 } );
+
+    if ( ::poll( pfds.data(), pfds.size(), -1 ) < 0 )
+    {
+      if ( errno == EINTR )
+	continue;
+      ERR << "poll failed (" << ::strerror(errno) << "), falling back to blocking reads" << endl;
+      for ( struct pollfd & pfd : pfds )
+	pfd.revents = POLLIN;
+    }
+
+    for ( unsigned i = pfds.size(); i-- > 0; )
+    {
+      if ( ! pfds[i].revents )
+	continue;
+
+      Worker & worker( running[i] );
+      char buf[4096];
+      ssize_t n = ::read( worker.fd, buf, sizeof(buf) );
+      if ( n > 0 )
+      {
+	results[worker.idx].data.append( buf, n );
+	continue;
+      }
+      if ( n < 0 && errno == EINTR )
+	continue;
+
+      ::close( worker.fd );
+      reap( worker, results[worker.idx] );
+      unsigned idx = worker.idx;
+      running.erase( running.begin() + i );
+      if ( done_r )
+	done_r( idx, results[idx] );
+      if ( _canceled && _terminate )
+	break;	// the others are terminated, even if they are done too
+    }
+  }
+  return results;
+}
@@ -0,0 +1,114 @@
+/*---------------------------------------------------------------------------*\
+                          ____  _ _ __ _ __  ___ _ _
+                         |_ / || | '_ \ '_ \/ -_) '_|
+                         /__|\_, | .__/ .__/\___|_|
+                             |__/|_|  |_|
+\*---------------------------------------------------------------------------*/
+
+/** \file WorkerPool.h
+ * Run independent jobs concurrently in forked worker processes.
+ */
+#ifndef ZYPPER_UTILS_WORKERPOOL_H
+#define ZYPPER_UTILS_WORKERPOOL_H
+
+#include <string>
+#include <vector>
+#include <functional>
+
+#include <zypp/base/NonCopyable.h>
+
+///////////////////////////////////////////////////////////////////
+/// \class WorkerPool
+/// \brief Run jobs in forked worker processes, at most \ref maxJobs at a time.
+///
+/// libzypp's media and repo handling is not thread safe, so concurrency is
+/// achieved by forking. Each job runs in a child process operating on a
+/// copy-on-write image of the parent (RepoManager, target, config, ...).
+/// Everything a job changes in memory is lost, only the files it writes
+/// and the result it passes back are visible to the parent.
+///
+/// Inside the worker stdin, stdout and stderr are redirected to
+/// \c /dev/null, and the worker terminates via \c _exit. So no destructors
+/// or atexit handlers run (zypp lock, tmpdirs). Jobs must not prompt;
+/// anything needing user interaction should fail and be redone in the parent.
+/// A job's own objects (e.g. a media attach point) are cleaned up when it
+/// returns, so a job asked to stop (\ref terminating) should return early
+/// rather than being killed.
+///
+/// \code
+///   WorkerPool pool( 4 );
+///   for ( const RepoInfo & repo : repos )
+///     pool.add( [&repo]( std::string & data_r ) { ...; return 0; } );
+///   std::vector<WorkerPool::Result> results( pool.run() );
+/// \endcode
+///////////////////////////////////////////////////////////////////
+class WorkerPool : private zypp::base::NonCopyable
+{
+public:
+  /** A job executed in the worker process.
+   * Returns the workers exit status (0..127) and may pass back a
+   * text payload in \a data_r.
+   */
+  typedef std::function<int( std::string & data_r )> Job;
+
+  /** The outcome of a \ref Job. */
+  struct Result
+  {
+    /** Whether the job returned 0. */
+    bool ok() const
+    { return status == 0; }
+
+    int status = -1;	///< the jobs return value; -1 if the worker could not be started or died
+    std::string data;	///< payload passed back by the job
+  };
+
+  /** Called in the parent whenever a job is done (in order of completion). */
+  typedef std::function<void( unsigned idx_r, const Result & result_r )> DoneCallback;
+
+public:
+  /** Ctor, \a maxJobs_r is the number of concurrent workers (at least 1). */
+  explicit WorkerPool( unsigned maxJobs_r );
+
+  /** The number of concurrent workers. */
+  unsigned maxJobs() const
+  { return _maxJobs; }
+
+  /** The number of queued jobs. */
+  unsigned size() const
+  { return _jobs.size(); }
+
+  /** Queue a job. */
+  void add( Job job_r )
+  { _jobs.push_back( std::move(job_r) ); }
+
+  /** Run all queued jobs and wait for them to finish.
+   * Results are returned in order of \ref add. The queue is empty afterwards.
+   */
+  std::vector<Result> run( DoneCallback done_r = DoneCallback() );
+
+  /** Stop a \ref run early (e.g. from within the \ref DoneCallback).
+   * Queued jobs are not started. Running workers are terminated unless
+   * \a terminate_r is \c false, in which case \ref run waits for them
+   * as usual. The results of dropped and terminated jobs have status -1
+   * and no callback is invoked for them, nor for jobs done in the meantime.
+   *
+   * Workers are asked to stop via \c SIGTERM (see \ref terminating) and
+   * killed if they did not exit after \ref terminateGraceMs.
+   */
+  void cancel( bool terminate_r = true )
+  { _canceled = true; _terminate = terminate_r; }
+
+  /** In a worker: whether \ref cancel asked the worker to stop. */
+  static bool terminating();
+
+  /** How long a terminated worker may take to clean up and exit. */
+  static const unsigned terminateGraceMs = 3000;
+
+private:
+  unsigned _maxJobs;
+  bool _canceled = false;
+  bool _terminate = false;
+  std::vector<Job> _jobs;
+};
+
+#endif // ZYPPER_UTILS_WORKERPOOL_H
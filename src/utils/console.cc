@@ -9,7 +9,11 @@
  * Miscellaneous console utilities.
  */
 #include <unistd.h>
+#include <signal.h>
+#include <sys/ioctl.h>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 
 #include <string>
 #include <fstream>
@@ -17,6 +21,8 @@
 #include <readline/readline.h>
 #include <readline/history.h>
 
+#include "console.h"
+
 // ----------------------------------------------------------------------------
 
 // Read a string. "\004" (^D) on EOF.
@@ -42,22 +48,99 @@ std::string readline_getline()
 
 // ----------------------------------------------------------------------------
 
+namespace
+{
+  volatile sig_atomic_t _termResized = 0;
+  struct sigaction _prevSigwinch;
+
+  void sigwinch_handler( int sig_r )
+  {
+    _termResized = 1;
+    if ( !( _prevSigwinch.sa_flags & SA_SIGINFO )
+      && _prevSigwinch.sa_handler != SIG_DFL && _prevSigwinch.sa_handler != SIG_IGN )
+      _prevSigwinch.sa_handler( sig_r );
+  }
+
+  struct TermGeometryData
+  {
+    TermGeometryData()
+    : _isatty( ::isatty( STDOUT_FILENO ) )
+    , _columns( 0 )
+    {
+      if ( _isatty )
+      {
+        struct sigaction sa;
+        ::memset( &sa, 0, sizeof(sa) );
+        sa.sa_handler = sigwinch_handler;
+        sa.sa_flags = SA_RESTART;
+        ::sigemptyset( &sa.sa_mask );
+        ::sigaction( SIGWINCH, &sa, &_prevSigwinch );
+        query();
+      }
+    }
+
+    bool isatty() const
+    { return _isatty; }
+
+    unsigned columns()
+    {
+      if ( _termResized )
+        query();
+      return _columns;
+    }
+
+  private:
+    void query()
+    {
+      _termResized = 0;	// before asking, so a resize meanwhile is not lost
+      struct winsize wns;
+      _columns = ( ::ioctl( STDOUT_FILENO, TIOCGWINSZ, &wns ) == 0 ? wns.ws_col : 0 );
+    }
+
+    const bool _isatty;
+    unsigned _columns;
+  };
+
+  TermGeometryData & termGeometry()
+  {
+    static TermGeometryData _data;
+    return _data;
+  }
+} // namespace
+
+bool TermGeometry::isatty()
+{ return termGeometry().isatty(); }
+
+unsigned TermGeometry::columns()
+{ return termGeometry().columns(); }
+
+// ----------------------------------------------------------------------------
+
+void OutputBuffer::setup()
+{
+  if ( ! ::isatty( STDOUT_FILENO ) )
+    ::setvbuf( stdout, nullptr, _IOFBF, size );
+}
+
+void OutputBuffer::flush()
+{
+  std::cout.flush();
+  ::fflush( stdout );
+}
+
+// ----------------------------------------------------------------------------
+
 unsigned get_screen_width()
 {
-  if ( !::isatty(STDOUT_FILENO) )
+  if ( !TermGeometry::isatty() )
     return -1; // no clipping
 
+  static const char *cols_env = getenv("COLUMNS");
   int width = 80;
-
-  const char *cols_env = getenv("COLUMNS");
   if ( cols_env )
     width  = ::atoi( cols_env );
   else
-  {
-    ::rl_initialize();
-    //::rl_reset_screen_size();
-    ::rl_get_screen_size( NULL, &width );
-  }
+    width = TermGeometry::columns();
 
   // safe default
   if ( !width )
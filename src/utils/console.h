@@ -12,12 +12,59 @@
 #ifndef CONSOLE_H_
 #define CONSOLE_H_
 
+#include <cstddef>
+#include <string>
+
 /** Use readline to get line of input. */
 std::string readline_getline();
 
+///////////////////////////////////////////////////////////////////
+/// \class TermGeometry
+/// \brief The size of the terminal stdout is connected to.
+///
+/// Determined once per process on first use and determined again after
+/// the terminal was resized (SIGWINCH). Asking for it costs neither a
+/// syscall nor an allocation unless the terminal was resized.
+///////////////////////////////////////////////////////////////////
+struct TermGeometry
+{
+  /** Whether stdout is connected to a terminal. */
+  static bool isatty();
+
+  /** The number of columns of the terminal or \c 0 if unknown. */
+  static unsigned columns();
+};
+
+///////////////////////////////////////////////////////////////////
+/// \class OutputBuffer
+/// \brief The buffer all output to stdout goes through.
+///
+/// Writing \c std::endl flushes the stream, a write syscall per line.
+/// Tables, listings and the summary end their lines with \c '\n' instead,
+/// so their output is written when the buffer is full. On a terminal
+/// stdout stays line buffered; otherwise \ref setup makes it fully
+/// buffered with a buffer of \ref size bytes.
+///
+/// Prompts and progress updates \ref flush the buffer. Writing to
+/// \c std::cerr and reading \c std::cin flush it too, as they are tied
+/// to \c std::cout. Forked processes must not inherit pending output,
+/// so \ref flush before forking.
+///////////////////////////////////////////////////////////////////
+struct OutputBuffer
+{
+  static const size_t size = 64 * 1024;
+
+  /** Set up the buffer; call before anything is written to stdout. */
+  static void setup();
+
+  /** Write the buffered output. */
+  static void flush();
+};
+
 /**
- * Reads COLUMNS environment variable or gets the screen width from readline,
- * in that order. Falls back to 80 if all that fails.
+ * Reads COLUMNS environment variable or gets the screen width from the
+ * terminal (\ref TermGeometry), in that order. Falls back to 80 if all
+ * that fails.
  *
  * \NOTE In case stdout is not connected to a terminal max. unsigned
  * is returned. This should prevent clipping when output is redirected.
@@ -21,6 +21,7 @@
 #include "../main.h"
 #include "Zypper.h"
 
+#include "console.h"
 #include "pager.h"
 
 // ---------------------------------------------------------------------------
@@ -57,6 +58,7 @@ static bool show_in_pager( const std::string & pager, const Pathname & file )
 
   std::string errmsg;
   pid_t pid;
+  OutputBuffer::flush();	// pending output first
   switch( pid = fork() )
   {
   case -1:
@@ -12,7 +12,13 @@
 std::string mbs_substr_by_width( boost::string_ref text_r, std::string::size_type colpos_r, std::string::size_type collen_r )
 {
   std::string ret;
-  if ( collen_r )
+  if ( collen_r && mbs::isAsciiText( text_r ) )
+  {
+    // one column per char
+    if ( colpos_r < text_r.size() )
+      ret = text_r.substr( colpos_r, collen_r ).to_string();
+  }
+  else if ( collen_r )
   {
     const char * spos	= nullptr;
     size_t slen		= 0;
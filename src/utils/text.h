@@ -10,6 +10,8 @@
 
 #include <iosfwd>
 #include <string>
+#include <cstdint>
+#include <cstring>
 
 #include <boost/utility/string_ref.hpp>
 #include <zypp/base/DtorReset.h>
@@ -212,6 +214,66 @@ namespace mbs
     mbstate_t		_mbstate;
   };
 
+  /** Whether \a text_r consists of printable ASCII chars (' ' to '~') only,
+   * and also of '\n' if \a withNL_r. Such chars need no multibyte decoding and
+   * each occupies one column on screen ('\n' none). Checks 8 bytes at a time.
+   */
+  inline bool isAsciiText( boost::string_ref text_r, bool withNL_r = false )
+  {
+    static const uint64_t ones = 0x0101010101010101ULL;
+    static const uint64_t highs = 0x8080808080808080ULL;
+    auto printable = [withNL_r]( char ch ) { return ( ' ' <= ch && ch <= '~' ) || ( withNL_r && ch == '\n' ); };
+
+    const char * pos = text_r.data();
+    size_t rest = text_r.size();
+    for ( ; rest >= 8; pos += 8, rest -= 8 )
+    {
+      uint64_t word;
+      ::memcpy( &word, pos, 8 );
+      // any byte < 0x20 (borrows into the high bit) or > 0x7e (0x7f + 1 carries into it)
+      if ( ( ( ( word - ones * 0x20 ) & ~word ) | ( word + ones ) | word ) & highs )
+      {
+	for ( unsigned i = 0; i < 8; ++i )
+	  if ( ! printable( pos[i] ) )
+	    return false;
+      }
+    }
+    for ( ; rest; ++pos, --rest )
+      if ( ! printable( *pos ) )
+	return false;
+    return true;
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  /// \class AsciiIterator
+  /// \brief \ref MbsIterator for a text passing \ref isAsciiText
+  ///////////////////////////////////////////////////////////////////
+  struct AsciiIterator
+  {
+    AsciiIterator( boost::string_ref text_r )
+    : _tpos( text_r.data() )
+    , _tend( text_r.data() + text_r.size() )
+    {}
+
+    const char * pos() const		{ return _tpos; }
+    size_t       size() const		{ return 1; }
+    size_t       columns() const	{ return isNL() ? 0 : 1; }
+
+    boost::string_ref ref() const	{ return boost::string_ref( _tpos, 1 ); }
+
+    bool atEnd() const			{ return _tpos == _tend; }
+    bool isNL() const			{ return( !atEnd() && *_tpos == '\n' ); }
+    bool isWS() const			{ return( !atEnd() && *_tpos == ' ' ); }
+    bool isCH() const			{ return !( atEnd() || isNL() || isWS() ); }
+
+    AsciiIterator & operator++()
+    { if ( !atEnd() ) ++_tpos; return *this; }
+
+  private:
+    const char * _tpos;
+    const char * _tend;
+  };
+
   ///////////////////////////////////////////////////////////////////
   /// \class MbsWriteWrapped
   /// \brief Write MBString optionally wrapped and indented.
@@ -282,9 +344,9 @@ namespace mbs
       writeout(true);
       clearIndent();
 #if ( ZYPPER_TRACE_MBS)
-      _out << "<NL>" << endl;	// "<NL>"
+      _out << "<NL>\n";	// "<NL>"
 #else
-      _out << endl;	// "<NL>"
+      _out << '\n';	// "<NL>"
 #endif
       _lpos = 0;
     }
@@ -303,7 +365,7 @@ namespace mbs
 	_gapLines += count_r;
 #if ( ZYPPER_TRACE_MBS )
 	while ( count_r-- )
-	  _out << "<BR>" << endl;	// "<BR>"
+	  _out << "<BR>\n";	// "<BR>"
 #else
 	_out << std::string( count_r, '\n' );
 #endif
@@ -410,7 +472,16 @@ namespace mbs
      */
     void write( boost::string_ref text_r, bool leadingWSindents_r = true )
     {
-      for( MbsIterator it( text_r ); ! it.atEnd(); ++it )
+      if ( isAsciiText( text_r, /*withNL_r*/true ) )
+	write<AsciiIterator>( text_r, leadingWSindents_r );
+      else
+	write<MbsIterator>( text_r, leadingWSindents_r );
+    }
+
+    template <class TIterator>
+    void write( boost::string_ref text_r, bool leadingWSindents_r )
+    {
+      for( TIterator it( text_r ); ! it.atEnd(); ++it )
       {
 	if ( it.isNL() )
 	{
@@ -475,7 +546,7 @@ namespace mbs
 	// Here: did not fit on this line
 	// suppress gap and write indented on next line
 	clearGap();
-	_out << endl;
+	_out << '\n';
 	_lpos = 0;
       }
 
@@ -494,18 +565,27 @@ namespace mbs
       }
 
       // Still here: word is too big, we need to split it :(
-      for( MbsIterator it( boost::string_ref( _word, _wSize ) ); ! it.atEnd(); ++it )
+      if ( _wSize == _wColumns )	// single byte chars only
+	splitWord<AsciiIterator>( useIndent );
+      else
+	splitWord<MbsIterator>( useIndent );
+    }
+
+    template <class TIterator>
+    void splitWord( unsigned useIndent_r )
+    {
+      for( TIterator it( boost::string_ref( _word, _wSize ) ); ! it.atEnd(); ++it )
       {
 	if ( atLineBegin() )
 	{
-	  _out << std::string( useIndent, ' ' );
-	  _lpos += useIndent;
+	  _out << std::string( useIndent_r, ' ' );
+	  _lpos += useIndent_r;
 	}
 	_out << it.ref();
 	++_lpos;
 	if ( _lpos >= _defaultWrap )
 	{
-	  _out << endl;
+	  _out << '\n';
 	  _lpos = 0;
 	}
       }
@@ -612,6 +692,8 @@ inline void mbs_write_wrapped( std::ostream & out, const zypp::str::Str & text_r
 /** Returns the column width of a multi-byte character string \a text_r */
 inline size_t mbs_width( boost::string_ref text_r )
 {
+  if ( mbs::isAsciiText( text_r ) )
+    return text_r.size();
   size_t ret = 0;
   for( mbs::MbsIterator it( text_r ); ! it.atEnd(); ++it )
     ret += it.columns();
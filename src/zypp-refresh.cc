@@ -9,7 +9,19 @@
 
 /* (c) Novell Inc. */
 
+#include <getopt.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
 
 #include <zypp/ZYppFactory.h>
 #include <zypp/base/LogControl.h>
@@ -23,6 +35,9 @@
 
 #include <zypp/RepoManager.h>
 #include <zypp/PathInfo.h>
+#include <zypp/ByteCount.h>
+
+#include "utils/WorkerPool.h"
 
 using std::cout;
 using std::cerr;
@@ -90,14 +105,299 @@ class DigestCallbacks
     ~DigestCallbacks() { _digestReport.disconnect(); }
 };
 
+///////////////////////////////////////////////////////////////////
+namespace
+{
+  typedef std::chrono::steady_clock Clock;
+
+  /** Milliseconds passed since \a start_r. */
+  inline unsigned msSince( Clock::time_point start_r )
+  { return std::chrono::duration_cast<std::chrono::milliseconds>( Clock::now() - start_r ).count(); }
+
+  struct Options
+  {
+    unsigned jobs = 1;		///< number of repos to refresh concurrently
+    unsigned jitter = 0;	///< max. seconds to sleep before starting
+    unsigned timeBudget = 0;	///< don't start refreshing repos after this many seconds (0: unlimited)
+    ByteCount byteBudget;	///< don't start refreshing repos after this much was downloaded (0: unlimited)
+    std::string report;		///< per repo timing report file ("-": stdout)
+  };
+
+  void usage( std::ostream & str )
+  {
+    str << "Usage: zypp-refresh [OPTIONS]" << endl
+        << "Refresh all enabled repositories with autorefresh turned on." << endl
+        << endl
+        << "  -j, --jobs <N>               Refresh up to N repositories concurrently." << endl
+        << "      --jitter <SECONDS>       Sleep a random time of up to SECONDS before starting." << endl
+        << "      --time-budget <SECONDS>  Do not start refreshing repositories after SECONDS." << endl
+        << "      --byte-budget <SIZE>     Do not start refreshing repositories after SIZE bytes" << endl
+        << "                               were downloaded (suffixes K, M, G)." << endl
+        << "      --report <FILE>          Write a tab separated per repository report to FILE" << endl
+        << "                               ('-' for stdout)." << endl
+        << "  -h, --help                   Print this help." << endl;
+  }
+
+  bool parseUnsigned( const char * arg_r, unsigned & val_r )
+  {
+    char * end = nullptr;
+    errno = 0;
+    unsigned long val = ::strtoul( arg_r, &end, 10 );
+    if ( errno || end == arg_r || *end || *arg_r == '-' || val > std::numeric_limits<unsigned>::max() )
+      return false;
+    val_r = val;
+    return true;
+  }
+
+  bool parseSize( const char * arg_r, ByteCount & val_r )
+  {
+    char * end = nullptr;
+    errno = 0;
+    unsigned long long val = ::strtoull( arg_r, &end, 10 );
+    if ( errno || end == arg_r || *arg_r == '-' )
+      return false;
+    switch ( *end )
+    {
+      case '\0':	val_r = ByteCount( val ); return true;
+      case 'K':		val_r = ByteCount( val, ByteCount::K ); break;
+      case 'M':		val_r = ByteCount( val, ByteCount::M ); break;
+      case 'G':		val_r = ByteCount( val, ByteCount::G ); break;
+      default:		return false;
+    }
+    return ! end[1];
+  }
+
+  /** Parse the command line. Returns -1 to continue, otherwise the exit code. */
+  int parseOptions( int argc, char **argv, Options & opts_r )
+  {
+    enum { OPT_JITTER = 256, OPT_TIME_BUDGET, OPT_BYTE_BUDGET, OPT_REPORT };
+    static const struct option longopts[] = {
+      { "jobs",		required_argument,	nullptr, 'j' },
+      { "jitter",	required_argument,	nullptr, OPT_JITTER },
+      { "time-budget",	required_argument,	nullptr, OPT_TIME_BUDGET },
+      { "byte-budget",	required_argument,	nullptr, OPT_BYTE_BUDGET },
+      { "report",	required_argument,	nullptr, OPT_REPORT },
+      { "help",		no_argument,		nullptr, 'h' },
+      { nullptr,	0,			nullptr, 0 }
+    };
+
+    int c = 0;
+    while ( (c = ::getopt_long( argc, argv, "j:h", longopts, nullptr )) != -1 )
+    {
+      bool ok = true;
+      switch ( c )
+      {
+        case 'j':		ok = parseUnsigned( optarg, opts_r.jobs ) && opts_r.jobs; break;
+        case OPT_JITTER:	ok = parseUnsigned( optarg, opts_r.jitter ); break;
+        case OPT_TIME_BUDGET:	ok = parseUnsigned( optarg, opts_r.timeBudget ); break;
+        case OPT_BYTE_BUDGET:	ok = parseSize( optarg, opts_r.byteBudget ); break;
+        case OPT_REPORT:	opts_r.report = optarg; break;
+        case 'h':		usage( cout ); return 0;
+        default:		usage( cerr ); return 1;
+      }
+      if ( ! ok )
+      {
+        cerr << "Invalid argument '" << optarg << "'." << endl;
+        usage( cerr );
+        return 1;
+      }
+    }
+    if ( optind < argc )
+    {
+      cerr << "Unexpected argument '" << argv[optind] << "'." << endl;
+      usage( cerr );
+      return 1;
+    }
+    return -1;
+  }
+
+  /** Sums up the size of the files downloaded while connected. */
+  struct DownloadedBytes : public callback::ReceiveReport<media::DownloadProgressReport>
+  {
+    DownloadedBytes()	{ connect(); }
+    ~DownloadedBytes()	{ disconnect(); }
+
+    virtual void start( const Url & file, Pathname localfile )
+    { _localfile = localfile; }
+
+    virtual void finish( const Url & file, Error error, const std::string & reason )
+    {
+      if ( error == NO_ERROR && ! _localfile.empty() )
+        _bytes += PathInfo( _localfile ).size();
+      _localfile = Pathname();
+    }
+
+    ByteCount::SizeType _bytes = 0;
+    Pathname _localfile;	///< the file being downloaded
+  };
+
+  /** How refreshing a repo went. */
+  struct RepoRecord
+  {
+    enum State { PENDING, RETRIEVED, UPTODATE, FAILED, SKIPPED };
+
+    static const char * asString( State state_r )
+    {
+      switch ( state_r )
+      {
+        case PENDING:	return "pending";
+        case RETRIEVED:	return "retrieved";
+        case UPTODATE:	return "uptodate";
+        case FAILED:	return "failed";
+        case SKIPPED:	return "skipped";
+      }
+      return "?";
+    }
+
+    RepoInfo repo;
+    State state = PENDING;
+    unsigned ms = 0;		///< time spent refreshing
+    ByteCount bytes;		///< size of the downloaded files (including checks of unchanged metadata)
+  };
+
+  /** Refresh \a record_r.repo and remember whether new metadata were retrieved. Throws on error. */
+  void refreshRepo( RepoManager & manager, RepoRecord & record_r )
+  {
+    Clock::time_point start( Clock::now() );
+    DownloadedBytes downloaded;
+    RepoStatus before( manager.metadataStatus( record_r.repo ) );
+    manager.refreshMetadata( record_r.repo );
+    manager.buildCache( record_r.repo );
+
+    record_r.state = manager.metadataStatus( record_r.repo ) != before ? RepoRecord::RETRIEVED : RepoRecord::UPTODATE;
+    record_r.bytes = downloaded._bytes;
+    record_r.ms = msSince( start );
+  }
+
+  void reportError( const RepoRecord & record_r, const std::string & msg_r )
+  {
+    cerr
+      << " Error:" << endl
+      << str::form(
+        "Could not refresh repository '%s':\n%s",
+        record_r.repo.name().c_str(), msg_r.c_str() )
+      << endl;
+  }
+
+  /** Whether the time or byte budget is exhausted. */
+  bool budgetExhausted( const Options & opts_r, Clock::time_point start_r, const std::vector<RepoRecord> & records_r )
+  {
+    if ( opts_r.timeBudget && msSince( start_r ) >= opts_r.timeBudget * 1000ULL )
+    {
+      MIL << "Time budget of " << opts_r.timeBudget << "s exhausted." << endl;
+      return true;
+    }
+    if ( opts_r.byteBudget )
+    {
+      ByteCount::SizeType total = 0;
+      for ( const RepoRecord & record : records_r )
+        total += record.bytes;
+      if ( total >= opts_r.byteBudget )
+      {
+        MIL << "Byte budget of " << opts_r.byteBudget << " exhausted (" << ByteCount( total ) << ")." << endl;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  /** Refresh one repo after the other. */
+  void refreshSerial( RepoManager & manager, const Options & opts_r, Clock::time_point start_r, std::vector<RepoRecord> & records_r )
+  {
+    for ( RepoRecord & record : records_r )
+    {
+      if ( budgetExhausted( opts_r, start_r, records_r ) )
+        break;
+
+      try
+      {
+        cout << "refreshing '" << record.repo.alias() << "' ." << std::flush;
+        refreshRepo( manager, record );
+        cout << ". Done." << endl;
+      }
+      catch ( const Exception &excpt_r )
+      {
+        record.state = RepoRecord::FAILED;
+        reportError( record, excpt_r.asUserString() + "\n" + excpt_r.historyAsString() );
+      }
+    }
+  }
+
+  /** Refresh up to \a opts_r.jobs repos concurrently in forked workers.
+   * A worker passes back "<state> <ms> <bytes>", or the error message if it failed.
+   */
+  void refreshParallel( RepoManager & manager, const Options & opts_r, Clock::time_point start_r, std::vector<RepoRecord> & records_r )
+  {
+    WorkerPool pool( opts_r.jobs );
+    for ( RepoRecord & record : records_r )
+    {
+      pool.add( [&manager,&record]( std::string & data_r ) {
+        refreshRepo( manager, record );
+        data_r = str::form( "%d %u %llu", record.state, record.ms, (unsigned long long)ByteCount::SizeType(record.bytes) );
+        return 0;
+      } );
+    }
+
+    pool.run( [&]( unsigned idx_r, const WorkerPool::Result & result_r ) {
+      RepoRecord & record( records_r[idx_r] );
+      cout << "refreshing '" << record.repo.alias() << "' ..." << std::flush;
+
+      int state = RepoRecord::FAILED;
+      unsigned long long bytes = 0;
+      if ( result_r.ok()
+        && ::sscanf( result_r.data.c_str(), "%d %u %llu", &state, &record.ms, &bytes ) == 3 )
+      {
+        record.state = RepoRecord::State( state );
+        record.bytes = ByteCount( bytes );
+        cout << " Done." << endl;
+      }
+      else
+      {
+        record.state = RepoRecord::FAILED;
+        reportError( record, result_r.data.empty() ? str::form( "worker exited with status %d", result_r.status ) : result_r.data );
+      }
+
+      if ( budgetExhausted( opts_r, start_r, records_r ) )
+        pool.cancel( /*terminate*/false );	// let the running ones finish
+    } );
+  }
+
+  void writeReport( std::ostream & str, const std::vector<RepoRecord> & records_r )
+  {
+    str << "# alias\tstate\tmilliseconds\tbytes" << endl;
+    for ( const RepoRecord & record : records_r )
+    {
+      str << record.repo.alias() << "\t" << RepoRecord::asString( record.state ) << "\t" << record.ms
+          << "\t" << ByteCount::SizeType(record.bytes) << endl;
+    }
+  }
+} // namespace
+///////////////////////////////////////////////////////////////////
+
 int main( int argc, char **argv )
 {
+  Options opts;
+  int ret = parseOptions( argc, argv, opts );
+  if ( ret >= 0 )
+    return ret;
+
   const char *logfile = getenv("ZYPP_LOGFILE");
   if ( logfile != NULL )
     base::LogControl::instance().logfile( logfile );
   else
     base::LogControl::instance().logfile( ZYPP_REFRESH_LOG );
 
+  // Spread the load on the servers if many hosts are triggered at the same
+  // time. Sleep before acquiring the zypp lock, so nobody is blocked meanwhile.
+  if ( opts.jitter )
+  {
+    std::random_device rd;
+    std::uniform_int_distribution<unsigned> dist( 0, opts.jitter );
+    unsigned delay = dist( rd );
+    MIL << "Start jitter: sleeping " << delay << "s" << endl;
+    std::this_thread::sleep_for( std::chrono::seconds( delay ) );
+  }
+
   ZYpp::Ptr God;
   try
   {
@@ -129,11 +429,11 @@ int main( int argc, char **argv )
   repos.insert( repos.end(), manager.repoBegin(), manager.repoEnd() );
   MIL << "Found " << repos.size() << " repos." << endl;
 
-  unsigned repocount = 0, errcount = 0;
-  for( std::list<RepoInfo>::iterator it = repos.begin(); it != repos.end(); ++it, ++repocount )
+  unsigned repocount = repos.size();
+  std::vector<RepoRecord> records;
+  for( std::list<RepoInfo>::iterator it = repos.begin(); it != repos.end(); ++it )
   {
     Url url = it->url();
-    std::string scheme( url.getScheme() );
 
     if ( url.schemeIsVolatile() )	// cd/dvd
     {
@@ -155,24 +455,55 @@ int main( int argc, char **argv )
     MIL << "Going to refresh repository: "
       "alias:[" << it->alias() << "] "
       "url:[" << url << "] " << endl;
+    records.push_back( RepoRecord() );
+    records.back().repo = *it;
+  }
 
-    try
+  // If the budget runs out, the repos with the most recent metadata are skipped.
+  if ( opts.timeBudget || opts.byteBudget )
+  {
+    std::vector<Date> age;
+    for ( const RepoRecord & record : records )
+      age.push_back( manager.metadataStatus( record.repo ).timestamp() );
+    std::vector<unsigned> order( records.size() );
+    for ( unsigned i = 0; i < order.size(); ++i )
+      order[i] = i;
+    std::stable_sort( order.begin(), order.end(), [&age]( unsigned lhs, unsigned rhs ) { return age[lhs] < age[rhs]; } );
+
+    std::vector<RepoRecord> sorted;
+    for ( unsigned i : order )
+      sorted.push_back( records[i] );
+    records.swap( sorted );
+  }
+
+  Clock::time_point start( Clock::now() );
+  if ( opts.jobs > 1 && records.size() > 1 )
+    refreshParallel( manager, opts, start, records );
+  else
+    refreshSerial( manager, opts, start, records );
+
+  unsigned errcount = 0;
+  for ( RepoRecord & record : records )
+  {
+    if ( record.state == RepoRecord::PENDING )
     {
-      cout << "refreshing '" << it->alias() << "' ." << std::flush;
-      manager.refreshMetadata(*it);
-      cout << "." << std::flush;
-      manager.buildCache(*it);
-      cout << ". Done." << endl;
+      record.state = RepoRecord::SKIPPED;
+      cout << "skipping '" << record.repo.alias() << "': refresh budget exhausted." << endl;
     }
-    catch ( const Exception &excpt_r )
-    {
-      cerr
-        << " Error:" << endl
-        << str::form(
-          "Could not refresh repository '%s':\n%s\n%s",
-          it->name().c_str(), excpt_r.asUserString().c_str(), excpt_r.historyAsString().c_str())
-        << endl;
+    else if ( record.state == RepoRecord::FAILED )
       ++errcount;
+  }
+
+  if ( ! opts.report.empty() )
+  {
+    if ( opts.report == "-" )
+      writeReport( cout, records );
+    else
+    {
+      std::ofstream str( opts.report.c_str() );
+      writeReport( str, records );
+      if ( ! str )
+        cerr << "Could not write report to '" << opts.report << "'." << endl;
     }
   }
 
@@ -0,0 +1,175 @@
+#include "TestSetup.h"
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <iterator>
+
+#include "repos.h"
+
+using namespace zypp;
+
+namespace
+{
+  const Pathname repoDir( TESTS_SRC_DIR "/data/openSUSE-11.1" );
+
+  /** A forked HTTP server on localhost serving the files below \a root_r,
+   * each request answered after \a delayMs_r.
+   */
+  class HttpStandIn
+  {
+  public:
+    HttpStandIn( const Pathname & root_r, unsigned delayMs_r )
+    {
+      _fd = ::socket( AF_INET, SOCK_STREAM, 0 );
+      struct sockaddr_in addr = {};
+      addr.sin_family = AF_INET;
+      addr.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+      socklen_t len = sizeof(addr);
+      if ( _fd < 0
+	|| ::bind( _fd, (struct sockaddr *)&addr, len ) != 0
+	|| ::listen( _fd, 16 ) != 0
+	|| ::getsockname( _fd, (struct sockaddr *)&addr, &len ) != 0 )
+	ZYPP_THROW( Exception( "HttpStandIn: can't listen on localhost" ) );
+      _port = ntohs( addr.sin_port );
+
+      _pid = ::fork();
+      if ( _pid == 0 )
+	serve( root_r, delayMs_r );	// does not return
+      ::close( _fd );
+    }
+
+    ~HttpStandIn()
+    {
+      ::kill( _pid, SIGKILL );
+      ::waitpid( _pid, nullptr, 0 );
+    }
+
+    Url url() const
+    { return Url( "http://127.0.0.1:" + str::numstring( _port ) + "/" ); }
+
+  private:
+    void serve( const Pathname & root_r, unsigned delayMs_r )
+    {
+      while ( true )
+      {
+	int conn = ::accept( _fd, nullptr, nullptr );
+	if ( conn < 0 )
+	  continue;
+
+	std::string request;
+	char buf[1024];
+	ssize_t n = 0;
+	while ( request.find( "\r\n\r\n" ) == std::string::npos && ( n = ::read( conn, buf, sizeof(buf) ) ) > 0 )
+	  request.append( buf, n );
+	::usleep( delayMs_r * 1000 );
+
+	// "GET /path?query HTTP/1.1"
+	std::vector<std::string> words;
+	str::split( request.substr( 0, request.find( "\r\n" ) ), std::back_inserter( words ) );
+	std::string path( words.size() > 1 ? words[1].substr( 0, words[1].find( '?' ) ) : "" );
+
+	std::string response;
+	PathInfo file( root_r / path );
+	if ( words.size() > 1 && path.find( ".." ) == std::string::npos && file.isFile() )
+	{
+	  std::ifstream in( file.c_str() );
+	  std::string body( (std::istreambuf_iterator<char>( in )), std::istreambuf_iterator<char>() );
+	  response = "HTTP/1.1 200 OK\r\nContent-Length: " + str::numstring( body.size() ) + "\r\nConnection: close\r\n\r\n";
+	  if ( words[0] != "HEAD" )
+	    response += body;
+	}
+	else
+	  response = "HTTP/1.1 404 Not Found\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+
+	for ( const char * p = response.c_str(), * e = p + response.size(); p < e && ( n = ::write( conn, p, e - p ) ) > 0; p += n )
+	{;}
+	::close( conn );
+      }
+    }
+
+    int _fd = -1;
+    unsigned _port = 0;
+    pid_t _pid = -1;
+  };
+
+  RepoInfo mkrepo( const std::vector<Url> & urls_r )
+  {
+    RepoInfo repo;
+    repo.setAlias( "race" );
+    repo.setType( repo::RepoType::YAST2 );
+    repo.setGpgCheck( false );
+    repo.setEnabled( true );
+    for ( const Url & url : urls_r )
+      repo.addBaseUrl( url );
+    return repo;
+  }
+
+  long long msOf( std::function<void()> fnc_r )
+  { return usec( fnc_r ) / 1000; }
+
+  /** Retrieve the raw metadata of \a repo from \a url_r, so the up-to-date check has to contact the mirrors. */
+  void populateCache( const RepoInfo & repo, const Url & url_r )
+  {
+    Zypper & zypper( Zypper::instance() );
+    zypper.initRepoManager();	// uses the test roots cache
+    RepoInfo single( mkrepo( { url_r } ) );
+    zypper.repoManager().refreshMetadata( single, RepoManager::RefreshForced );
+    BOOST_REQUIRE( ! zypper.repoManager().metadataStatus( repo ).empty() );
+  }
+}
+
+struct TestInit {
+  TestInit()
+    : testSetup( std::make_unique<TestSetup>( Arch_x86_64 ) )
+  {}
+  std::unique_ptr<TestSetup> testSetup;
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+// An unreachable and a good local mirror: the good one wins (every time) and is moved to the front.
+BOOST_AUTO_TEST_CASE(mirror_race_file)
+{
+  const Url good( repoDir.asUrl() );
+  RepoInfo repo( mkrepo( { Url( "file:///nonexistent/zypper-mirror" ), good } ) );
+  populateCache( repo, good );
+
+  for ( unsigned round = 0; round < 5; ++round )
+  {
+    RepoInfo raced( repo );
+    RepoManager::RefreshCheckStatus stat = RepoManager::REFRESH_NEEDED;
+    BOOST_REQUIRE( race_mirrors( Zypper::instance(), raced, RepoManager::RefreshIfNeededIgnoreDelay, stat ) );
+    BOOST_CHECK_EQUAL( *raced.baseUrlsBegin(), good );
+    BOOST_CHECK_EQUAL( raced.baseUrlsSize(), 2U );
+    BOOST_CHECK_EQUAL( stat, RepoManager::REPO_UP_TO_DATE );
+  }
+
+  // no mirror answers, even without a cache to compare with
+  RepoInfo broken( mkrepo( { Url( "file:///nonexistent/zypper-mirror" ), Url( "file:///nonexistent/zypper-mirror2" ) } ) );
+  RepoManager::RefreshCheckStatus stat = RepoManager::REPO_UP_TO_DATE;
+  BOOST_CHECK( ! race_mirrors( Zypper::instance(), broken, RepoManager::RefreshIfNeededIgnoreDelay, stat ) );
+  BOOST_CHECK( ! race_mirrors( Zypper::instance(), broken, RepoManager::RefreshForced, stat ) );
+}
+
+// A slow and a fast HTTP mirror: the fast one wins and the race does not wait for the slow one.
+BOOST_AUTO_TEST_CASE(mirror_race_http)
+{
+  const unsigned slowMs = 60000;
+  HttpStandIn slow( repoDir, slowMs );
+  HttpStandIn fast( repoDir, 0 );
+  HttpStandIn missing( repoDir / "nonexistent", 0 );	// 404 only
+  RepoInfo repo( mkrepo( { slow.url(), missing.url(), fast.url() } ) );
+  populateCache( repo, repoDir.asUrl() );
+
+  RepoManager::RefreshCheckStatus stat = RepoManager::REFRESH_NEEDED;
+  bool won = false;
+  long long ms = msOf( [&]() { won = race_mirrors( Zypper::instance(), repo, RepoManager::RefreshIfNeededIgnoreDelay, stat ); } );
+  BOOST_REQUIRE( won );
+  BOOST_CHECK_EQUAL( *repo.baseUrlsBegin(), fast.url() );
+  BOOST_CHECK_EQUAL( stat, RepoManager::REPO_UP_TO_DATE );
+  BOOST_CHECK_LT( ms, slowMs / 2 );	// the slow mirror was stopped, not waited for
+  BOOST_TEST_MESSAGE( "mirror race: " << ms << "ms" );
+}
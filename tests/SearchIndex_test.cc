@@ -0,0 +1,79 @@
+#include "TestSetup.h"
+#include <set>
+
+#include <zypp/PoolQuery.h>
+#include <zypp/PoolQueryResult.h>
+
+#include "search-index.h"
+
+using namespace zypp;
+
+namespace
+{
+  std::set<std::string> names( const PoolQueryResult & result_r )
+  {
+    std::set<std::string> ret;
+    for ( const sat::Solvable & solv : result_r )
+      ret.insert( solv.name() );
+    return ret;
+  }
+
+  /** The names found for \a pattern_r the way 'zypper search' does: via the index if possible, else by \a query_r. */
+  std::set<std::string> searchNames( const std::string & pattern_r, PoolQuery query_r )
+  {
+    PoolQueryResult result;
+    if ( ! search_names( Zypper::instance(), pattern_r, Match::OTHER, query_r, result ) )
+    {
+      query_r.addAttribute( sat::SolvAttr::name, pattern_r );
+      result += query_r;
+    }
+    return names( result );
+  }
+
+  /** The names \a query_r finds for \a pattern_r. */
+  std::set<std::string> poolNames( const std::string & pattern_r, PoolQuery query_r )
+  {
+    query_r.addAttribute( sat::SolvAttr::name, pattern_r );
+    PoolQueryResult result;
+    result += query_r;
+    return names( result );
+  }
+}
+
+struct TestInit {
+  TestInit()
+    : testSetup( std::make_unique<TestSetup>( Arch_x86_64 ) )
+  { testSetup->loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" ); }
+  std::unique_ptr<TestSetup> testSetup;
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+BOOST_AUTO_TEST_CASE(search_names_substring)
+{
+  PoolQuery query;
+  query.addKind( ResKind::package );
+  std::set<std::string> found( searchNames( "vim", query ) );
+  std::set<std::string> expected( poolNames( "vim", query ) );
+  BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+  BOOST_CHECK( found.count( "gvim" ) );
+}
+
+// --match-words: 'vim' must not find 'gvim'
+BOOST_AUTO_TEST_CASE(search_names_match_words)
+{
+  PoolQuery query;
+  query.addKind( ResKind::package );
+  query.setMatchWord();
+
+  PoolQueryResult indexed;
+  BOOST_CHECK( ! search_names( Zypper::instance(), "vim", Match::OTHER, query, indexed ) );
+  BOOST_CHECK( ! search_files( Zypper::instance(), "vim", Match::OTHER, query, indexed ) );
+  BOOST_CHECK( ! search_descriptions( Zypper::instance(), "vim", query, indexed ) );
+
+  std::set<std::string> found( searchNames( "vim", query ) );
+  std::set<std::string> expected( poolNames( "vim", query ) );
+  BOOST_CHECK_EQUAL_COLLECTIONS( found.begin(), found.end(), expected.begin(), expected.end() );
+  BOOST_CHECK( found.count( "vim" ) );
+  BOOST_CHECK( found.count( "vim-base" ) );
+  BOOST_CHECK( ! found.count( "gvim" ) );
+}
@@ -0,0 +1,142 @@
+#include "TestSetup.h"
+
+#include <fstream>
+#include <iterator>
+
+#include "commands/services/common.h"
+
+using namespace zypp;
+
+extern ZYpp::Ptr God;
+
+namespace
+{
+  /** Write a RIS \c repo/repoindex.xml below \a dir_r offering \a aliases_r. */
+  void writeIndex( const Pathname & dir_r, const std::vector<std::string> & aliases_r )
+  {
+    filesystem::assert_dir( dir_r / "repo" );
+    std::ofstream out( ( dir_r / "repo/repoindex.xml" ).c_str() );
+    out << "<repoindex>" << endl;
+    for ( const std::string & alias : aliases_r )
+      out << "  <repo alias=\"" << alias << "\" name=\"" << alias << "\" url=\"" << ( dir_r / alias ).asUrl()
+	  << "\" enabled=\"true\" autorefresh=\"false\"/>" << endl;
+    out << "</repoindex>" << endl;
+  }
+
+  ServiceInfo addService( const std::string & alias_r, const Pathname & dir_r )
+  {
+    ServiceInfo service;
+    service.setAlias( alias_r );
+    service.setUrl( dir_r.asUrl() );
+    service.setType( repo::ServiceType::RIS );
+    service.setEnabled( true );
+    service.setAutorefresh( true );
+    Zypper::instance().repoManager().addService( service );
+    return service;
+  }
+
+  /** Autorefresh the services \a aliases_r like \c do_init_repos does. */
+  void autorefresh( const std::vector<std::string> & aliases_r )
+  {
+    Zypper & zypper( Zypper::instance() );
+    std::vector<ServiceInfo> services;
+    for ( const std::string & alias : aliases_r )
+      services.push_back( zypper.repoManager().getService( alias ) );
+    for ( bool error : refresh_services( zypper, services, RepoManager::RefreshServiceFlags(), true ) )
+      BOOST_REQUIRE( ! error );
+  }
+
+  unsigned reposIn( const std::string & service_r )
+  {
+    std::list<RepoInfo> repos;
+    Zypper::instance().repoManager().getRepositoriesInService( service_r, std::back_inserter( repos ) );
+    return repos.size();
+  }
+
+  /** Rename \a repo_r and backdate the last refresh of \a service_r; neither is part of the index cookie. */
+  void tamper( const std::string & service_r, const std::string & repo_r )
+  {
+    RepoManager & manager( Zypper::instance().repoManager() );
+    RepoInfo repo( manager.getRepo( repo_r ) );
+    repo.setName( "tampered" );
+    manager.modifyRepository( repo.alias(), repo );
+    ServiceInfo service( manager.getService( service_r ) );
+    service.setLrf( Date( 1 ) );
+    manager.modifyService( service.alias(), service );
+  }
+
+  /** Whether the index of \a service_r was not applied again since \ref tamper. */
+  bool skipped( const std::string & service_r, const std::string & repo_r )
+  {
+    RepoManager & manager( Zypper::instance().repoManager() );
+    if ( manager.getRepo( repo_r ).name() != "tampered" )
+      return false;
+    BOOST_CHECK_GT( manager.getService( service_r ).lrf(), Date( 1 ) );	// so its TTL applies again
+    return true;
+  }
+}
+
+struct TestInit {
+  TestInit()
+    : testSetup( std::make_unique<TestSetup>( Arch_x86_64 ) )
+  {
+    God = zypp::getZYpp();
+    Zypper::instance().initRepoManager();	// uses the test roots files
+  }
+  std::unique_ptr<TestSetup> testSetup;
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+BOOST_AUTO_TEST_CASE(service_index_skip)
+{
+  filesystem::TmpDir index;
+  writeIndex( index.path(), { "one" } );
+  addService( "ris", index.path() );
+
+  autorefresh( { "ris" } );	// never applied before
+  BOOST_REQUIRE_EQUAL( reposIn( "ris" ), 1U );
+
+  tamper( "ris", "ris:one" );
+  autorefresh( { "ris" } );	// unchanged
+  BOOST_CHECK( skipped( "ris", "ris:one" ) );
+
+  writeIndex( index.path(), { "one", "two" } );
+  autorefresh( { "ris" } );	// changed index
+  BOOST_CHECK( ! skipped( "ris", "ris:one" ) );
+  BOOST_CHECK_EQUAL( reposIn( "ris" ), 2U );
+
+  tamper( "ris", "ris:one" );
+  {
+    RepoManager & manager( Zypper::instance().repoManager() );
+    ServiceInfo service( manager.getService( "ris" ) );
+    service.addRepoToEnable( "one" );
+    manager.modifyService( service.alias(), service );
+  }
+  autorefresh( { "ris" } );	// pending repos to enable
+  BOOST_CHECK( ! skipped( "ris", "ris:one" ) );
+}
+
+BOOST_AUTO_TEST_CASE(service_index_skip_in_workers)
+{
+  Zypper & zypper( Zypper::instance() );
+  zypper.configNoConst().service_refresh_jobs = 2;
+  filesystem::TmpDir index1;
+  filesystem::TmpDir index2;
+  writeIndex( index1.path(), { "one" } );
+  writeIndex( index2.path(), { "one" } );
+  addService( "ris1", index1.path() );
+  addService( "ris2", index2.path() );
+
+  autorefresh( { "ris1", "ris2" } );
+  BOOST_REQUIRE_EQUAL( reposIn( "ris1" ), 1U );
+  BOOST_REQUIRE_EQUAL( reposIn( "ris2" ), 1U );
+
+  tamper( "ris1", "ris1:one" );
+  tamper( "ris2", "ris2:one" );
+  writeIndex( index2.path(), { "one", "two" } );
+  autorefresh( { "ris1", "ris2" } );
+  BOOST_CHECK( skipped( "ris1", "ris1:one" ) );
+  BOOST_CHECK( ! skipped( "ris2", "ris2:one" ) );
+  BOOST_CHECK_EQUAL( reposIn( "ris2" ), 2U );
+  zypper.configNoConst().service_refresh_jobs = 1;
+}
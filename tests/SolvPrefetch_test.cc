@@ -0,0 +1,72 @@
+#include "TestSetup.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "repos.h"
+
+using namespace zypp;
+
+namespace
+{
+  /** Drop the cached pages of \a file_r, so it is read from disk again. */
+  void evict( const Pathname & file_r )
+  {
+    int fd = ::open( file_r.c_str(), O_RDONLY );
+    if ( fd < 0 )
+      return;
+    ::fdatasync( fd );	// only clean pages can be dropped
+    ::posix_fadvise( fd, 0, 0, POSIX_FADV_DONTNEED );
+    ::close( fd );
+  }
+
+  /** Load the evicted solv caches of \a repos_r into an empty pool like \ref load_repo_resolvables.
+   * \return the number of solvables; \a usec_r the time it took.
+   */
+  unsigned loadAll( const Pathname & solvCachePath_r, const std::list<RepoInfo> & repos_r, bool prefetch_r, long long & usec_r )
+  {
+    sat::Pool satpool( sat::Pool::instance() );
+    satpool.reposEraseAll();
+    for ( const RepoInfo & repo : repos_r )
+      evict( solvCachePath_r / repo.escaped_alias() / "solv" );
+
+    usec_r = usec( [&]() {
+      if ( prefetch_r )
+	prefetch_solv_caches( solvCachePath_r, repos_r );
+      for ( const RepoInfo & repo : repos_r )
+	satpool.addRepoSolv( solvCachePath_r / repo.escaped_alias() / "solv", repo );
+    } );
+    return satpool.solvablesSize();
+  }
+}
+
+// Load 10, 50 and 100 solv caches which are not in the page cache, with and without prefetching.
+// (On tmpfs there is no disk to read from and both take the same time.)
+BOOST_AUTO_TEST_CASE(solv_prefetch_benchmark)
+{
+  TestSetup test( Arch_x86_64 );
+  test.loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" );
+  const Pathname solvCachePath( RepoManagerOptions::makeTestSetup( test.root() ).repoSolvCachePath );
+  const Pathname solvfile( solvCachePath / "main" / "solv" );
+  BOOST_REQUIRE( PathInfo( solvfile ).isFile() );
+
+  std::list<RepoInfo> repos;
+  for ( unsigned count : { 10U, 50U, 100U } )
+  {
+    while ( repos.size() < count )
+    {
+      RepoInfo repo;
+      repo.setAlias( "repo-" + str::numstring( repos.size() ) );
+      repo.setEnabled( true );
+      filesystem::assert_dir( solvCachePath / repo.escaped_alias() );
+      BOOST_REQUIRE_EQUAL( filesystem::copy( solvfile, solvCachePath / repo.escaped_alias() / "solv" ), 0 );
+      repos.push_back( repo );
+    }
+
+    long long plainTime = 0;
+    long long prefetchTime = 0;
+    unsigned plain = loadAll( solvCachePath, repos, false, plainTime );
+    unsigned prefetched = loadAll( solvCachePath, repos, true, prefetchTime );
+    BOOST_CHECK_EQUAL( plain, prefetched );
+    BOOST_TEST_MESSAGE( "solv caches: " << count << " repos, " << plain << " solvables, loaded " << plainTime << "us, prefetched " << prefetchTime << "us" );
+  }
+}
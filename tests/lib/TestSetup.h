@@ -1,6 +1,7 @@
 #ifndef INCLUDE_TESTSETUP
 #define INCLUDE_TESTSETUP
 #include <iostream>
+#include <chrono>
 
 #ifndef INCLUDE_TESTSETUP_WITHOUT_BOOST
 #include <boost/test/auto_unit_test.hpp>
@@ -38,6 +39,18 @@ using namespace zypp;
 
 #define LABELED(V) #V << ":\t" << V
 
+/** Wall clock time \a fnc_r takes in microseconds.
+ * Benchmarks report their timings via \c BOOST_TEST_MESSAGE, so they
+ * show up only if the test runs with \c --log_level=message.
+ */
+template <class Fnc>
+inline long long usec( Fnc fnc_r )
+{
+  auto start = std::chrono::steady_clock::now();
+  fnc_r();
+  return std::chrono::duration_cast<std::chrono::microseconds>( std::chrono::steady_clock::now() - start ).count();
+}
+
 enum TestSetupOptionBits
 {
   TSO_CLEANROOT = (1 <<  0)
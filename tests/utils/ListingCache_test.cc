@@ -0,0 +1,84 @@
+#include "TestSetup.h"
+
+#include <zypp/ResPool.h>
+
+#include "utils/misc.h"
+#include "utils/ListingCache.h"
+
+using namespace zypp;
+
+namespace
+{
+  /** A detailed search row: status, name, edition, arch, repository. */
+  typedef std::vector<std::string> Row;
+
+  std::vector<Row> uncachedRows()
+  {
+    std::vector<Row> ret;
+    for ( const PoolItem & pi : ResPool::instance() )
+    {
+      ui::Selectable::Ptr sel { ui::Selectable::get( pi ) };
+      if ( sel->picklistPos( pi ) == ui::Selectable::picklistNoPos )
+	continue;
+      ret.push_back( { computeStatusIndicator( pi, sel ), pi.name(), pi.edition().asString(), pi.arch().asString(), pi.repository().asUserString() } );
+    }
+    return ret;
+  }
+
+  std::vector<Row> cachedRows()
+  {
+    std::vector<Row> ret;
+    ListingCache & cache( ListingCache::forPool() );
+    for ( const PoolItem & pi : ResPool::instance() )
+    {
+      ui::Selectable::Ptr sel { ui::Selectable::get( pi ) };
+      if ( cache.picklistPos( pi, sel ) == ui::Selectable::picklistNoPos )
+	continue;
+      ret.push_back( { cache.statusIndicator( pi, sel ), pi.name(), pi.edition().asString(), pi.arch().asString(), cache.repoUserString( pi ) } );
+    }
+    return ret;
+  }
+}
+
+struct TestInit {
+  TestInit()
+    : testSetup( std::make_unique<TestSetup>( Arch_x86_64 ) )
+  {
+    testSetup->loadTargetRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_subset" );
+    testSetup->loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" );
+  }
+  std::unique_ptr<TestSetup> testSetup;
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+// The cached values must be the ones computed per item.
+BOOST_AUTO_TEST_CASE(listingcache_values)
+{
+  ListingCache & cache( ListingCache::forPool() );
+  BOOST_CHECK( &cache == &ListingCache::forPool() );
+
+  for ( const PoolItem & pi : ResPool::instance() )
+  {
+    ui::Selectable::Ptr sel { ui::Selectable::get( pi ) };
+    BOOST_CHECK_EQUAL( cache.picklistPos( pi ), sel->picklistPos( pi ) );
+
+    bool iType = false;
+    bool cachedIType = true;
+    BOOST_CHECK_EQUAL( cache.statusIndicator( pi, &cachedIType ), computeStatusIndicator( pi, &iType ) );
+    BOOST_CHECK_EQUAL( cachedIType, iType );
+    BOOST_CHECK_EQUAL( cache.repoUserString( pi ), pi.repository().asUserString() );
+    BOOST_CHECK_EQUAL( cache.repoName( pi ), pi.repoInfo().name() );
+  }
+}
+
+// Row production with and without the cache (the cache is filled by the first pass).
+BOOST_AUTO_TEST_CASE(listingcache_benchmark)
+{
+  std::vector<Row> uncached;
+  std::vector<Row> cached;
+  long long uncachedTime = usec( [&]() { uncached = uncachedRows(); } );
+  long long firstTime = usec( [&]() { cached = cachedRows(); } );
+  long long cachedTime = usec( [&]() { cached = cachedRows(); } );
+  BOOST_CHECK( cached == uncached );
+  BOOST_TEST_MESSAGE( "listing rows: " << cached.size() << " rows, uncached " << uncachedTime << "us, first pass " << firstTime << "us, cached " << cachedTime << "us" );
+}
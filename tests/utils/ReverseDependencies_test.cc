@@ -0,0 +1,92 @@
+#include "TestSetup.h"
+#include <algorithm>
+
+#include <zypp/sat/Pool.h>
+
+#include "utils/ReverseDependencies.h"
+
+using namespace zypp;
+
+namespace
+{
+  typedef std::vector<sat::Solvable> Solvables;
+
+  Solvables sorted( Solvables solvables_r )
+  {
+    std::sort( solvables_r.begin(), solvables_r.end(), []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); } );
+    return solvables_r;
+  }
+
+  Solvables poolSample( unsigned count_r )
+  {
+    Solvables ret;
+    sat::Pool pool( sat::Pool::instance() );
+    for_( it, pool.solvablesBegin(), pool.solvablesEnd() )
+    {
+      ret.push_back( *it );
+      if ( ret.size() == count_r )
+	break;
+    }
+    return ret;
+  }
+}
+
+struct TestInit {
+  TestInit()
+    : testSetup( std::make_unique<TestSetup>( Arch_x86_64 ) )
+  {
+    testSetup->loadTargetRepo( TESTS_SRC_DIR "/data/openSUSE-11.1_subset" );
+    testSetup->loadRepo( TESTS_SRC_DIR "/data/openSUSE-11.1", "main" );
+  }
+  std::unique_ptr<TestSetup> testSetup;
+};
+BOOST_GLOBAL_FIXTURE( TestInit );
+
+// The index must tell the same as asking the pool for each solvable.
+BOOST_AUTO_TEST_CASE(reversedependencies_whatmatches)
+{
+  const sat::SolvAttr & attr( sat::SolvAttr::requires );
+  const ReverseDependencies & revdeps( ReverseDependencies::forPool( attr ) );
+  BOOST_CHECK( &revdeps == &ReverseDependencies::forPool( attr ) );	// built once
+
+  for ( const sat::Solvable & provider : poolSample( 300 ) )
+  {
+    Solvables expected;
+    for ( auto id : sat::Pool::instance().whatMatchesSolvable( attr, provider ) )
+      expected.push_back( sat::Solvable( static_cast<sat::Solvable::IdType>(id) ) );
+
+    ReverseDependencies::DependentsMap dependents;
+    revdeps.dependents( { provider }, dependents );
+    Solvables got;
+    for ( const auto & el : dependents )
+    {
+      got.push_back( el.first );
+      BOOST_CHECK_MESSAGE( el.second == el.first.matchesSolvable( attr, provider ).second, el.first << " requires of " << provider );
+    }
+    BOOST_CHECK_MESSAGE( sorted( got ) == sorted( expected ), "dependents of " << provider );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(reversedependencies_transitive)
+{
+  const ReverseDependencies & revdeps( ReverseDependencies::forPool( sat::SolvAttr::requires ) );
+
+  for ( const sat::Solvable & provider : poolSample( 50 ) )
+  {
+    Solvables transitive( revdeps.transitiveDependents( { provider } ) );
+    auto contains = [&transitive]( const sat::Solvable & slv_r ) {
+      return std::binary_search( transitive.begin(), transitive.end(), slv_r, []( const sat::Solvable & lhs, const sat::Solvable & rhs ) { return lhs.id() < rhs.id(); } );
+    };
+
+    // closed: the dependents of each result are results too
+    revdeps.forEachDependent( provider, [&]( const sat::Solvable & dependent_r, const Capability & ) {
+      BOOST_CHECK( contains( dependent_r ) );
+    } );
+    for ( const sat::Solvable & slv : transitive )
+    {
+      revdeps.forEachDependent( slv, [&]( const sat::Solvable & dependent_r, const Capability & ) {
+	BOOST_CHECK( contains( dependent_r ) );
+      } );
+    }
+  }
+}
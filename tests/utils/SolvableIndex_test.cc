@@ -0,0 +1,86 @@
+#include "TestSetup.h"
+#include <unistd.h>
+#include <fstream>
+
+#include "utils/SolvableIndex.h"
+
+using namespace zypp;
+
+namespace
+{
+  typedef std::vector<SolvableIndex::Offset> Offsets;
+
+  Offsets offsets( const SolvableIndex::Postings & postings_r )
+  { return Offsets( postings_r.begin(), postings_r.end() ); }
+}
+
+BOOST_AUTO_TEST_CASE(solvableindex_lookup)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path() / "sub" / "words.idx" );
+
+  SolvableIndex::Builder builder;
+  builder.add( "zypper", 0 );
+  builder.add( "package", 0 );
+  builder.add( "manager", 0 );
+  builder.add( "package", 1 );
+  builder.add( "package", 1 );	// duplicates are dropped
+  builder.add( "packagekit", 2 );
+  builder.add( "package", 3 );
+  builder.add( "package", 2 );	// out of order
+  BOOST_CHECK_EQUAL( builder.size(), 4 );
+  BOOST_CHECK( builder.save( file, "cookie-1", 4 ) );
+
+  std::unique_ptr<SolvableIndex> index( SolvableIndex::load( file, "cookie-1" ) );
+  BOOST_REQUIRE( index );
+  BOOST_CHECK_EQUAL( index->solvableCount(), 4 );
+  BOOST_CHECK_EQUAL( index->keyCount(), 4 );
+
+  BOOST_CHECK( offsets( index->find( "package" ) ) == Offsets({ 0, 1, 2, 3 }) );
+  BOOST_CHECK( offsets( index->find( "zypper" ) ) == Offsets({ 0 }) );
+  BOOST_CHECK( index->find( "pack" ).empty() );
+  BOOST_CHECK( index->find( "" ).empty() );
+  BOOST_CHECK( index->find( "zzz" ).empty() );
+
+  Offsets prefixed;
+  index->findPrefix( "pack", prefixed );
+  BOOST_CHECK( prefixed == Offsets({ 0, 1, 2, 3, 2 }) );	// per key, not merged
+  prefixed.clear();
+  index->findPrefix( "x", prefixed );
+  BOOST_CHECK( prefixed.empty() );
+
+  std::vector<std::string> keys;
+  index->forEachKey( [&keys]( boost::string_ref key_r, const SolvableIndex::Postings & ) { keys.push_back( key_r.to_string() ); } );
+  BOOST_CHECK( keys == std::vector<std::string>({ "manager", "package", "packagekit", "zypper" }) );
+
+  keys.clear();
+  index->forEachKey( "pack", [&keys]( boost::string_ref key_r, const SolvableIndex::Postings & ) { keys.push_back( key_r.to_string() ); } );
+  BOOST_CHECK( keys == std::vector<std::string>({ "package", "packagekit" }) );
+}
+
+BOOST_AUTO_TEST_CASE(solvableindex_outdated)
+{
+  filesystem::TmpDir tmp;
+  Pathname file( tmp.path() / "words.idx" );
+
+  BOOST_CHECK( ! SolvableIndex::load( file, "cookie" ) );	// missing
+
+  SolvableIndex::Builder builder;
+  BOOST_CHECK( builder.save( file, "cookie", 0 ) );		// empty index is fine
+  std::unique_ptr<SolvableIndex> index( SolvableIndex::load( file, "cookie" ) );
+  BOOST_REQUIRE( index );
+  BOOST_CHECK( index->find( "any" ).empty() );
+
+  BOOST_CHECK( ! SolvableIndex::load( file, "other cookie" ) );
+
+  // truncated file
+  builder.add( "word", 7 );
+  BOOST_CHECK( builder.save( file, "cookie", 8 ) );
+  BOOST_CHECK( SolvableIndex::load( file, "cookie" ) );
+  BOOST_REQUIRE_EQUAL( ::truncate( file.c_str(), PathInfo( file ).size() - 2 ), 0 );
+  BOOST_CHECK( ! SolvableIndex::load( file, "cookie" ) );
+
+  // garbage
+  std::ofstream( file.c_str() ) << std::string( 256, 'x' );
+  BOOST_CHECK( ! SolvableIndex::load( file, "cookie" ) );
+}
@@ -0,0 +1,227 @@
+#include "TestSetup.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <list>
+
+#include "Table.h"
+#include "utils/console.h"
+
+namespace
+{
+  std::vector<std::string> column( const Table & table_r, unsigned column_r )
+  {
+    std::vector<std::string> ret;
+    for ( const TableRow & row : table_r.rows() )
+      ret.push_back( row.columnsNoTr()[column_r] );
+    return ret;
+  }
+
+  TableRow withUserData( const char * column_r, const boost::any & userData_r )
+  {
+    TableRow ret;
+    ret << column_r;
+    ret.userData( userData_r );
+    return ret;
+  }
+
+  /** \a count_r search like rows: status, name, type, version, arch, repo; priority as user data. */
+  Table syntheticTable( unsigned count_r )
+  {
+    Table ret;
+    ret << ( TableHeader() << "S" << "Name" << "Type" << "Version" << "Arch" << "Repository" );
+    unsigned seed = 4711;
+    auto next = [&seed]( unsigned mod_r ) { seed = seed * 1103515245 + 12345; return ( seed >> 8 ) % mod_r; };
+    for ( unsigned i = 0; i < count_r; ++i )
+    {
+      TableRow row;
+      row << ( next( 3 ) ? "" : "i" )
+          << ( "package-" + str::numstring( next( count_r / 4 + 1 ) ) )
+          << "package"
+          << ( str::numstring( next( 20 ) ) + "." + str::numstring( next( 10 ) ) + "-lp" + str::numstring( next( 200 ) ) )
+          << ( next( 2 ) ? "x86_64" : "noarch" )
+          << ( "repo-" + str::numstring( next( 8 ) ) );
+      row.userData( next( 100 ) );
+      ret << std::move(row);
+    }
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(table_sort_columns)
+{
+  Table t;
+  t << ( TableRow() << "b" << "1" );
+  t << ( TableRow() << "a" << "2" );
+  t << ( TableRow() << "b" << "0" );
+  t << ( TableRow() << "a" << "1" );
+  t << ( TableRow() << "a" );	// shorter rows first
+
+  t.sort( 0 );	// stable
+  BOOST_CHECK( column( t, 0 ) == std::vector<std::string>({ "a", "a", "a", "b", "b" }) );
+  BOOST_CHECK_EQUAL( t.rows()[0].columnsNoTr()[1], "2" );
+  BOOST_CHECK_EQUAL( t.rows()[1].columnsNoTr()[1], "1" );
+  BOOST_CHECK_EQUAL( t.rows()[2].cols(), 1U );
+
+  t.sort( { 1, 0 } );
+  BOOST_CHECK_EQUAL( t.rows()[0].cols(), 1U );
+  BOOST_CHECK( column( t, 0 ) == std::vector<std::string>({ "a", "b", "a", "b", "a" }) );
+
+  t.sort( Table::Unsorted );
+  BOOST_CHECK( column( t, 0 ) == std::vector<std::string>({ "a", "b", "a", "b", "a" }) );
+}
+
+BOOST_AUTO_TEST_CASE(table_sort_userdata)
+{
+  Table t;
+  t << withUserData( "x", 3U );
+  t << withUserData( "x", 1U );
+  t << ( TableRow() << "y" );
+  t << withUserData( "x", 2U );
+
+  t.sort( { 0, Table::UserData } );
+  BOOST_CHECK( column( t, 0 ) == std::vector<std::string>({ "x", "x", "x", "y" }) );
+  BOOST_CHECK_EQUAL( boost::any_cast<unsigned>( t.rows()[0].userData() ), 1U );
+  BOOST_CHECK_EQUAL( boost::any_cast<unsigned>( t.rows()[2].userData() ), 3U );
+
+  t.sort( Table::UserData );	// rows without user data first
+  BOOST_CHECK( t.rows()[0].userData().empty() );
+
+  t << withUserData( "z", std::string("1") );
+  BOOST_CHECK_THROW( t.sort( Table::UserData ), zypp::Exception );
+}
+
+BOOST_AUTO_TEST_CASE(table_sort_custom)
+{
+  Table t;
+  for ( const char * val : { "ccc", "a", "bb" } )
+    t << ( TableRow() << val );
+  t.sort( []( const TableRow & lhs, const TableRow & rhs ) { return lhs.columnsNoTr()[0].size() > rhs.columnsNoTr()[0].size(); } );
+  BOOST_CHECK( column( t, 0 ) == std::vector<std::string>({ "ccc", "bb", "a" }) );
+}
+
+BOOST_AUTO_TEST_CASE(table_stream)
+{
+  Table all;
+  all << ( TableHeader() << "Name" << "Repository" );
+  for ( const char * val : { "bbbb", "a", "cc", "ddd", "e" } )
+    all << ( TableRow() << val << "repo" );
+
+  // widths from the first 2 rows, the others fit
+  Table t;
+  t << ( TableHeader() << "Name" << "Repository" );
+  std::ostringstream out;
+  t.streamTo( out, 2 );
+  for ( const TableRow & row : all.rows() )
+  {
+    t << TableRow( row );
+    BOOST_CHECK( t.rows().size() <= 2 );
+  }
+  t.endStream();
+  BOOST_CHECK( ! t.streaming() );
+  BOOST_CHECK_EQUAL( t.streamedRows(), 5U );
+  BOOST_CHECK_EQUAL( out.str(), std::string( str::Str() << all ) );
+
+  // late wide cells are abbreviated, except in the last column
+  Table w;
+  w << ( TableHeader() << "Name" << "Repository" );
+  std::ostringstream wout;
+  w.streamTo( wout, 1 );
+  w << ( TableRow() << "a" << "repo" );
+  w << ( TableRow() << "longer-name" << "longer-repo" );
+  w.endStream();
+  BOOST_CHECK( wout.str().find( "lo-" ) != std::string::npos );
+  BOOST_CHECK( wout.str().find( "longer-name" ) == std::string::npos );
+  BOOST_CHECK( wout.str().find( "longer-repo" ) != std::string::npos );
+
+  // fewer rows than the sample are printed by endStream
+  Table s;
+  std::ostringstream sout;
+  s.streamTo( sout, 10 );
+  s << ( TableRow() << "x" );
+  BOOST_CHECK( sout.str().empty() );
+  s.endStream();
+  Table ref;
+  ref << ( TableRow() << "x" );
+  BOOST_CHECK_EQUAL( sout.str(), std::string( str::Str() << ref ) );
+}
+
+// Sorting the rows in place vs. the list sort comparing TableRow::Less as before.
+BOOST_AUTO_TEST_CASE(table_benchmark)
+{
+  Table table( syntheticTable( 200000 ) );
+  std::list<TableRow> list( table.rows().begin(), table.rows().end() );
+
+  long long listTime = usec( [&]() { list.sort( TableRow::Less( { 1, Table::UserData } ) ); } );
+  long long sortTime = usec( [&]() { table.sort( { 1, Table::UserData } ); } );
+  BOOST_REQUIRE_EQUAL( list.size(), table.rows().size() );
+  BOOST_CHECK( std::equal( list.begin(), list.end(), table.rows().begin(), []( const TableRow & lhs, const TableRow & rhs ) {
+    return lhs.columnsNoTr() == rhs.columnsNoTr();
+  } ) );
+
+  std::ostringstream out;
+  long long dumpTime = usec( [&]() { out << table; } );
+  BOOST_TEST_MESSAGE( "table: " << table.rows().size() << " rows, list sort " << listTime << "us, sort " << sortTime << "us, render " << dumpTime << "us (" << out.str().size() << " bytes)" );
+}
+
+namespace
+{
+  /** Redirect stdout (and so std::cout) to /dev/null for the lifetime of this object. */
+  struct StdoutToDevNull
+  {
+    StdoutToDevNull()
+    {
+      OutputBuffer::flush();
+      _saved = ::dup( STDOUT_FILENO );
+      int null = ::open( "/dev/null", O_WRONLY );
+      BOOST_REQUIRE( _saved >= 0 && null >= 0 && ::dup2( null, STDOUT_FILENO ) >= 0 );
+      ::close( null );
+    }
+
+    ~StdoutToDevNull()
+    {
+      OutputBuffer::flush();
+      ::dup2( _saved, STDOUT_FILENO );
+      ::close( _saved );
+    }
+
+    int _saved = -1;
+  };
+
+  /** Time writing \a table_r to std::cout, each line ending with std::endl or '\n'. */
+  long long coutTime( const Table & table_r, bool endl_r )
+  {
+    return usec( [&]() {
+      for ( const TableRow & row : table_r.rows() )
+      {
+	row.dumpTo( std::cout, table_r );	// ends with '\n'
+	if ( endl_r )
+	  std::cout << std::flush;		// what std::endl added
+      }
+      std::cout << std::flush;
+    } );
+  }
+}
+
+// Writing a 100k rows result to std::cout redirected to /dev/null, ending
+// lines with std::endl vs. '\n', with the default stdout buffer and after
+// OutputBuffer::setup(). Run with --log_level=message to see the timings.
+BOOST_AUTO_TEST_CASE(table_output_benchmark)
+{
+  Table table( syntheticTable( 100000 ) );
+  std::ostringstream widths;
+  widths << table;	// computes the column widths once
+
+  long long endlDefault, newlineDefault, endlSetup, newlineSetup;
+  {
+    StdoutToDevNull null;
+    endlDefault = coutTime( table, true );
+    newlineDefault = coutTime( table, false );
+    OutputBuffer::setup();	// stdout is no terminal now: fully buffered
+    endlSetup = coutTime( table, true );
+    newlineSetup = coutTime( table, false );
+  }
+  BOOST_CHECK( std::cout );
+  BOOST_TEST_MESSAGE( "output: " << table.rows().size() << " rows to /dev/null; default buffer: endl " << endlDefault
+		      << "us, '\\n' " << newlineDefault << "us; OutputBuffer::setup: endl " << endlSetup
+		      << "us, '\\n' " << newlineSetup << "us" );
+}
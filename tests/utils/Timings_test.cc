@@ -0,0 +1,98 @@
+#include "TestSetup.h"
+#include <sstream>
+#include <vector>
+
+#include "utils/Timings.h"
+
+using namespace zypp;
+
+BOOST_AUTO_TEST_CASE(timings_disabled)
+{
+  Timings & timings( Timings::instance() );
+  BOOST_CHECK( ! timings.enabled() );
+  {
+    Timings::Phase phase( "nothing" );
+    phase.addBytes( 42 );
+  }
+  BOOST_CHECK( timings.records().empty() );
+}
+
+BOOST_AUTO_TEST_CASE(timings_nesting)
+{
+  Timings & timings( Timings::instance() );
+  timings.enable();
+  {
+    Timings::Phase outer( "init_repos" );
+    {
+      Timings::Phase inner( "download", "repo-oss" );
+      inner.addBytes( 1000 );
+      inner.addBytes( 24 );
+    }
+    Timings::Phase early( "build cache", "repo-oss" );
+    early.end();
+    early.addBytes( 1 );	// ended: ignored
+  }
+  Timings::Phase next( "load_resolvables" );
+  next.end();
+
+  const std::vector<Timings::Record> & records( timings.records() );
+  BOOST_REQUIRE_EQUAL( records.size(), 4 );
+  BOOST_CHECK_EQUAL( records[0].name, "init_repos" );
+  BOOST_CHECK_EQUAL( records[0].depth, 0 );
+  BOOST_CHECK_EQUAL( records[1].name, "download" );
+  BOOST_CHECK_EQUAL( records[1].detail, "repo-oss" );
+  BOOST_CHECK_EQUAL( records[1].depth, 1 );
+  BOOST_CHECK_EQUAL( ByteCount::SizeType(records[1].bytes), 1024 );
+  BOOST_CHECK_EQUAL( records[2].depth, 1 );
+  BOOST_CHECK_EQUAL( ByteCount::SizeType(records[2].bytes), 0 );
+  BOOST_CHECK_EQUAL( records[3].depth, 0 );
+
+  for ( const Timings::Record & record : records )
+  {
+    BOOST_CHECK( record.duration >= 0 );
+    BOOST_CHECK( record.rssStart > 0 );
+    BOOST_CHECK( record.processPeakRss > 0 );
+  }
+  BOOST_CHECK( records[0].start <= records[1].start );
+  BOOST_CHECK( records[0].duration >= records[1].duration );
+}
+
+BOOST_AUTO_TEST_CASE(timings_rss_delta)
+{
+  Timings & timings( Timings::instance() );
+  timings.clear();
+  std::vector<char> mem;
+  {
+    Timings::Phase phase( "load_resolvables" );
+    mem.assign( 32 * 1024 * 1024, 'x' );	// touched, so it's resident
+  }
+  BOOST_REQUIRE_EQUAL( timings.records().size(), 1 );
+  BOOST_CHECK( timings.records()[0].rssDelta >= 16 * 1024 );
+  BOOST_CHECK( timings.records()[0].processPeakRss >= timings.records()[0].rssStart + timings.records()[0].rssDelta );
+  timings.clear();
+}
+
+BOOST_AUTO_TEST_CASE(timings_trace)
+{
+  Timings & timings( Timings::instance() );
+  timings.clear();
+  {
+    Timings::Phase phase( "download", "say \"hi\"\n" );
+    phase.addBytes( 7 );
+  }
+
+  std::ostringstream str;
+  timings.dumpTraceTo( str, "search" );
+  const std::string & trace( str.str() );
+  BOOST_CHECK( trace.find( "\"traceEvents\":[" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"command\":\"search\"" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"name\":\"download\"" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"ph\":\"X\"" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"detail\":\"say \\\"hi\\\"\\n\"" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"bytes\":7" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"rss_delta_kib\":" ) != std::string::npos );
+  BOOST_CHECK( trace.find( "\"process_peak_rss_kib\":" ) != std::string::npos );
+
+  timings.clear();
+  BOOST_CHECK( timings.records().empty() );
+}
@@ -0,0 +1,224 @@
+#include "TestSetup.h"
+#include <algorithm>
+#include <iterator>
+
+#include "utils/SolvableIndex.h"
+#include "utils/Trigrams.h"
+
+using namespace zypp;
+
+namespace
+{
+  typedef std::vector<std::string> Strings;
+  typedef std::vector<SolvableIndex::Offset> Offsets;
+
+  /** Names like the ones in a distribution: libfoo-devel, python3-bar, ... */
+  Strings syntheticNames( unsigned count_r )
+  {
+    static const Strings prefixes { "", "lib", "python3-", "perl-", "ruby2.5-rubygem-", "texlive-", "golang-github-", "kernel-" };
+    static const Strings syllables { "ze", "ra", "mo", "qu", "ix", "ber", "tal", "gon", "fu", "lo", "sna", "pi", "kro", "vel", "dy" };
+    static const Strings suffixes { "", "-devel", "-doc", "-lang", "32bit", "-debuginfo", "-tools" };
+
+    Strings ret;
+    ret.reserve( count_r );
+    unsigned seed = 4711;
+    auto next = [&seed]( unsigned mod_r ) { seed = seed * 1103515245 + 12345; return ( seed >> 8 ) % mod_r; };
+    for ( unsigned i = 0; i < count_r; ++i )
+    {
+      std::string name( prefixes[next( prefixes.size() )] );
+      for ( unsigned s = 2 + next( 3 ); s; --s )
+	name += syllables[next( syllables.size() )];
+      name += suffixes[next( suffixes.size() )];
+      ret.push_back( name );
+    }
+    ret.push_back( "zypper" );
+    ret.push_back( "libzypp" );
+    return ret;
+  }
+
+  Offsets scan( const Strings & names_r, const StrMatcher & matcher_r )
+  {
+    Offsets ret;
+    for ( SolvableIndex::Offset i = 0; i < names_r.size(); ++i )
+      if ( matcher_r( names_r[i] ) )
+	ret.push_back( i );
+    return ret;
+  }
+
+  Offsets lookup( const SolvableIndex & index_r, const Strings & names_r, const Strings & trigrams_r, const StrMatcher & matcher_r )
+  {
+    Offsets candidates;
+    bool first = true;
+    for ( const std::string & trigram : trigrams_r )
+    {
+      const SolvableIndex::Postings & postings( index_r.find( trigram ) );
+      if ( first )
+      {
+	candidates.assign( postings.begin(), postings.end() );
+	first = false;
+      }
+      else
+      {
+	Offsets both;
+	std::set_intersection( candidates.begin(), candidates.end(), postings.begin(), postings.end(), std::back_inserter( both ) );
+	candidates.swap( both );
+      }
+    }
+    Offsets ret;
+    for ( SolvableIndex::Offset i : candidates )
+      if ( matcher_r( names_r[i] ) )
+	ret.push_back( i );
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(trigram_split)
+{
+  Strings result;
+  trigram::split( "ab", result );
+  BOOST_CHECK( result.empty() );
+  trigram::split( "ZyPPer", result );
+  BOOST_CHECK( result == Strings({ "per", "ppe", "ypp", "zyp" }) );
+  result.clear();
+  trigram::split( "aaaa", result );
+  BOOST_CHECK( result == Strings({ "aaa" }) );
+}
+
+BOOST_AUTO_TEST_CASE(trigram_required)
+{
+  BOOST_CHECK( trigram::required( "zyPP", Match::SUBSTRING ) == Strings({ "ypp", "zyp" }) );
+  BOOST_CHECK( trigram::required( "zy", Match::SUBSTRING ).empty() );
+  BOOST_CHECK( trigram::required( "zypper", Match::OTHER ).empty() );
+  BOOST_CHECK( trigram::required( "zyp\xc3\xa4", Match::SUBSTRING ).empty() );
+
+  // glob
+  BOOST_CHECK( trigram::required( "lib*-devel", Match::GLOB ) == Strings({ "-de", "dev", "eve", "lib", "vel" }) );
+  BOOST_CHECK( trigram::required( "l?bz*", Match::GLOB ).empty() );
+  BOOST_CHECK( trigram::required( "py[th]hon", Match::GLOB ) == Strings({ "hon" }) );
+  BOOST_CHECK( trigram::required( "a\\*bc", Match::GLOB ) == Strings({ "*bc", "a*b" }) );
+  BOOST_CHECK( trigram::required( "abc[", Match::GLOB ).empty() );
+
+  // regex
+  BOOST_CHECK( trigram::required( "^libzypp$", Match::REGEX ) == Strings({ "bzy", "ibz", "lib", "ypp", "zyp" }) );
+  BOOST_CHECK( trigram::required( "kernel-defaults?", Match::REGEX ) == trigram::required( "kernel-default", Match::SUBSTRING ) );
+  BOOST_CHECK( trigram::required( "abcd*e", Match::REGEX ) == Strings({ "abc" }) );
+  BOOST_CHECK( trigram::required( "abcd{0,2}", Match::REGEX ) == Strings({ "abc" }) );
+  BOOST_CHECK( trigram::required( "ab+cde", Match::REGEX ) == Strings({ "cde" }) );
+  BOOST_CHECK( trigram::required( "abc\\.def", Match::REGEX ) == Strings({ ".de", "abc", "bc.", "c.d", "def" }) );
+  BOOST_CHECK( trigram::required( "abc\\wdef", Match::REGEX ) == Strings({ "abc", "def" }) );
+  BOOST_CHECK( trigram::required( "a[bc]*def", Match::REGEX ) == Strings({ "def" }) );
+  BOOST_CHECK( trigram::required( "abc|def", Match::REGEX ).empty() );
+  BOOST_CHECK( trigram::required( "(abc)?def", Match::REGEX ).empty() );
+}
+
+// Compare the trigram index lookup to scanning all names (the PoolQuery way).
+BOOST_AUTO_TEST_CASE(trigram_benchmark)
+{
+  const Strings names( syntheticNames( 100000 ) );
+
+  SolvableIndex::Builder builder;
+  long long buildTime = usec( [&]() {
+    Strings trigrams;
+    for ( SolvableIndex::Offset i = 0; i < names.size(); ++i )
+    {
+      trigrams.clear();
+      trigram::split( names[i], trigrams );
+      for ( const std::string & trigram : trigrams )
+	builder.add( trigram, i );
+    }
+  } );
+
+  filesystem::TmpDir tmp;
+  BOOST_REQUIRE( builder.save( tmp.path() / "trigrams.idx", "cookie", names.size() ) );
+  std::unique_ptr<SolvableIndex> index( SolvableIndex::load( tmp.path() / "trigrams.idx", "cookie" ) );
+  BOOST_REQUIRE( index );
+  BOOST_TEST_MESSAGE( "trigram index: " << names.size() << " names, " << index->keyCount() << " trigrams, built in " << buildTime << "us" );
+
+  const std::vector<std::pair<std::string,Match::Mode>> patterns {
+    { "zypp",			Match::SUBSTRING },
+    { "ZYPPER",			Match::STRING },
+    { "libzeramo",		Match::SUBSTRING },
+    { "python3-*-devel",	Match::GLOB },
+    { "^kernel-.*tal.*-doc$",	Match::REGEX },
+    { "quixgon",		Match::SUBSTRING },
+    { "nomatchatall",		Match::SUBSTRING },
+  };
+  for ( const auto & pattern : patterns )
+  {
+    StrMatcher matcher( pattern.first, Match( pattern.second ) | Match::NOCASE );
+    matcher.compile();
+    Strings trigrams( trigram::required( pattern.first, pattern.second ) );
+    BOOST_REQUIRE( ! trigrams.empty() );
+
+    Offsets scanned;
+    Offsets looked;
+    long long scanTime = usec( [&]() { scanned = scan( names, matcher ); } );
+    long long lookupTime = usec( [&]() { looked = lookup( *index, names, trigrams, matcher ); } );
+    BOOST_CHECK_MESSAGE( scanned == looked, pattern.first );
+    BOOST_TEST_MESSAGE( "  '" << pattern.first << "': " << scanned.size() << " matches, scan " << scanTime << "us, index " << lookupTime << "us" );
+  }
+}
+
+BOOST_AUTO_TEST_CASE(trigram_distance)
+{
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "zypper", 2 ), 0 );
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "ZyPPer", 2 ), 0 );
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "zyper", 2 ), 1 );
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "zpyper", 2 ), 1 );	// transposition
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "sipper", 2 ), 2 );
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "libzypp", 2 ), 3 );	// more than max
+  BOOST_CHECK_EQUAL( trigram::distance( "zypper", "yast", 2 ), 3 );
+  BOOST_CHECK_EQUAL( trigram::distance( "", "ab", 2 ), 2 );
+
+  BOOST_CHECK_EQUAL( trigram::typoDistance( "vim" ), 1 );
+  BOOST_CHECK_EQUAL( trigram::typoDistance( "zypper" ), 2 );
+}
+
+// Compare the typo candidates of the trigram index to computing the distance to all names.
+BOOST_AUTO_TEST_CASE(trigram_typo_benchmark)
+{
+  const Strings names( syntheticNames( 100000 ) );
+
+  SolvableIndex::Builder builder;
+  Strings trigrams;
+  for ( SolvableIndex::Offset i = 0; i < names.size(); ++i )
+  {
+    trigrams.clear();
+    trigram::split( names[i], trigrams );
+    for ( const std::string & trigram : trigrams )
+      builder.add( trigram, i );
+  }
+  filesystem::TmpDir tmp;
+  BOOST_REQUIRE( builder.save( tmp.path() / "trigrams.idx", "cookie", names.size() ) );
+  std::unique_ptr<SolvableIndex> index( SolvableIndex::load( tmp.path() / "trigrams.idx", "cookie" ) );
+  BOOST_REQUIRE( index );
+
+  for ( const std::string & word : Strings({ "zyper", "libzyp", "zpyper", "pyhton3-ixbergon", "kernel-zeramo-dco", "quixtal-devle" }) )
+  {
+    unsigned maxDistance = trigram::typoDistance( word );
+
+    Offsets scanned;
+    long long scanTime = usec( [&]() {
+      for ( SolvableIndex::Offset i = 0; i < names.size(); ++i )
+	if ( trigram::distance( names[i], word, maxDistance ) <= maxDistance )
+	  scanned.push_back( i );
+    } );
+
+    Offsets looked;
+    long long lookupTime = usec( [&]() {
+      for ( SolvableIndex::Offset i : trigram::similar( *index, word, maxDistance ) )
+	if ( trigram::distance( names[i], word, maxDistance ) <= maxDistance )
+	  looked.push_back( i );
+    } );
+
+    // complete if the word has enough trigrams to require one to be shared
+    Strings wordTrigrams;
+    trigram::split( word, wordTrigrams );
+    if ( wordTrigrams.size() > 4 * maxDistance )
+      BOOST_CHECK_MESSAGE( scanned == looked, word );
+    else
+      BOOST_CHECK_MESSAGE( std::includes( scanned.begin(), scanned.end(), looked.begin(), looked.end() ), word );
+    BOOST_WARN_MESSAGE( lookupTime < 5000, word << ": index lookup took " << lookupTime << "us" );
+    BOOST_TEST_MESSAGE( "  '" << word << "': " << scanned.size() << " similar names, scan " << scanTime << "us, index " << lookupTime << "us" );
+  }
+}
@@ -168,3 +168,71 @@ BOOST_AUTO_TEST_CASE(mbs_iterator)
   BOOST_CHECK_EQUAL( *it,		L'\0' );	// stays at end
   BOOST_CHECK_EQUAL( it.atEnd(),	true );
 }
+
+namespace
+{
+  /** mbs_width without the ASCII fast path */
+  size_t mbsIteratorWidth( boost::string_ref text_r )
+  {
+    size_t ret = 0;
+    for( mbs::MbsIterator it( text_r ); ! it.atEnd(); ++it )
+      ret += it.columns();
+    return ret;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(mbs_ascii)
+{
+  setlocale (LC_CTYPE, "en_US.UTF-8");
+  BOOST_CHECK( mbs::isAsciiText( "" ) );
+  BOOST_CHECK( mbs::isAsciiText( "libzypp-devel 17.31.0-1.1 x86_64 (System Packages) ~!" ) );
+  BOOST_CHECK( ! mbs::isAsciiText( "libzypp-devel\n17.31.0-1.1" ) );
+  BOOST_CHECK( mbs::isAsciiText( "libzypp-devel\n17.31.0-1.1", /*withNL_r*/true ) );
+  BOOST_CHECK( ! mbs::isAsciiText( "libzypp-devel\t17.31.0-1.1", true ) );
+  BOOST_CHECK( ! mbs::isAsciiText( "libzypp-devel 17.31.0-1.1 \177" ) );
+  BOOST_CHECK( ! mbs::isAsciiText( "Koľko stĺpcov" ) );
+  BOOST_CHECK( ! mbs::isAsciiText( "stĺpcov" ) );
+
+  // fast path and iterator agree
+  ColorString cs( "colored", ColorContext::NEGATIVE );
+  for ( const std::string & s : { std::string( "abcdefgh" ), std::string( "abcdefghijklmnopq" ), std::string( "a\tb\nc" ),
+				  std::string( "\177\177" ), cs.str(), std::string( "Koľko stĺpcov zaberajú znaky '和平'?" ) } )
+    BOOST_CHECK_EQUAL( mbs_width( s ), mbsIteratorWidth( s ) );
+
+  BOOST_CHECK_EQUAL( mbs_substr_by_width( "abcdefghij", 2, 3 ),	"cde" );
+  BOOST_CHECK_EQUAL( mbs_substr_by_width( "abcdefghij", 8 ),	"ij" );
+  BOOST_CHECK_EQUAL( mbs_substr_by_width( "abcdefghij", 10, 2 ),	"" );
+  BOOST_CHECK_EQUAL( mbs_substr_by_width( "abcdefghij", 2, 0 ),	"" );
+
+  std::ostringstream out;
+  mbs_write_wrapped( out, "one two three four", 0, 10 );
+  BOOST_CHECK_EQUAL( out.str(), "one two\nthree four" );
+  out.str( "" );
+  mbs_write_wrapped( out, "abcdefghijkl", 0, 5 );
+  BOOST_CHECK_EQUAL( out.str(), "abcde\nfghij\nkl" );
+  out.str( "" );
+  mbs_write_wrapped( out, "ab\ncd", 0, 0 );
+  BOOST_CHECK_EQUAL( out.str(), "ab\ncd" );
+}
+
+BOOST_AUTO_TEST_CASE(mbs_width_benchmark)
+{
+  setlocale (LC_CTYPE, "en_US.UTF-8");
+  std::vector<std::string> cells;
+  for ( unsigned i = 0; i < 200000; ++i )
+    cells.push_back( "package-" + str::numstring( i ) + "-devel" );
+
+  size_t fast = 0;
+  size_t slow = 0;
+  long long fastTime = usec( [&]() {
+    for ( const std::string & cell : cells )
+      fast += mbs_width( cell );
+  } );
+  long long slowTime = usec( [&]() {
+    for ( const std::string & cell : cells )
+      slow += mbsIteratorWidth( cell );
+  } );
+
+  BOOST_CHECK_EQUAL( fast, slow );
+  BOOST_TEST_MESSAGE( "mbs_width: " << cells.size() << " cells, ascii check " << fastTime << "us, iterator " << slowTime << "us" );
+}